@@ -0,0 +1,101 @@
+#include <benchmark/benchmark.h>
+#include <engine/batch_details.hpp>
+#include <engine/block_table.hpp>
+#include <sequence/sequence.hpp>
+#include "utils/tracy_wrapper.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using namespace pie_core;
+
+constexpr size_t PROMPT_LEN = 512;
+constexpr size_t PAGES_PER_SEQUENCE = 16;
+
+// `num_sequences` decoding sequences, each contributing one token per step.
+std::vector<std::unique_ptr<sequence::Sequence>> make_decode_batch(size_t num_sequences) {
+    std::vector<std::unique_ptr<sequence::Sequence>> sequences;
+    for (size_t i = 0; i < num_sequences; ++i) {
+        auto sequence = std::make_unique<sequence::Sequence>(
+            i, sequence::SequenceStatus::DECODING, 0,
+            sequence::Prompt(std::vector<int32_t>(PROMPT_LEN, 1)),
+            sequence::SamplingParams{}, sequence::LogitsParams{}, sequence::StopCriteria{}, sequence::IPCHandles{});
+        sequence->append_token(2);
+        for (size_t page = 0; page < PAGES_PER_SEQUENCE; ++page) {
+            sequence->append_page(static_cast<uint32_t>(i * PAGES_PER_SEQUENCE + page));
+        }
+        sequences.push_back(std::move(sequence));
+    }
+    return sequences;
+}
+
+std::vector<engine::TokenChunk> decode_chunks(const std::vector<std::unique_ptr<sequence::Sequence>>& sequences) {
+    std::vector<engine::TokenChunk> chunks;
+    for (const auto& sequence : sequences) {
+        chunks.push_back({sequence.get(), PROMPT_LEN, 1});
+    }
+    return chunks;
+}
+
+// Fresh vectors and MLX buffers every step.
+static void BM_BatchDetails_Allocating(benchmark::State& state) {
+    PIE_PROFILE_FUNCTION();
+    const auto sequences = make_decode_batch(static_cast<size_t>(state.range(0)));
+    const auto chunks = decode_chunks(sequences);
+    for (auto _ : state) {
+        engine::BatchDetails details = engine::build_batch_details(chunks);
+        benchmark::DoNotOptimize(details);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Preallocated, double-buffered: no allocation in steady state.
+static void BM_BatchDetails_Builder(benchmark::State& state) {
+    PIE_PROFILE_FUNCTION();
+    const auto sequences = make_decode_batch(static_cast<size_t>(state.range(0)));
+    const auto chunks = decode_chunks(sequences);
+    engine::BatchDetailsBuilder builder(sequences.size(), 4096);
+    for (auto _ : state) {
+        const engine::BatchDetails& details = builder.build(chunks);
+        benchmark::DoNotOptimize(&details);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Preallocated, with the block table kept in persistent rows: a step only
+// lists each sequence's row.
+static void BM_BatchDetails_Persistent(benchmark::State& state) {
+    PIE_PROFILE_FUNCTION();
+    const auto sequences = make_decode_batch(static_cast<size_t>(state.range(0)));
+    const auto chunks = decode_chunks(sequences);
+    engine::PersistentBlockTable table(sequences.size());
+    std::vector<uint32_t> rows;
+    for (const auto& sequence : sequences) {
+        rows.push_back(static_cast<uint32_t>(rows.size()));
+        table.sync_row(rows.back(), sequence->page_table);
+    }
+    const engine::BlockTableSpec spec{.layout = engine::BlockTableLayout::PERSISTENT, .table = &table, .rows = rows};
+    engine::BatchDetailsBuilder builder(sequences.size(), 4096);
+    for (auto _ : state) {
+        const engine::BatchDetails& details = builder.build(chunks, spec);
+        benchmark::DoNotOptimize(&details);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_BatchDetails_Allocating)
+    ->Arg(32)->Arg(256)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_BatchDetails_Builder)
+    ->Arg(32)->Arg(256)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_BatchDetails_Persistent)
+    ->Arg(32)->Arg(256)
+    ->Unit(benchmark::kMicrosecond);
+
+} // anonymous namespace
@@ -0,0 +1,126 @@
+#include <benchmark/benchmark.h>
+#include <ipc/spsc_queue.hpp>
+#include "utils/tracy_wrapper.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace pie_core;
+
+// Stands in for std::unique_ptr<sequence::Sequence>: same hand-off cost, no MLX.
+using Item = std::unique_ptr<uint64_t>;
+using Queue = ipc::SPSCQueue<Item>;
+
+// Round trip through two queues: the time an item takes to cross threads and back.
+// Reported time per iteration is the round-trip latency (needs two free cores).
+static void BM_SPSCQueue_PingPongLatency(benchmark::State& state) {
+    PIE_PROFILE_FUNCTION();
+
+    Queue ping(1024);
+    Queue pong(1024);
+    std::atomic<bool> done{false};
+
+    std::thread echo([&] {
+        while (!done.load(std::memory_order_acquire)) {
+            if (auto item = ping.try_pop()) {
+                while (!pong.try_push(std::move(*item))) {}
+            }
+        }
+    });
+
+    Item item = std::make_unique<uint64_t>(0);
+    for (auto _ : state) {
+        while (!ping.try_push(std::move(item))) {}
+        std::optional<Item> back;
+        while (!(back = pong.try_pop())) {}
+        item = std::move(*back);
+        ++*item;
+    }
+    done.store(true, std::memory_order_release);
+    echo.join();
+}
+
+// Streaming: the producer pushes batches of `batch` items, the consumer drains
+// everything available with one pop_batch, as the scheduler does each step.
+static void BM_SPSCQueue_BatchThroughput(benchmark::State& state) {
+    PIE_PROFILE_FUNCTION();
+
+    const size_t batch = static_cast<size_t>(state.range(0));
+    constexpr size_t items_per_iteration = 1 << 16;
+    Queue queue(1024);
+
+    for (auto _ : state) {
+        std::thread producer([&] {
+            std::vector<Item> items(batch);
+            for (size_t sent = 0; sent < items_per_iteration;) {
+                const size_t count = std::min(batch, items_per_iteration - sent);
+                for (size_t i = 0; i < count; ++i) items[i] = std::make_unique<uint64_t>(sent + i);
+                size_t pushed = 0;
+                while (pushed < count) pushed += queue.push_batch(items.data() + pushed, count - pushed);
+                sent += count;
+            }
+        });
+
+        std::vector<Item> drained;
+        drained.reserve(queue.capacity());
+        size_t received = 0;
+        while (received < items_per_iteration) {
+            drained.clear();
+            received += queue.pop_batch(std::back_inserter(drained));
+            benchmark::DoNotOptimize(drained.data());
+        }
+        producer.join();
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(items_per_iteration));
+}
+
+// Wakeup latency when the consumer is parked in wait_for_data() (idle scheduler).
+static void BM_SPSCQueue_BlockingWakeup(benchmark::State& state) {
+    PIE_PROFILE_FUNCTION();
+
+    Queue queue(1024);
+    std::atomic<uint64_t> consumed{0};
+    std::atomic<bool> done{false};
+
+    std::thread consumer([&] {
+        std::vector<Item> drained;
+        while (!done.load(std::memory_order_acquire)) {
+            queue.wait_for_data(std::chrono::milliseconds(10));
+            drained.clear();
+            consumed.fetch_add(queue.pop_batch(std::back_inserter(drained)), std::memory_order_release);
+        }
+    });
+
+    uint64_t produced = 0;
+    for (auto _ : state) {
+        while (!queue.try_push(std::make_unique<uint64_t>(produced))) {}
+        ++produced;
+        while (consumed.load(std::memory_order_acquire) < produced) {}
+    }
+    done.store(true, std::memory_order_release);
+    queue.wake();
+    consumer.join();
+}
+
+BENCHMARK(BM_SPSCQueue_PingPongLatency)
+    ->UseRealTime()
+    ->Unit(benchmark::kNanosecond);
+
+BENCHMARK(BM_SPSCQueue_BatchThroughput)
+    ->Arg(1)->Arg(16)->Arg(256)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_SPSCQueue_BlockingWakeup)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+} // anonymous namespace
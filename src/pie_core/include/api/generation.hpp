@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stop_token>
+#include <vector>
+
+#include "api/generator.hpp"
+#include "engine/engine.hpp"
+#include "engine/token_stream.hpp"
+#include "sequence/logits_params.hpp"
+#include "sequence/sampling_params.hpp"
+#include "sequence/stop_criteria.hpp"
+#include "sequence/scheduling_params.hpp"
+
+namespace pie_core::api {
+
+    // Public embedding API: everything a native caller needs to run generations
+    // on an in-process engine::Engine, without IPC or Python. Requests go to the
+    // engine's own scheduler thread.
+
+    using engine::Engine;
+    using engine::EngineConfig;
+    using engine::StreamToken;
+    using FinishReason = ipc::FinishReason;
+
+    struct GenerationRequest {
+        std::vector<int32_t> prompt;
+        sequence::SamplingParams sampling_params;
+        sequence::LogitsParams logits_params;
+        sequence::StopCriteria stop_criteria;
+        sequence::SchedulingParams scheduling_params;
+    };
+
+    /**
+     * @brief Cancels one request. Cheap to copy; may be used from any thread, and
+     * cancelling a finished request is a no-op. Must not outlive the Engine.
+     */
+    class CancelHandle {
+    public:
+        CancelHandle(Engine& engine, uint64_t request_id) noexcept : engine_(&engine), request_id_(request_id) {}
+
+        [[nodiscard]] uint64_t request_id() const noexcept { return request_id_; }
+
+        void cancel() const { engine_->cancel(request_id_); }
+
+    private:
+        Engine* engine_;
+        uint64_t request_id_;
+    };
+
+    /**
+     * @brief A running generation, consumed as a coroutine token stream:
+     *
+     *     for (const StreamToken& token : generation.tokens()) { ... }
+     *
+     * The stream ends after the entry carrying a FinishReason. Leaving the loop
+     * early does not stop the request; cancel it (or pass a stop_token to
+     * `tokens()`) to free its batch slot and KV pages.
+     */
+    class Generation {
+    public:
+        Generation(Engine& engine, std::shared_ptr<engine::TokenStream> stream) noexcept
+            : handle_(engine, stream->request_id()), stream_(std::move(stream)) {}
+
+        [[nodiscard]] uint64_t request_id() const noexcept { return handle_.request_id(); }
+        [[nodiscard]] CancelHandle cancel_handle() const noexcept { return handle_; }
+        void cancel() const { handle_.cancel(); }
+
+        /**
+         * @brief Yields tokens as the scheduler produces them, blocking the
+         * calling thread in between. A stop request on `stop` cancels the
+         * generation; the stream then ends with FinishReason::CANCELLED.
+         * The generator shares the stream, so it may outlive this Generation.
+         */
+        Generator<StreamToken> tokens(std::stop_token stop = {});
+
+        /** @brief Drains the stream: the generated token ids and why it stopped. */
+        std::pair<std::vector<int32_t>, FinishReason> collect(std::stop_token stop = {});
+
+    private:
+        CancelHandle handle_;
+        std::shared_ptr<engine::TokenStream> stream_;
+    };
+
+    /**
+     * @brief Queues `request` and returns its generation.
+     * @return std::nullopt if the engine's hand-off queue is full; retry later.
+     */
+    std::optional<Generation> generate(Engine& engine, const GenerationRequest& request);
+
+    /**
+     * @brief Queues `request` with its tokens delivered to `on_token` on the
+     * scheduler thread, in order, ending with the entry carrying a FinishReason.
+     * The callback must be quick and must not block on the engine.
+     * @return The request's cancel handle, or std::nullopt if the queue is full.
+     */
+    std::optional<CancelHandle> generate(
+        Engine& engine,
+        const GenerationRequest& request,
+        engine::TokenStream::Callback on_token
+    );
+
+} // namespace pie_core::api
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace pie_core::api {
+
+    /**
+     * @brief Minimal synchronous generator coroutine (`std::generator` is not
+     * available on every toolchain we build with).
+     *
+     * Lazily started, single-pass, move-only. The yielded value lives in the
+     * coroutine frame until the next increment, so `*it` is a reference into it.
+     * Exceptions thrown by the body are rethrown from `begin()` / `++it`.
+     */
+    template <typename T>
+    class Generator {
+    public:
+        using value_type = std::remove_cvref_t<T>;
+
+        struct promise_type {
+            const value_type* current = nullptr;
+            std::exception_ptr exception;
+
+            Generator get_return_object() noexcept {
+                return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            std::suspend_always final_suspend() const noexcept { return {}; }
+
+            std::suspend_always yield_value(const value_type& value) noexcept {
+                current = std::addressof(value);
+                return {};
+            }
+            std::suspend_always yield_value(value_type&& value) noexcept {
+                current = std::addressof(value);
+                return {};
+            }
+
+            void return_void() const noexcept {}
+            void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+            // Generators only yield.
+            template <typename U>
+            std::suspend_never await_transform(U&&) = delete;
+        };
+
+        using Handle = std::coroutine_handle<promise_type>;
+
+        class iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = std::remove_cvref_t<T>;
+            using reference = const value_type&;
+
+            iterator() noexcept = default;
+            explicit iterator(Handle handle) noexcept : handle_(handle) {}
+
+            reference operator*() const noexcept { return *handle_.promise().current; }
+            const value_type* operator->() const noexcept { return handle_.promise().current; }
+
+            iterator& operator++() {
+                advance(handle_);
+                return *this;
+            }
+            void operator++(int) { ++*this; }
+
+            friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept {
+                return !it.handle_ || it.handle_.done();
+            }
+
+        private:
+            Handle handle_{};
+        };
+
+        Generator() noexcept = default;
+        Generator(Generator&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+        Generator& operator=(Generator&& other) noexcept {
+            if (this != &other) {
+                reset();
+                handle_ = std::exchange(other.handle_, {});
+            }
+            return *this;
+        }
+        ~Generator() { reset(); }
+
+        Generator(const Generator&) = delete;
+        Generator& operator=(const Generator&) = delete;
+
+        /** @brief Runs the body up to its first yield. Call once. */
+        iterator begin() {
+            if (handle_) {
+                advance(handle_);
+            }
+            return iterator(handle_);
+        }
+        std::default_sentinel_t end() const noexcept { return {}; }
+
+    private:
+        Handle handle_{};
+
+        explicit Generator(Handle handle) noexcept : handle_(handle) {}
+
+        static void advance(Handle handle) {
+            handle.resume();
+            if (handle.done() && handle.promise().exception) {
+                std::rethrow_exception(std::exchange(handle.promise().exception, {}));
+            }
+        }
+
+        void reset() noexcept {
+            if (handle_) {
+                // Destroying a suspended frame runs the body's destructors, so
+                // abandoning a loop early still unwinds any RAII in it.
+                handle_.destroy();
+                handle_ = {};
+            }
+        }
+    };
+
+} // namespace pie_core::api
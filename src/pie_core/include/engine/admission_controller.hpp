@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+
+namespace pie_core::engine {
+
+    /**
+     * @brief Decides whether the KV pool can carry one more sequence to the
+     * end of its generation.
+     *
+     * Each sequence is charged the pages its prompt plus expected output will
+     * occupy. A new one is admitted only if the free pages, less what running
+     * sequences have yet to claim of their own charge and less its charge,
+     * stay at or above the watermark. Admitting on current occupancy alone
+     * lets a burst of long generations fill the pool mid-decode, after which
+     * sequences stall on pages and preempt each other.
+     *
+     * Expected output is max_generated_tokens. With prediction on, once
+     * `MIN_OBSERVATIONS` sequences have finished on their own it is instead
+     * that limit scaled by a high estimate (mean plus two standard
+     * deviations, EWMA) of the fraction of their limit sequences go on to use.
+     */
+    class AdmissionController {
+    public:
+        static constexpr size_t MIN_OBSERVATIONS = 32;
+        static constexpr double OBSERVATION_WEIGHT = 1.0 / 64.0;
+
+        AdmissionController(size_t total_pages, size_t tokens_per_page) noexcept
+            : total_pages_(total_pages), tokens_per_page_(tokens_per_page) {}
+
+        /**
+         * @brief Fraction of the pool admission keeps free.
+         * @throws std::invalid_argument outside [0, 1).
+         */
+        void set_watermark(double free_fraction);
+        [[nodiscard]] size_t watermark_pages() const noexcept { return watermark_pages_; }
+
+        /**
+         * @brief Charges predicted rather than maximum output. Sequences can
+         * then outgrow their charge, so the scheduler must be able to preempt
+         * running decodes.
+         */
+        void set_predict_output_lengths(bool enabled) noexcept { predict_ = enabled; }
+        [[nodiscard]] bool predicts_output_lengths() const noexcept { return predict_; }
+
+        /** @brief Pages to charge a sequence with `prompt_len` tokens and up to `max_new_tokens` more. */
+        [[nodiscard]] size_t pages_needed(size_t prompt_len, size_t max_new_tokens) const noexcept;
+
+        /**
+         * @param free_pages Pages free in the pool now.
+         * @param outstanding_pages Pages admitted sequences are charged but don't hold yet.
+         * @param needed The candidate's charge (pages_needed()).
+         */
+        [[nodiscard]] bool admits(size_t free_pages, size_t outstanding_pages, size_t needed) const noexcept;
+
+        /** @brief Learns from a sequence that finished on its own (stop token or length). */
+        void observe_finished(size_t generated_tokens, size_t max_new_tokens) noexcept;
+
+        /** @brief Fraction of max_generated_tokens charged for output; 1 until prediction kicks in. */
+        [[nodiscard]] double output_fraction() const noexcept;
+
+    private:
+        size_t total_pages_;
+        size_t tokens_per_page_;
+        size_t watermark_pages_ = 0;
+        bool predict_ = false;
+
+        // EWMA of the fraction of their limit finished sequences used.
+        size_t observations_ = 0;
+        double mean_fraction_ = 0.0;
+        double mean_square_fraction_ = 0.0;
+    };
+
+} // namespace pie_core::engine
@@ -1,12 +1,60 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
 #include <mlx/mlx.h>
+#include <mlx/allocator.h>
 
 namespace mx = mlx::core;
 
+namespace pie_core::sequence {
+    class Sequence;
+}
+
 namespace pie_core::engine {
 
+    class PersistentBlockTable;
+
+    /**
+     * @brief How a step's `consolidated_block_table` is laid out.
+     */
+    enum class BlockTableLayout : uint8_t {
+        DENSE,      // [num_sequences, max_pages], padded with -1; rebuilt every step
+        PERSISTENT, // A PersistentBlockTable, plus each sequence's row; O(pages appended) per step
+        CSR,        // Flat page ids plus [num_sequences + 1] offsets; no padding
+    };
+
+    /**
+     * @brief Where a step's block table comes from (DENSE and CSR: the chunks'
+     * page tables).
+     */
+    struct BlockTableSpec {
+        BlockTableLayout layout = BlockTableLayout::DENSE;
+        PersistentBlockTable* table = nullptr; // PERSISTENT: kept current by the caller
+        std::span<const uint32_t> rows = {};   // PERSISTENT: each chunk's row in `table`
+    };
+
+    /**
+     * @brief One sequence's contribution to a step: logical tokens [start, start + length).
+     */
+    struct TokenChunk {
+        const sequence::Sequence* sequence;
+        size_t start;
+        size_t length;
+    };
+
+    /**
+     * @brief Builds the `token_ids` array for a step.
+     *
+     * Each chunk is copied straight from its sequence (prompt tokens straight out
+     * of shared memory) into an MLX-allocated buffer that the returned array adopts,
+     * so every token is copied exactly once.
+     */
+    mx::array gather_token_ids(std::span<const TokenChunk> chunks);
+
     struct BatchDetails {
 
         /**
@@ -24,6 +72,12 @@ namespace pie_core::engine {
          */
         mx::array positions;
 
+        /**
+         * @brief KV cache slot each token's entries are written to:
+         * page_id * TOKEN_CAPACITY_PER_PAGE + offset within the page.
+         * Shape: [total_tokens_in_step]
+         */
+        mx::array slot_mapping;
 
         // --- Sequence Mapping & Length Information ---
 
@@ -54,16 +108,24 @@ namespace pie_core::engine {
 
         /**
          * @brief The consolidated block table mapping logical blocks to physical page IDs
-         *        for ALL sequences in the batch.
+         *        for ALL sequences in the batch, laid out per `block_table_layout`:
          *
-         * The exact format (e.g., 1D flattened, 2D [seq_idx, block_idx]) and
-         * indexing scheme MUST be co-designed and synchronized with the specific
-         * requirements of the Paged Attention Metal kernel implementation.
-         * It might map a batch-local sequence index and a logical block index
-         * to a physical page ID managed by the PageAllocator.
+         *  - DENSE: [num_sequences, max_pages], row i for batch sequence i, padded with -1.
+         *  - PERSISTENT: the whole [num_rows, row_capacity] PersistentBlockTable;
+         *    batch sequence i uses row `block_table_index[i]`.
+         *  - CSR: flat [total_pages]; batch sequence i's pages are
+         *    [block_table_index[i], block_table_index[i + 1]).
          */
         mx::array consolidated_block_table;
 
+        BlockTableLayout block_table_layout = BlockTableLayout::DENSE;
+
+        /**
+         * @brief Row per sequence (PERSISTENT, [num_sequences]) or offsets
+         * (CSR, [num_sequences + 1]) into `consolidated_block_table`. Unset for DENSE.
+         */
+        std::optional<mx::array> block_table_index;
+
 
         // --- Batch Metadata ---
 
@@ -86,4 +148,113 @@ namespace pie_core::engine {
          */
         std::optional<mx::array> attention_mask;
     };
+
+    /**
+     * @brief Assembles the full BatchDetails for a step from its chunks.
+     *
+     * Chunk order defines the batch layout. `consolidated_block_table` is a
+     * [num_sequences, max_pages] int32 array, padded with -1.
+     */
+    BatchDetails build_batch_details(std::span<const TokenChunk> chunks);
+
+    /**
+     * @brief As above, with the step's input tokens supplied by the caller
+     * (e.g. tokens sampled on-device by the previous step, not yet on the
+     * host) and the block table laid out per `block_table`. `token_ids` must
+     * hold one int32 per chunk token, in chunk order.
+     */
+    BatchDetails build_batch_details(
+        std::span<const TokenChunk> chunks,
+        mx::array token_ids,
+        const BlockTableSpec& block_table = {}
+    );
+
+    /**
+     * @brief Builds each step's BatchDetails into preallocated memory, for the
+     * scheduler's hot path.
+     *
+     * Token ids, positions, slot mapping and block table are written in place
+     * into MLX-allocated buffers sized for `max_tokens_in_batch` and
+     * `max_num_seqs`, and the step's arrays wrap those buffers without owning
+     * them; the metadata vectors keep their capacity across steps. Two buffer
+     * sets alternate, so the arrays of one step stay intact while the next is
+     * built; they must not be used after the step after that. A DENSE or CSR
+     * block table only reallocates when it needs more room than ever before.
+     */
+    class BatchDetailsBuilder {
+    public:
+        BatchDetailsBuilder(size_t max_num_seqs, size_t max_tokens_in_batch);
+        ~BatchDetailsBuilder();
+
+        /**
+         * @brief Lays out `chunks` (same rules as build_batch_details).
+         * @throws std::length_error if they exceed the builder's capacity.
+         */
+        const BatchDetails& build(std::span<const TokenChunk> chunks, const BlockTableSpec& block_table = {});
+
+        /**
+         * @brief Lays out a step's positions, slot mapping, block table and
+         * metadata ahead of its token ids (e.g. while the previous step, whose
+         * samples are those ids, is still on the device). The next build()
+         * only copies token ids if it gets the same chunks, rows and layout
+         * and no chunk's page table has changed size since; otherwise it lays
+         * the step out as usual. A later prepare() replaces this one.
+         * @throws std::length_error if the chunks exceed the builder's capacity.
+         */
+        void prepare(std::span<const TokenChunk> chunks, const BlockTableSpec& block_table = {});
+
+        /**
+         * @brief Lays out a multi-step decode run of one-token `chunks`: step j
+         * computes each chunk's token at start + j, with the pages for every
+         * step already in the page tables. Each step's `token_ids` are left to
+         * the caller, as they are the previous step's samples, still on the
+         * device. The steps share one buffer set, so all of them stay intact
+         * until the build after next.
+         * @throws std::invalid_argument if a chunk isn't one token or `num_steps` is zero.
+         * @throws std::length_error if the chunks exceed the builder's capacity.
+         */
+        std::span<BatchDetails> build_run(
+            std::span<const TokenChunk> chunks,
+            size_t num_steps,
+            const BlockTableSpec& block_table = {}
+        );
+
+        BatchDetailsBuilder(const BatchDetailsBuilder&) = delete;
+        BatchDetailsBuilder& operator=(const BatchDetailsBuilder&) = delete;
+
+    private:
+        struct BufferSet {
+            mx::allocator::Buffer token_ids{nullptr};
+            mx::allocator::Buffer positions{nullptr};
+            mx::allocator::Buffer slot_mapping{nullptr};
+            mx::allocator::Buffer block_table{nullptr};       // DENSE or CSR pages
+            mx::allocator::Buffer block_table_index{nullptr}; // Rows or offsets
+            size_t block_table_capacity = 0;                  // Entries block_table has room for
+            size_t token_capacity = 0;                        // Entries positions and slot_mapping have room for
+            std::optional<BatchDetails> details;
+            std::vector<BatchDetails> run;                    // Steps of a decode run (see build_run)
+        };
+
+        // What the next buffer set was prepared for.
+        struct PreparedChunk {
+            const sequence::Sequence* sequence;
+            size_t start;
+            size_t length;
+            size_t num_pages;
+        };
+
+        size_t max_num_seqs_;
+        size_t max_tokens_in_batch_;
+        std::array<BufferSet, 2> buffer_sets_;
+        size_t next_set_ = 0;
+        std::vector<PreparedChunk> prepared_;
+        std::vector<uint32_t> prepared_rows_;
+        BlockTableLayout prepared_layout_ = BlockTableLayout::PERSISTENT;
+        bool has_prepared_ = false;
+        std::vector<TokenChunk> run_chunks_; // Reused by build_run()
+
+        void lay_out(BufferSet& set, std::span<const TokenChunk> chunks, const BlockTableSpec& block_table);
+        [[nodiscard]] bool matches_prepared(std::span<const TokenChunk> chunks, const BlockTableSpec& block_table) const;
+    };
+
 } // namespace pie_core::engine
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pie_core::engine {
+
+    // What the scheduler knows about a step when it asks for the batch mix.
+    struct BatchState {
+        size_t num_decoding = 0;           // Running sequences due one decode token
+        size_t num_prefilling = 0;         // Running sequences with prompt left to prefill
+        size_t pending_prefill_tokens = 0; // Prompt tokens left across those
+        size_t token_budget = 0;           // Max tokens in the step
+    };
+
+    // How a step's token budget is split. Both caps apply on top of the total
+    // budget; decodes are scheduled first, then prefill chunks.
+    struct BatchMix {
+        size_t max_decode_tokens = 0;
+        size_t max_prefill_tokens = 0;
+    };
+
+    /**
+     * @brief Decides each step's mix of decode and prefill work, trading time
+     * to first token against time per output token.
+     *
+     * Built in:
+     *  - "hybrid" (default): stall-free. Every decode runs each step and the
+     *    leftover budget goes to prefill chunks.
+     *  - "prefill-first": while any prompt is being prefilled the step is
+     *    prefill only; decodes stall. Best TTFT.
+     *  - "decode-first": while anything is decoding the step is decode only;
+     *    new prompts wait for a step without decodes. Best TPOT.
+     *
+     * Policies are called on the scheduler thread only.
+     */
+    class IBatchPolicy {
+    public:
+        virtual ~IBatchPolicy() = default;
+
+        virtual BatchMix plan(const BatchState& state) = 0;
+
+        [[nodiscard]] virtual std::string name() const = 0;
+    };
+
+    using BatchPolicyCreatorFunc = std::function<std::unique_ptr<IBatchPolicy>()>;
+
+    class BatchPolicyRegistry {
+    public:
+        static bool register_policy(const std::string& policy_name, BatchPolicyCreatorFunc creator);
+
+        /** @throws std::runtime_error for an unknown name. */
+        static std::unique_ptr<IBatchPolicy> create_policy(const std::string& policy_name);
+
+        /** @brief Registered names, sorted. */
+        static std::vector<std::string> policy_names();
+
+        BatchPolicyRegistry(const BatchPolicyRegistry&) = delete;
+        BatchPolicyRegistry& operator=(const BatchPolicyRegistry&) = delete;
+
+    private:
+        BatchPolicyRegistry() = default;
+        static std::unordered_map<std::string, BatchPolicyCreatorFunc>& get_registry();
+    };
+
+    template <typename T>
+    class BatchPolicyRegistrar {
+    public:
+        BatchPolicyRegistrar(const std::string& policy_name) {
+            BatchPolicyRegistry::register_policy(policy_name, []() {
+                return std::make_unique<T>();
+            });
+        }
+    };
+
+} // namespace pie_core::engine
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <mlx/mlx.h>
+#include <mlx/allocator.h>
+
+namespace mx = mlx::core;
+
+namespace pie_core::engine {
+
+    /**
+     * @brief Block table that lives across steps, one row per scheduler slot.
+     *
+     * Row i belongs to whichever sequence holds slot i of the scheduler's
+     * SlotTable, for as long as it holds KV pages. Rows are
+     * patched as pages are appended, so keeping the table current costs
+     * O(pages appended) per step instead of O(pages held by the batch); a step
+     * only has to say which row each of its sequences uses.
+     *
+     * The table is a [num_rows, row_capacity] int32 buffer in MLX memory,
+     * padded with -1, that `array()` wraps without copying. Rows start
+     * `INITIAL_ROW_CAPACITY` pages wide and the whole table doubles in width
+     * when a sequence outgrows them. A step still on the device may hold an
+     * earlier `array()`, so outgrown buffers are only freed with the table;
+     * having doubled, they add up to less than the current one.
+     * Not thread-safe; owned by the scheduler thread.
+     */
+    class PersistentBlockTable {
+    public:
+        static constexpr size_t INITIAL_ROW_CAPACITY = 16;
+
+        explicit PersistentBlockTable(size_t num_rows);
+        ~PersistentBlockTable();
+
+        /** @brief Empties `row` for its next owner. */
+        void clear_row(uint32_t row) { sync_row(row, {}); }
+
+        /**
+         * @brief Brings `row` up to date with `page_table`. Only entries past
+         * the row's current length are written; a shorter page table clears
+         * the tail.
+         */
+        void sync_row(uint32_t row, std::span<const uint32_t> page_table);
+
+        /** @brief The whole table, [num_rows, row_capacity]; borrows the buffer. */
+        [[nodiscard]] mx::array array();
+
+        [[nodiscard]] size_t num_rows() const noexcept { return row_lengths_.size(); }
+        [[nodiscard]] size_t row_capacity() const noexcept { return row_capacity_; }
+        [[nodiscard]] size_t row_length(uint32_t row) const { return row_lengths_.at(row); }
+        [[nodiscard]] int32_t page_at(uint32_t row, size_t index) const;
+
+        PersistentBlockTable(const PersistentBlockTable&) = delete;
+        PersistentBlockTable& operator=(const PersistentBlockTable&) = delete;
+
+    private:
+        mx::allocator::Buffer buffer_{nullptr};
+        int32_t* entries_ = nullptr; // buffer_'s memory
+        size_t row_capacity_ = INITIAL_ROW_CAPACITY;
+        std::vector<uint32_t> row_lengths_;
+        std::vector<mx::allocator::Buffer> outgrown_;
+
+        void grow(size_t min_capacity);
+    };
+
+} // namespace pie_core::engine
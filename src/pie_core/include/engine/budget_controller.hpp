@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace pie_core::engine {
+
+    /**
+     * @brief Feedback loop that sizes the per-step token budget to hold a
+     * target step time, i.e. a target time per output token for decoding
+     * sequences.
+     *
+     * Every `ADJUST_INTERVAL` steps that carried decodes, it takes the mean
+     * step time and token count and rescales the budget by target / measured.
+     * Steps without decodes are ignored: nobody is waiting on their latency,
+     * so prefill-only steps may use the full budget. The budget only grows
+     * when it was actually binding (steps came close to filling it), moves at
+     * most 2x per adjustment and is damped by averaging with the old value.
+     *
+     * With the prefill chunk taking whatever budget the decodes leave, this
+     * one number sets both the batch size and the prefill chunk size.
+     */
+    class BudgetController {
+    public:
+        static constexpr size_t ADJUST_INTERVAL = 4;
+        static constexpr size_t MIN_TOKENS = 16;
+
+        explicit BudgetController(size_t max_tokens) noexcept : max_tokens_(max_tokens), budget_(max_tokens) {}
+
+        /** @brief Target step time; zero turns the controller off (fixed, maximum budget). */
+        void set_target(std::chrono::microseconds target) noexcept;
+        [[nodiscard]] std::chrono::microseconds target() const noexcept { return target_; }
+
+        /** @brief Feeds back one executed step. */
+        void observe(double step_us, size_t tokens, bool had_decodes) noexcept;
+
+        [[nodiscard]] size_t token_budget() const noexcept { return budget_; }
+        [[nodiscard]] size_t max_tokens() const noexcept { return max_tokens_; }
+
+    private:
+        size_t max_tokens_;
+        size_t budget_;
+        std::chrono::microseconds target_{0};
+
+        // Current measurement window.
+        size_t window_steps_ = 0;
+        double window_us_ = 0.0;
+        size_t window_tokens_ = 0;
+        size_t window_budget_ = 0; // Sum of the budgets in force
+    };
+
+} // namespace pie_core::engine
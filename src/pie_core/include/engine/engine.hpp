@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "engine/fair_share.hpp"
+#include "engine/token_stream.hpp"
+#include "sequence/sampling_params.hpp"
+#include "sequence/logits_params.hpp"
+#include "sequence/stop_criteria.hpp"
+#include "sequence/scheduling_params.hpp"
+
+namespace pie_core::engine {
+
+    struct EngineConfig {
+        size_t num_kv_pages = 4096;
+        size_t max_num_seqs = 256;
+        size_t max_tokens_in_batch = 4096;
+        size_t queue_capacity = 1024; // Submitted sequences not yet picked up by the scheduler
+        std::string batch_policy = "hybrid"; // See IBatchPolicy
+        uint32_t target_step_time_us = 0;    // Token budget follows this step time; 0 = fixed budget
+        size_t decode_steps = 1;             // Multi-step decode run length (see Scheduler::set_decode_steps)
+        double kv_watermark = 0.0;           // Fraction of KV pages admission keeps free
+        bool predict_output_lengths = false; // Charge admission for predicted, not maximum, output
+    };
+
+    /**
+     * @brief The whole engine inside the calling process, without the IPC hop.
+     *
+     * Owns the model, KV pool and scheduler, and runs the scheduler loop on its
+     * own native thread. Requests are submitted straight into the scheduler's
+     * hand-off queue (the prompt is copied once, into the sequence), and tokens
+     * come back through a TokenStream per request.
+     *
+     * Consumers either block on a stream (`TokenStream::wait`) or, for event
+     * loops, watch `wakeup_fd()`: it turns readable after every step that
+     * produced output, and `take_ready()` names the streams with new tokens.
+     *
+     * All public methods are thread-safe.
+     */
+    class Engine {
+    public:
+        explicit Engine(const std::string& model_path, EngineConfig config = {});
+        ~Engine();
+
+        /**
+         * @brief Queues a request.
+         * @return Its token stream, or nullptr if the hand-off queue is full.
+         */
+        std::shared_ptr<TokenStream> submit(
+            std::span<const int32_t> prompt,
+            const sequence::SamplingParams& sampling_params = {},
+            sequence::LogitsParams logits_params = {},
+            sequence::StopCriteria stop_criteria = {},
+            const sequence::SchedulingParams& scheduling_params = {}
+        );
+
+        /**
+         * @brief Queues a request whose tokens go to `on_token` on the scheduler
+         * thread instead of being buffered (see TokenStream::Callback).
+         * @return Its (unbuffered) stream, or nullptr if the hand-off queue is full.
+         */
+        std::shared_ptr<TokenStream> submit(
+            std::span<const int32_t> prompt,
+            TokenStream::Callback on_token,
+            const sequence::SamplingParams& sampling_params = {},
+            sequence::LogitsParams logits_params = {},
+            sequence::StopCriteria stop_criteria = {},
+            const sequence::SchedulingParams& scheduling_params = {}
+        );
+
+        /**
+         * @brief Cancels a request. Its stream is closed with CANCELLED by the
+         * next step; a no-op if it already finished.
+         */
+        void cancel(uint64_t request_id);
+
+        /**
+         * @brief Sets a tenant's fair-share weight and rate limit; takes effect
+         * from the next step. Requests name their tenant in SchedulingParams.
+         * @throws std::invalid_argument if the weight isn't positive or a rate is negative.
+         */
+        void set_tenant_policy(uint32_t tenant_id, const TenantPolicy& policy);
+
+        /**
+         * @brief Switches the batch policy by registered name; takes effect from
+         * the next step.
+         * @throws std::runtime_error for an unknown name.
+         */
+        void set_batch_policy(const std::string& policy_name);
+
+        /** @brief Readable while `take_ready()` has something to return. */
+        [[nodiscard]] int wakeup_fd() const noexcept;
+
+        /** @brief Request ids whose streams received tokens since the last call. */
+        std::vector<uint64_t> take_ready();
+
+        /** @brief Stops the scheduler thread and closes every open stream. Idempotent. */
+        void shutdown();
+
+        Engine(const Engine&) = delete;
+        Engine& operator=(const Engine&) = delete;
+        Engine(Engine&&) = delete;
+        Engine& operator=(Engine&&) = delete;
+
+    private:
+        struct EngineImpl;
+
+        std::shared_ptr<TokenStream> enqueue(
+            std::shared_ptr<TokenStream> stream,
+            std::span<const int32_t> prompt,
+            const sequence::SamplingParams& sampling_params,
+            sequence::LogitsParams logits_params,
+            sequence::StopCriteria stop_criteria,
+            const sequence::SchedulingParams& scheduling_params
+        );
+        std::unique_ptr<EngineImpl> pimpl_;
+    };
+
+} // namespace pie_core::engine
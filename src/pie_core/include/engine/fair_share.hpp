@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+
+namespace pie_core::engine {
+
+    struct TenantPolicy {
+        double weight = 1.0;            // Share of processed tokens relative to other tenants
+        double tokens_per_second = 0.0; // Token-bucket refill rate; 0 = unlimited
+        double burst_tokens = 0.0;      // Bucket depth; 0 = one second's worth
+    };
+
+    /**
+     * @brief Per-tenant accounting for weighted fair sharing of engine tokens.
+     *
+     * Virtual-time fair queuing: every token processed for a tenant (prefill or
+     * decode) advances its virtual time by 1 / weight, and the scheduler serves
+     * the backlogged tenant with the lowest virtual time first. A tenant that
+     * returns from idle starts at the lowest virtual time among active tenants,
+     * so idle periods don't bank credit.
+     *
+     * Optional token buckets cap each tenant's rate on top of its share. Tokens
+     * are charged as they are processed, so a bucket may go into debt (a long
+     * decode tail); the tenant gets no new prefill until it has refilled.
+     *
+     * Tenants without a policy weigh 1.0 and are unlimited. Not thread-safe;
+     * owned by the scheduler thread.
+     */
+    class FairShare {
+    public:
+        /** @throws std::invalid_argument if the weight isn't positive or a rate is negative. */
+        static void validate(const TenantPolicy& policy);
+
+        void set_policy(uint32_t tenant_id, const TenantPolicy& policy);
+        [[nodiscard]] TenantPolicy policy(uint32_t tenant_id) const;
+
+        /** @brief A sequence of the tenant was queued (lifts an idle tenant's virtual time). */
+        void add_work(uint32_t tenant_id);
+        /** @brief A sequence of the tenant left the scheduler. */
+        void remove_work(uint32_t tenant_id);
+
+        /** @brief Refills every token bucket up to `now_ns` (steady clock). */
+        void refill(uint64_t now_ns);
+
+        /** @brief Accounts `tokens` processed for the tenant. */
+        void charge(uint32_t tenant_id, size_t tokens);
+
+        [[nodiscard]] double virtual_time(uint32_t tenant_id) const;
+        [[nodiscard]] double weight(uint32_t tenant_id) const;
+
+        /** @brief True while the tenant's bucket is empty; its prefills wait. */
+        [[nodiscard]] bool rate_limited(uint32_t tenant_id) const;
+
+        /**
+         * @brief When the first rate-limited tenant with queued work is back
+         * under its rate (steady clock, ns); UINT64_MAX if none is waiting.
+         */
+        [[nodiscard]] uint64_t next_refill_ns() const;
+
+        [[nodiscard]] size_t num_tenants() const noexcept { return tenants_.size(); }
+
+    private:
+        struct TenantState {
+            TenantPolicy policy;
+            bool has_policy = false;
+            double virtual_time = 0.0;
+            double bucket = 0.0;
+            size_t active_sequences = 0;
+        };
+
+        std::unordered_map<uint32_t, TenantState> tenants_;
+        uint64_t last_refill_ns_ = 0;
+
+        TenantState& state(uint32_t tenant_id);
+        [[nodiscard]] const TenantState* find(uint32_t tenant_id) const;
+    };
+
+} // namespace pie_core::engine
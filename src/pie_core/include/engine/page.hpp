@@ -74,6 +74,13 @@ namespace pie_core::engine {
         mx::array& key_cache_scale()   noexcept { return key_cache_scale_;  }
         mx::array& value_cache_scale() noexcept { return value_cache_scale_;}
 
+        // Copies `keys` and `values` ([count, num_heads, head_dim], in the cache
+        // dtype) into token slots [slot, slot + count) of the page's own buffers,
+        // in place. Host-side, for callers outside the model's kernels.
+        // Throws std::invalid_argument on a layout mismatch and
+        // std::out_of_range past the end of the page.
+        void write_tokens(size_t slot, const mx::array& keys, const mx::array& values);
+
         // Atomically increment the reference count.
         // Returns the new count.
         uint32_t add_ref() {
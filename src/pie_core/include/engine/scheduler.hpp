@@ -2,31 +2,58 @@
 
 #include <memory>
 #include <cstdint>
+#include <cstddef>
+#include <chrono>
 #include <optional>
+#include <string>
 
-namespace pie_core {
+#include "ipc/spsc_queue.hpp"
+
+namespace pie_core::engine {
     class PageAllocator;
+    enum class BlockTableLayout : uint8_t;
+}
+
+namespace pie_core::sequence {
     class Sequence;
+}
+
+namespace pie_core::models {
     class IModel;
 }
 
+namespace pie_core::ipc {
+    struct EngineLoad;
+}
+
 namespace pie_core::engine {
 
+    class ITokenSink;
+    class IBatchPolicy;
+    struct TenantPolicy;
+
     /**
      * @brief Orchestrates LLM inference requests, managing batching and resources.
      */
     class Scheduler {
     public:
+        // New sequences handed over by the IPCReader thread.
+        using SequenceQueue = ipc::SPSCQueue<std::unique_ptr<sequence::Sequence>>;
+
         /**
          * @brief Constructor. Initializes the scheduler with necessary components.
          * @param allocator A reference to the PageAllocator for KV cache management.
          * @param model A unique pointer to the loaded model object (Scheduler takes ownership).
+         * @param incoming Queue new sequences are pushed into (IPCReader or Engine).
+         * @param token_sink Where generated tokens are streamed (optional).
          * @param max_num_seqs Max concurrent sequences the scheduler will manage.
          * @param max_tokens_in_batch Max total tokens per GPU batch.
          */
         Scheduler(
             PageAllocator& allocator,
-            std::unique_ptr<IModel> model,
+            std::unique_ptr<models::IModel> model,
+            SequenceQueue& incoming,
+            ITokenSink* token_sink = nullptr,
             size_t max_num_seqs = 256,
             size_t max_tokens_in_batch = 4096
         );
@@ -38,10 +65,102 @@ namespace pie_core::engine {
 
         /**
          * @brief Executes a single step of the scheduler's main loop.
-         * @return True if any work was performed (batch executed), false if idle.
+         *
+         * Steps are pipelined one deep: a step launches its batch without
+         * waiting for it, and the next step collects the sampled tokens after
+         * doing its own queue intake and admission, reserving the KV pages the
+         * next decode tokens need and, when it is a plain decode, laying out
+         * the next batch, all while the device is busy.
+         * @return True if any work was performed (batch launched or collected), false if idle.
          */
         bool step();
 
+        /**
+         * @brief Idle path: blocks until a new sequence arrives or the timeout elapses.
+         * Returns immediately if sequences are waiting or running and the last
+         * step made progress. If it made none (every tenant with work over its
+         * rate, or out of KV pages), sleeps at most until the earliest
+         * tenant's bucket refills, and never more than a few milliseconds.
+         */
+        void wait_for_work(std::chrono::microseconds timeout);
+
+        /**
+         * @brief Marks a queued or running sequence cancelled. It is retired, its
+         * pages freed and its stream finished with CANCELLED on the next step.
+         * Scheduler thread only.
+         * @return False if no such sequence is queued or running.
+         */
+        bool cancel(uint64_t sequence_id);
+
+        /**
+         * @brief Replaces the policy that splits each step between decode and
+         * prefill work ("hybrid" by default; see IBatchPolicy). Takes effect
+         * from the next step. Scheduler thread only, or before it starts.
+         */
+        void set_batch_policy(std::unique_ptr<IBatchPolicy> policy);
+        [[nodiscard]] std::string batch_policy_name() const;
+
+        /**
+         * @brief Holds decode steps to `target` by resizing the per-step token
+         * budget (never above max_tokens_in_batch); zero keeps the budget fixed
+         * at the maximum. Scheduler thread only, or before it starts.
+         */
+        void set_target_step_time(std::chrono::microseconds target) noexcept;
+        /** @brief The token budget in force (see set_target_step_time). */
+        [[nodiscard]] size_t token_budget() const noexcept;
+
+        /**
+         * @brief Multi-step decode: a batch that is only decoding, with nothing
+         * queued, runs up to `steps` decode steps per launch with the sampled
+         * tokens kept on the device in between, and its output reaches the
+         * token sink once per run. 1 (the default) disables it. Sequences with
+         * logit processors always decode one step at a time. Scheduler thread
+         * only, or before it starts.
+         * @throws std::invalid_argument if `steps` is zero.
+         */
+        void set_decode_steps(size_t steps);
+
+        /**
+         * @brief Fraction of the KV pool admission keeps free on top of what
+         * running sequences are expected to need (see AdmissionController); 0
+         * by default. Scheduler thread only, or before it starts.
+         * @throws std::invalid_argument outside [0, 1).
+         */
+        void set_kv_watermark(double free_fraction);
+
+        /**
+         * @brief Charges admitted sequences for the output they are predicted
+         * to generate, learned from finished ones, instead of their whole
+         * max_generated_tokens. Sequences that outgrow their charge and run
+         * the pool dry are preempted and recomputed later, so prompts are kept
+         * until sequences finish. Off by default. Scheduler thread only, or
+         * before it starts.
+         */
+        void set_predict_output_lengths(bool enabled) noexcept;
+
+        /**
+         * @brief Chooses how steps lay out their block table (see BatchDetails);
+         * PERSISTENT by default. The persistent table is kept current either
+         * way. Scheduler thread only, or before it starts.
+         */
+        void set_block_table_layout(BlockTableLayout layout);
+
+        /**
+         * @brief Sets a tenant's fair-share weight and rate limit (see FairShare).
+         * Scheduler thread only, or before the scheduler thread starts.
+         * @throws std::invalid_argument if the weight isn't positive or a rate is negative.
+         */
+        void set_tenant_policy(uint32_t tenant_id, const TenantPolicy& policy);
+
+        /**
+         * @brief Publishes load stats and the admission decision to `load` after
+         * every step (usually the request queue's shared control block).
+         */
+        void publish_load_to(ipc::EngineLoad* load) noexcept;
+
+        [[nodiscard]] size_t num_waiting() const noexcept;
+        [[nodiscard]] size_t num_running() const noexcept;
+
         // --- Prevent Copying/Moving ---
         Scheduler(const Scheduler&) = delete;
         Scheduler& operator=(const Scheduler&) = delete;
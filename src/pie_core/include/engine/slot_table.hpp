@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "sequence/scheduling_params.hpp"
+
+namespace pie_core::engine {
+
+    /**
+     * @brief Where a running sequence is in its life, as the scheduler sees it.
+     */
+    enum class SlotState : uint8_t {
+        FREE,
+        PREFILLING,
+        DECODING,
+        STOPPED // Hit a stop token or its length limit; awaiting retirement
+    };
+
+    /**
+     * @brief The scheduler's per-step view of its running sequences, one slot
+     * each, as parallel arrays.
+     *
+     * Every step walks all running sequences several times (batch state,
+     * decode scheduling, retirement, load estimates). Reading these fields
+     * from each heap-allocated Sequence chases a pointer per sequence per
+     * pass; here each pass is a linear scan over a few small arrays. The
+     * Sequence stays the record of the tokens themselves and is only read to
+     * load a slot on admission.
+     *
+     * Each slot also carries the sequence's cancel state: a flag the
+     * scheduler sets, and optionally a client-owned cancel word (e.g. in a
+     * shared-memory response channel) that `poll_cancellations()` folds in.
+     *
+     * A slot also names the sequence's row in the persistent block table.
+     * Not thread-safe; owned by the scheduler thread.
+     */
+    class SlotTable {
+    public:
+        explicit SlotTable(size_t num_slots);
+
+        /** @return A free slot, or std::nullopt if every slot is taken. */
+        std::optional<uint32_t> acquire();
+
+        /** @brief Frees `slot`; its fields are meaningless until loaded again. */
+        void release(uint32_t slot);
+
+        /**
+         * @brief Loads a newly admitted sequence: PREFILLING, nothing cached,
+         * no pages, not cancelled. `cancel_word`, if given, must outlive the
+         * slot's tenancy; nonzero means cancelled.
+         */
+        void load(
+            uint32_t slot,
+            sequence::Priority priority,
+            size_t logical_len,
+            int32_t last_token,
+            size_t max_new_tokens,
+            const std::atomic<uint32_t>* cancel_word = nullptr
+        );
+
+        /**
+         * @brief Records a sampled token: the sequence is DECODING, or STOPPED
+         * if `stop` is set or its generation budget is used up.
+         */
+        void append_token(uint32_t slot, int32_t token_id, bool stop);
+
+        void cancel(uint32_t slot) { cancelled_[slot] = 1; }
+
+        void add_computed(uint32_t slot, size_t tokens) { computed_[slot] += static_cast<uint32_t>(tokens); }
+        void set_num_pages(uint32_t slot, size_t pages) { num_pages_[slot] = static_cast<uint32_t>(pages); }
+        /** @brief Pages admission charged the sequence with (see AdmissionController). */
+        void set_charged_pages(uint32_t slot, size_t pages) { charged_pages_[slot] = static_cast<uint32_t>(pages); }
+
+        [[nodiscard]] size_t num_slots() const noexcept { return state_.size(); }
+        [[nodiscard]] SlotState state(uint32_t slot) const { return state_[slot]; }
+        [[nodiscard]] sequence::Priority priority(uint32_t slot) const { return priority_[slot]; }
+        [[nodiscard]] size_t logical_len(uint32_t slot) const { return logical_len_[slot]; }
+        [[nodiscard]] size_t computed(uint32_t slot) const { return computed_[slot]; }
+        [[nodiscard]] int32_t last_token(uint32_t slot) const { return last_token_[slot]; }
+        [[nodiscard]] size_t num_pages(uint32_t slot) const { return num_pages_[slot]; }
+        [[nodiscard]] size_t remaining(uint32_t slot) const { return remaining_[slot]; }
+        [[nodiscard]] bool cancelled(uint32_t slot) const { return cancelled_[slot] != 0; }
+
+        // --- Whole-table passes ---
+
+        /** @brief Occupied slots in `state`. */
+        [[nodiscard]] size_t count(SlotState state) const noexcept;
+
+        /**
+         * @brief Prompt tokens the PREFILLING slots have yet to compute, per
+         * priority class.
+         */
+        [[nodiscard]] std::array<size_t, 3> pending_prefill_tokens() const noexcept;
+
+        /**
+         * @brief Fewest tokens any DECODING slot may still generate;
+         * SIZE_MAX if none is decoding.
+         */
+        [[nodiscard]] size_t min_remaining() const noexcept;
+
+        /**
+         * @brief Marks occupied slots whose cancel word is set cancelled.
+         * @return How many were newly cancelled.
+         */
+        size_t poll_cancellations() noexcept;
+
+        /**
+         * @brief Pages PREFILLING and DECODING slots are charged but don't
+         * hold yet.
+         */
+        [[nodiscard]] size_t outstanding_pages() const noexcept;
+
+    private:
+        std::vector<SlotState> state_;
+        std::vector<sequence::Priority> priority_;
+        std::vector<uint32_t> logical_len_; // Prompt plus generated tokens
+        std::vector<uint32_t> computed_;    // Tokens whose KV entries are cached
+        std::vector<int32_t> last_token_;
+        std::vector<uint32_t> num_pages_;
+        std::vector<uint32_t> charged_pages_;
+        std::vector<uint32_t> remaining_;   // Tokens it may still generate
+        std::vector<uint8_t> cancelled_;
+        std::vector<const std::atomic<uint32_t>*> cancel_words_;
+        std::vector<uint32_t> free_slots_;
+    };
+
+} // namespace pie_core::engine
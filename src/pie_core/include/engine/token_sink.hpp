@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+#include "ipc/ipc_response.hpp"
+
+namespace pie_core::sequence {
+    class Sequence;
+}
+
+namespace pie_core::ipc {
+    class ResponseWriter;
+}
+
+namespace pie_core::engine {
+
+    /**
+     * @brief Where the scheduler delivers generated tokens.
+     *
+     * All calls come from the scheduler thread. `emit` and `finish` may only
+     * buffer; `flush` runs once at the end of every step and is where consumers
+     * should be woken, so a step costs one wakeup however many tokens it produced.
+     */
+    class ITokenSink {
+    public:
+        virtual ~ITokenSink() = default;
+
+        /** @brief One sampled token; `finish_reason` is set on the sequence's last one. */
+        virtual void emit(
+            const sequence::Sequence& sequence,
+            int32_t token_id,
+            std::optional<float> logprob,
+            ipc::FinishReason finish_reason
+        ) = 0;
+
+        /** @brief Ends a stream without a token (cancellation, errors, shutdown). */
+        virtual void finish(const sequence::Sequence& sequence, ipc::FinishReason finish_reason) = 0;
+
+        virtual void flush() = 0;
+
+        /**
+         * @brief A word the sequence's client sets, from any thread or process,
+         * to cancel it; polled by the scheduler every step. nullptr if the
+         * sink's transport has none.
+         */
+        [[nodiscard]] virtual const std::atomic<uint32_t>* cancel_word(const sequence::Sequence&) const {
+            return nullptr;
+        }
+    };
+
+    /**
+     * @brief Streams to the shared-memory response channel named by each
+     * sequence's IPCHandles::response_channel_id.
+     */
+    class ResponseChannelSink final : public ITokenSink {
+    public:
+        explicit ResponseChannelSink(ipc::ResponseWriter& writer) noexcept : writer_(writer) {}
+
+        void emit(
+            const sequence::Sequence& sequence,
+            int32_t token_id,
+            std::optional<float> logprob,
+            ipc::FinishReason finish_reason
+        ) override;
+        void finish(const sequence::Sequence& sequence, ipc::FinishReason finish_reason) override;
+        void flush() override;
+        [[nodiscard]] const std::atomic<uint32_t>* cancel_word(const sequence::Sequence& sequence) const override;
+
+    private:
+        ipc::ResponseWriter& writer_;
+    };
+
+} // namespace pie_core::engine
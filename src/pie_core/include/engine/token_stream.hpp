@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "ipc/ipc_response.hpp"
+
+namespace pie_core::engine {
+
+    /** @brief One generated token, or a bare finish marker (token_id < 0). */
+    struct StreamToken {
+        int32_t token_id;
+        ipc::FinishReason finish_reason;
+    };
+
+    /**
+     * @brief In-process counterpart of a response channel: the tokens generated
+     * for one request, handed from the scheduler thread to a consumer thread.
+     *
+     * Unbounded (a slow consumer never stalls the engine) and closed by the entry
+     * carrying a finish reason. Shared between the Engine and the consumer, so it
+     * outlives whichever side lets go first.
+     *
+     * A stream built with a callback buffers nothing: each token is handed to the
+     * callback on the scheduler thread as it is pushed, so the callback must be
+     * quick and must not call back into the Engine's blocking methods.
+     */
+    class TokenStream {
+    public:
+        using Callback = std::function<void(const StreamToken&)>;
+
+        explicit TokenStream(uint64_t request_id) noexcept : request_id_(request_id) {}
+        TokenStream(uint64_t request_id, Callback on_token) noexcept
+            : request_id_(request_id), on_token_(std::move(on_token)) {}
+
+        [[nodiscard]] uint64_t request_id() const noexcept { return request_id_; }
+
+        // --- Producer side (scheduler thread) ---
+
+        /** @brief Appends a token. Returns false if the stream was already closed. */
+        bool push(StreamToken token);
+
+        // --- Consumer side ---
+
+        /** @brief Moves everything buffered so far into `out` without blocking. */
+        size_t read(std::vector<StreamToken>& out);
+
+        /**
+         * @brief Blocks until tokens are buffered, the stream is closed or the
+         * timeout elapses.
+         * @return True if `read()` would return something or the stream is closed.
+         */
+        bool wait(std::chrono::microseconds timeout);
+
+        /** @brief True once the final entry has been pushed (it may not be read yet). */
+        [[nodiscard]] bool closed() const;
+
+        TokenStream(const TokenStream&) = delete;
+        TokenStream& operator=(const TokenStream&) = delete;
+
+    private:
+        const uint64_t request_id_;
+        const Callback on_token_;
+        mutable std::mutex mutex_;
+        std::condition_variable ready_;
+        std::vector<StreamToken> pending_;
+        size_t waiters_ = 0;
+        bool closed_ = false;
+    };
+
+} // namespace pie_core::engine
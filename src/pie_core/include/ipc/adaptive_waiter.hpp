@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ipc/event_notifier.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+namespace pie_core::ipc {
+
+    struct AdaptiveWaitConfig {
+        std::chrono::nanoseconds min_spin{0};
+        std::chrono::nanoseconds max_spin{std::chrono::microseconds(50)};
+        // Spin for this multiple of the smoothed inter-arrival gap.
+        uint32_t spin_gap_multiplier = 2;
+    };
+
+    /**
+     * @brief Spin-then-block wait on an EventNotifier word.
+     *
+     * A futex wakeup costs tens of microseconds; spinning costs a core. The waiter
+     * spins (with a CPU pause hint) for a budget derived from recent inter-arrival
+     * times, then falls back to the blocking wait:
+     *
+     *  - Under load, work arrives within the budget and is picked up at spin
+     *    latency without any syscall on either side.
+     *  - When arrivals are further apart than `max_spin`, the budget decays to
+     *    `min_spin` and the thread sleeps in the kernel, so an idle engine is quiet.
+     *
+     * One waiter per consuming thread; not thread-safe.
+     */
+    class AdaptiveWaiter {
+    public:
+        explicit AdaptiveWaiter(EventNotifier& notifier, AdaptiveWaitConfig config = {}) noexcept;
+
+        /**
+         * @brief Waits until the notifier moves past `observed` or `timeout` elapses.
+         * @return True if a notification arrived, false on timeout.
+         */
+        bool wait(uint32_t observed, std::chrono::microseconds timeout) noexcept;
+
+        /** @brief Current spin budget (for stats and tests). */
+        [[nodiscard]] std::chrono::nanoseconds spin_budget() const noexcept { return spin_budget_; }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        EventNotifier& notifier_;
+        AdaptiveWaitConfig config_;
+        std::chrono::nanoseconds spin_budget_;
+        std::chrono::nanoseconds smoothed_gap_;
+        Clock::time_point last_arrival_;
+
+        void record_arrival(Clock::time_point now) noexcept;
+    };
+
+} // namespace pie_core::ipc
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+
+namespace pie_core::ipc {
+
+    enum class BulkBlockState : uint32_t {
+        IN_USE = 1,   // Producer wrote the block; the engine may still read it
+        RELEASED = 2  // Engine is done with the block; producers may reclaim it
+    };
+
+    /**
+     * @brief Header in front of every block in the bulk arena.
+     *
+     * `position` is the block's absolute (never wrapping) arena cursor. Reclaimers
+     * only trust a header whose `position` matches the cursor they are looking at,
+     * which rejects stale headers left over from earlier laps and headers that are
+     * still being written.
+     */
+    struct alignas(16) BulkBlockHeader {
+        std::atomic<uint64_t> position{0};
+        std::atomic<BulkBlockState> state{BulkBlockState::IN_USE};
+        std::atomic<uint32_t> size{0}; // bytes, header included
+    };
+    static_assert(sizeof(BulkBlockHeader) == 16);
+    static_assert(std::atomic<uint64_t>::is_always_lock_free
+                  && std::atomic<BulkBlockState>::is_always_lock_free);
+
+    struct BulkArenaControl {
+        alignas(64) std::atomic<uint64_t> head{0}; // allocation cursor (bytes, monotonic)
+        alignas(64) std::atomic<uint64_t> tail{0}; // reclaim cursor (bytes, monotonic)
+    };
+
+    /**
+     * @brief Ring allocator with release markers, resident in the bulk shm segment.
+     *
+     * Segment layout: [BulkArenaControl][data ring]. Producers allocate blocks at
+     * `head` with one CAS and write their request arrays behind the block header.
+     * The engine never frees memory itself: it only flips a block's state to
+     * RELEASED once the request no longer needs it (prompt consumed or cached).
+     * Producers then advance `tail` across consecutive RELEASED blocks, so space
+     * is reused in allocation order without any cross-process locking.
+     *
+     * A block that doesn't fit before the end of the ring is preceded by a
+     * RELEASED padding block, so every block is contiguous.
+     *
+     * Like RequestRing this is a view; the memory is owned by the mapping.
+     */
+    class BulkArena {
+    public:
+        static constexpr size_t BLOCK_ALIGNMENT = 64;
+
+        BulkArena(void* segment_base, size_t segment_size);
+
+        /** @brief Resets both cursors. Engine side only, before producers attach. */
+        void initialize() noexcept;
+
+        /**
+         * @brief Reserves a block with room for `payload_bytes` after its header.
+         * Reclaims released space first if needed.
+         * @return Segment offset of the block header, or std::nullopt if full.
+         */
+        std::optional<uint64_t> allocate(size_t payload_bytes);
+
+        /**
+         * @brief Advances `tail` over consecutive released blocks.
+         * @return Bytes reclaimed by this call.
+         */
+        size_t reclaim() noexcept;
+
+        /** @brief Header at a segment offset returned by `allocate()`. */
+        [[nodiscard]] BulkBlockHeader* block_at(uint64_t segment_offset) noexcept {
+            return reinterpret_cast<BulkBlockHeader*>(segment_base_ + segment_offset);
+        }
+
+        /** @brief Marks a block reusable. Called by the engine when it drops a request's data. */
+        static void release(BulkBlockHeader& block) noexcept {
+            block.state.store(BulkBlockState::RELEASED, std::memory_order_release);
+        }
+
+        [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+        [[nodiscard]] size_t used_bytes() const noexcept;
+
+    private:
+        char* segment_base_;
+        BulkArenaControl* control_;
+        char* data_;
+        size_t capacity_;
+
+        BulkBlockHeader* header_for(uint64_t position) noexcept {
+            return reinterpret_cast<BulkBlockHeader*>(data_ + position % capacity_);
+        }
+        void write_header(uint64_t position, uint32_t size, BulkBlockState state) noexcept;
+    };
+
+} // namespace pie_core::ipc
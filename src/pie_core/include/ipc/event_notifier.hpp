@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace pie_core::ipc {
+
+    /**
+     * @brief Cross-process wakeup primitive built on a 32-bit word in shared memory.
+     *
+     * Producers bump the word after publishing work and wake any sleeping consumer.
+     * Consumers sleep on the word in the kernel until it changes (futex on Linux,
+     * os_sync_wait_on_address on macOS), so a wakeup costs one syscall on each side
+     * and no polling interval is involved.
+     *
+     * The notifier does not own the words it operates on; they live in a mapped
+     * control block shared between the producer and consumer processes.
+     */
+    class EventNotifier {
+    public:
+        /**
+         * @param sequence Word bumped once per notification. Consumers wait on it.
+         * @param waiters Number of consumers currently asleep (or about to sleep).
+         *                Lets producers skip the wake syscall when nobody is waiting.
+         */
+        EventNotifier(std::atomic<uint32_t>& sequence, std::atomic<uint32_t>& waiters) noexcept
+            : sequence_(sequence), waiters_(waiters) {}
+
+        /**
+         * @brief Returns the current notification sequence.
+         * A consumer takes a snapshot *before* draining work and hands it to `wait()`,
+         * so notifications that race with the drain are never lost.
+         */
+        [[nodiscard]] uint32_t snapshot() const noexcept {
+            return sequence_.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Publishes a notification and wakes sleeping consumers, if any.
+         * Must be called *after* the work item has been made visible.
+         */
+        void notify() noexcept;
+
+        /**
+         * @brief Blocks until the sequence differs from `observed` or the timeout elapses.
+         * @return True if a notification arrived, false on timeout.
+         */
+        bool wait(uint32_t observed, std::chrono::microseconds timeout) noexcept;
+
+    private:
+        std::atomic<uint32_t>& sequence_;
+        std::atomic<uint32_t>& waiters_;
+    };
+
+} // namespace pie_core::ipc
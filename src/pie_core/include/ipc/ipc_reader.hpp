@@ -6,6 +6,9 @@
 #include "sequence/stop_criteria.hpp"
 #include "sequence/ipc_handles.hpp"
 #include "ipc/ipc_request.hpp"
+#include "ipc/event_notifier.hpp"
+#include "ipc/adaptive_waiter.hpp"
+#include "ipc/spsc_queue.hpp"
 
 #include <string>
 #include <memory>
@@ -14,29 +17,33 @@
 #include <cstddef>
 #include <optional>
 #include <vector>
-
-namespace pie_core::ipc {
-    template<typename T>
-    class SPSCQueue;
-}
+#include <chrono>
 
 namespace pie_core::ipc {
 
     // --- IPCReader Class ---
+    // Drains the request shards round-robin. Each shard gives up at most
+    // MAX_REQUESTS_PER_SHARD per pass, so one busy frontend can't starve the others.
     class IPCReader {
     public:
         using SequenceQueueType = SPSCQueue<std::unique_ptr<sequence::Sequence>>;
 
+        constexpr static size_t MAX_REQUESTS_PER_SHARD = 32;
+
         IPCReader(
             SequenceQueueType& output_queue,
             const std::string& request_shm_name = REQUEST_QUEUE_SHM_NAME,
-            int kernel_event_fd = -1
+            AdaptiveWaitConfig wait_config = {},
+            size_t num_shards = REQUEST_QUEUE_DEFAULT_SHARDS
         );
         ~IPCReader();
 
         void run();
         void stop();
 
+        /** @brief Load block producers read for backpressure; written by the scheduler. */
+        EngineLoad& engine_load() noexcept { return request_segment_header_->load; }
+
         IPCReader(const IPCReader&) = delete;
         IPCReader& operator=(const IPCReader&) = delete;
         IPCReader(IPCReader&&) = delete;
@@ -45,18 +52,28 @@ namespace pie_core::ipc {
     private:
         int request_shm_fd_ = -1;
         void* request_shm_map_ptr_ = nullptr;
-        RequestSlot* request_slots_ = nullptr;
-        RequestQueueControl* request_queue_control_ = nullptr;
+        size_t request_shm_size_ = 0;
+        RequestSegmentHeader* request_segment_header_ = nullptr;
+        std::vector<RequestQueue> request_shards_;
+        size_t next_shard_ = 0; // Where the next drain pass starts
 
-        // For bulk data (e.g., prompts)
+        // For bulk data (prompts, logit biases, stop tokens); see BulkRef and BulkArena.
         // Simplification: Assume one primary bulk SHM segment.
         // If multiple are needed, this needs more complex management.
         int bulk_data_shm_fd_ = -1;
         void* bulk_data_map_ptr_ = nullptr;
-        const char* const BULK_DATA_SHM_NAME = "/pie_bulk_data"; // Example name
-        constexpr static size_t BULK_DATA_SHM_SIZE = 1024 * 1024 * 256; // 256MB example
+        std::optional<BulkArena> bulk_arena_;
+
+        // Wakeups from producers; bound to the doorbell in `request_segment_header_`.
+        std::optional<EventNotifier> notifier_;
+        std::optional<AdaptiveWaiter> waiter_;
+        AdaptiveWaitConfig wait_config_;
+        uint32_t last_notify_seq_ = 0;
+        // Upper bound on a single sleep so `stop()` is honoured even without a wakeup.
+        constexpr static std::chrono::milliseconds MAX_WAIT_INTERVAL{100};
 
-        int kernel_event_fd_;
+        std::string request_shm_name_;
+        size_t num_shards_;
         std::atomic<bool> running_{false};
 
         SequenceQueueType& output_queue_;
@@ -65,8 +82,17 @@ namespace pie_core::ipc {
         void cleanup_ipc_resources();
         bool wait_for_notification();
         void process_incoming_requests();
+        // @return False if the reader was stopped while handing a request over.
+        bool drain_shard(RequestQueue& shard, size_t& drained);
+        // Prompts are borrowed from the bulk segment (see sequence::Prompt), so the
+        // reader must outlive every Sequence it produced. Malformed requests come
+        // back in ERROR status so the scheduler answers them; nullptr only for a
+        // foreign format version, whose response channel can't be trusted.
         std::unique_ptr<sequence::Sequence> build_sequence_from_slot(const RequestSlot& slot);
-        std::vector<int32_t> read_prompt_tokens(uint64_t offset, uint64_t size);
+        // The live block `lease` names, or nullptr if it names none.
+        BulkBlockHeader* resolve_bulk_block(const BulkRef& lease);
+        // Hands back the lease of a request that is dropped before being built.
+        void release_lease(const RequestPayload& request);
     };
 
 } // namespace pie_core::ipc
@@ -1,48 +1,188 @@
 #pragma once
 
-#include "sequence/sequence.hpp"
 #include "sequence/sampling_params.hpp"
 #include "sequence/logits_params.hpp"
-#include "sequence/stop_criteria.hpp"
+#include "sequence/scheduling_params.hpp"
 #include "sequence/ipc_handles.hpp"
+#include "ipc/request_ring.hpp"
+#include "ipc/bulk_arena.hpp"
 
-#include <string>
-#include <memory>
 #include <atomic>
 #include <cstdint>
 #include <cstddef>
 #include <optional>
-#include <vector>
+#include <span>
+#include <type_traits>
 
 namespace pie_core::ipc {
 
     // --- IPC Definitions ---
-    enum class RequestState : uint32_t {
-        FREE = 0,    // Slot is available
-        WRITING = 1, // Python is writing to this slot
-        READY = 2,   // Slot is ready for C++ to read
-        READING = 3  // C++ is reading from this slot
+
+    // Bumped whenever the layout of RequestPayload (or anything it references) changes.
+    constexpr uint32_t REQUEST_FORMAT_VERSION = 6;
+
+    // Bulk segment holding the variable-length parts of requests (prompts, biases, ...).
+    // Laid out and sub-allocated by BulkArena (see ipc/bulk_arena.hpp).
+    const char* const BULK_DATA_SHM_NAME = "/pie_bulk_data";
+    constexpr size_t BULK_DATA_SHM_SIZE = 1024 * 1024 * 256; // 256MB
+
+    /**
+     * @brief Reference to an array of `count` elements at byte `offset` in the bulk segment.
+     * Offsets are relative to the segment base, so they mean the same thing in every process.
+     */
+    struct BulkRef {
+        uint64_t offset{0};
+        uint32_t count{0};
+        uint32_t reserved{0};
     };
 
-    struct alignas(64) RequestSlot {
-        std::atomic<RequestState> state{RequestState::FREE};
+    /**
+     * @brief Fixed-layout request as written by producers.
+     *
+     * Everything here is plain data: no pointers, no owning containers. Arrays are
+     * BulkRefs into the bulk segment and are decoded in place by the engine.
+     *
+     * Referenced element types:
+     *   lease           -> BulkArena block header (count = block size in bytes; 0 = untracked)
+     *   prompt          -> int32_t token ids
+     *   logit_bias      -> sequence::TokenBias
+     *   stop_token_ids  -> int32_t token ids
+     */
+    struct RequestPayload {
+        uint32_t format_version{REQUEST_FORMAT_VERSION};
+        uint32_t flags{0}; // reserved
         uint64_t request_id{0};
-        uint64_t prompt_shm_offset{0};
-        uint64_t prompt_shm_size{0};
+
+        BulkRef lease;
+        BulkRef prompt;
+        BulkRef logit_bias;
+        BulkRef stop_token_ids;
 
         sequence::SamplingParams sampling_params;
-        sequence::LogitsParams logits_params;
-        sequence::StopCriteria stop_criteria;
+
+        // Flattened sequence::LogitsParams scalars.
+        float frequency_penalty{0.0f};
+        float presence_penalty{0.0f};
+        float repetition_penalty{1.0f};
+        int32_t repetition_context_size{60};
+
+        // Flattened sequence::StopCriteria scalars.
+        int32_t max_generated_tokens{1024};
+        sequence::SchedulingParams scheduling_params;
+
         sequence::IPCHandles ipc_handles;
     };
+    static_assert(std::is_trivially_copyable_v<RequestPayload> && std::is_standard_layout_v<RequestPayload>,
+                  "RequestPayload is shared across processes and must be plain data");
+
+    struct alignas(64) RequestSlot {
+        // Ring sequence number; see ipc/request_ring.hpp for the protocol.
+        std::atomic<uint64_t> sequence{0};
+        RequestPayload payload;
+    };
+
+    /**
+     * @brief Resolves a BulkRef against a mapped bulk segment.
+     * @return std::nullopt if the reference is out of bounds or misaligned for T.
+     */
+    template <typename T>
+    std::optional<std::span<const T>> resolve_bulk_ref(const void* bulk_base, size_t bulk_size, const BulkRef& ref) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (ref.count == 0) {
+            return std::span<const T>{};
+        }
+        const uint64_t bytes = static_cast<uint64_t>(ref.count) * sizeof(T);
+        if (ref.offset % alignof(T) != 0 || ref.offset > bulk_size || bytes > bulk_size - ref.offset) {
+            return std::nullopt;
+        }
+        const auto* first = reinterpret_cast<const T*>(static_cast<const char*>(bulk_base) + ref.offset);
+        return std::span<const T>(first, ref.count);
+    }
+
+    enum class AdmissionState : uint32_t {
+        ACCEPTING = 0, // Submit normally
+        REJECTING = 1  // Shed load: don't submit before `retry_after_ms` has passed
+    };
+
+    /**
+     * @brief Live engine load, published by the scheduler once per step.
+     *
+     * Single writer (the scheduler), many readers (producers). Fields are
+     * independent relaxed stores: a reader may see values from two adjacent
+     * steps, which is fine for routing and load-shedding decisions.
+     */
+    struct EngineLoad {
+        std::atomic<AdmissionState> admission{AdmissionState::ACCEPTING};
+        std::atomic<uint32_t> retry_after_ms{0};
+        std::atomic<uint32_t> free_kv_pages{0};
+        std::atomic<uint32_t> total_kv_pages{0};
+        std::atomic<uint32_t> waiting_sequences{0};
+        std::atomic<uint32_t> running_sequences{0};
+        std::atomic<uint64_t> estimated_ttft_us{0};
+        // steady_clock time of the last update; a stale value means the engine is stuck.
+        std::atomic<uint64_t> updated_at_ns{0};
+    };
+
+    // Per-shard ring indices, each on its own cache line so producers and the
+    // engine don't false-share.
+    struct RequestQueueControl {
+        alignas(64) std::atomic<uint64_t> producer_idx{0};
+        alignas(64) std::atomic<uint64_t> consumer_idx{0};
+    };
+    static_assert(sizeof(RequestQueueControl) % 64 == 0,
+                  "slots must start on a fresh cache line");
+
+    /**
+     * @brief Segment-wide state in front of the request shards.
+     *
+     * Every shard is an independent ring with its own control block, so frontend
+     * processes on different shards never touch the same `producer_idx`. They all
+     * ring the one doorbell, since the engine can only sleep on one word.
+     */
+    struct RequestSegmentHeader {
+        alignas(64) uint32_t num_shards{0};
+        // Bit i set: shard i is owned by a producer process (see RequestWriter).
+        std::atomic<uint64_t> shard_claims{0};
+
+        // Wakeup words driven by EventNotifier (see ipc/event_notifier.hpp).
+        // Producers bump `notify_seq` after publishing a slot in any shard.
+        alignas(64) std::atomic<uint32_t> notify_seq{0};
+        std::atomic<uint32_t> notify_waiters{0};
 
+        alignas(64) EngineLoad load;
+    };
+    static_assert(sizeof(RequestSegmentHeader) % 64 == 0,
+                  "shards must start on a fresh cache line");
+
+    // Segment layout:
+    //   [RequestSegmentHeader]
+    //   [RequestQueueControl][RequestSlot x REQUEST_QUEUE_NUM_SLOTS]   x num_shards
     constexpr size_t REQUEST_QUEUE_NUM_SLOTS = 1024;
-    constexpr size_t REQUEST_QUEUE_SHM_SIZE = REQUEST_QUEUE_NUM_SLOTS * sizeof(RequestSlot);
+    constexpr size_t REQUEST_QUEUE_DEFAULT_SHARDS = 8;
+    constexpr size_t REQUEST_QUEUE_MAX_SHARDS = 64; // One claim bit each
+    constexpr size_t REQUEST_SHARD_SIZE =
+        sizeof(RequestQueueControl) + REQUEST_QUEUE_NUM_SLOTS * sizeof(RequestSlot);
     const char* const REQUEST_QUEUE_SHM_NAME = "/pie_request_slots";
+    static_assert((REQUEST_QUEUE_NUM_SLOTS & (REQUEST_QUEUE_NUM_SLOTS - 1)) == 0,
+                  "REQUEST_QUEUE_NUM_SLOTS must be a power of two");
 
-    struct alignas(64) RequestQueueControl {
-        std::atomic<uint64_t> producer_idx{0};
-        std::atomic<uint64_t> consumer_idx{0};
-    };
+    using RequestQueue = RequestRing<RequestSlot, RequestQueueControl>;
+
+    constexpr size_t request_segment_size(size_t num_shards) {
+        return sizeof(RequestSegmentHeader) + num_shards * REQUEST_SHARD_SIZE;
+    }
+
+    inline RequestSegmentHeader* request_segment_header(void* segment_base) {
+        return static_cast<RequestSegmentHeader*>(segment_base);
+    }
+
+    inline RequestQueue request_queue(void* segment_base, size_t shard) {
+        char* shard_base = static_cast<char*>(segment_base) + sizeof(RequestSegmentHeader) + shard * REQUEST_SHARD_SIZE;
+        return RequestQueue(
+            reinterpret_cast<RequestQueueControl*>(shard_base),
+            reinterpret_cast<RequestSlot*>(shard_base + sizeof(RequestQueueControl)),
+            REQUEST_QUEUE_NUM_SLOTS
+        );
+    }
 
 } // namespace pie_core::ipc
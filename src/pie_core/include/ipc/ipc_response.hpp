@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+namespace pie_core::ipc {
+
+    // --- IPC Definitions ---
+
+    // Bumped whenever the layout of ResponseEntry or ResponseChannel changes.
+    constexpr uint32_t RESPONSE_FORMAT_VERSION = 3;
+
+    enum class FinishReason : uint8_t {
+        NONE = 0,      // More entries follow
+        STOP = 1,      // Hit a stop token
+        LENGTH = 2,    // Hit max_generated_tokens
+        CANCELLED = 3, // Cancelled by the client
+        ERROR = 4,     // Engine-side failure; no more output
+        DEADLINE = 5   // Shed before prefill: its first-token deadline could not be met
+    };
+
+    enum ResponseEntryFlags : uint8_t {
+        RESPONSE_HAS_LOGPROB = 1 << 0,
+        // `text` continues in the next entry. Continuation entries carry no token
+        // (token_id == -1); the token is reported on the last entry of the run.
+        RESPONSE_TEXT_CONTINUES = 1 << 1
+    };
+
+    constexpr size_t RESPONSE_TEXT_CAPACITY = 52;
+
+    /**
+     * @brief One streamed output record: a sampled token, its logprob, the text it
+     * decodes to and, on the last record of a request, why generation stopped.
+     * Exactly one cache line, so a push is a single-line memcpy.
+     */
+    struct alignas(64) ResponseEntry {
+        int32_t token_id{-1};
+        float logprob{0.0f};
+        uint8_t flags{0};
+        FinishReason finish_reason{FinishReason::NONE};
+        uint16_t text_len{0};
+        char text[RESPONSE_TEXT_CAPACITY]{};
+    };
+    static_assert(sizeof(ResponseEntry) == 64);
+    static_assert(std::is_trivially_copyable_v<ResponseEntry> && std::is_standard_layout_v<ResponseEntry>,
+                  "ResponseEntry is shared across processes and must be plain data");
+
+    enum class ResponseChannelState : uint32_t {
+        FREE = 0,   // Available to clients
+        CLAIMED = 1 // Owned by one in-flight request
+    };
+
+    constexpr size_t RESPONSE_CHANNEL_CAPACITY = 256;
+    static_assert((RESPONSE_CHANNEL_CAPACITY & (RESPONSE_CHANNEL_CAPACITY - 1)) == 0,
+                  "RESPONSE_CHANNEL_CAPACITY must be a power of two");
+
+    /**
+     * @brief Single-producer/single-consumer ring carrying one request's output.
+     *
+     * The engine is the only writer of `write_idx`; the client that claimed the
+     * channel is the only writer of `read_idx`. Both indices are monotonic, so the
+     * ring needs no per-entry flags and no CAS: publishing is one release store.
+     *
+     * `cancel` is the request's cancel word: the client sets it (e.g. when its
+     * caller disconnects) and the scheduler, which polls it every step, retires
+     * the request and finishes the channel with CANCELLED. Cleared on claim.
+     */
+    struct ResponseChannel {
+        alignas(64) std::atomic<uint64_t> write_idx{0};
+        alignas(64) std::atomic<uint64_t> read_idx{0};
+        alignas(64) std::atomic<ResponseChannelState> state{ResponseChannelState::FREE};
+        std::atomic<uint32_t> cancel{0};
+        ResponseEntry entries[RESPONSE_CHANNEL_CAPACITY];
+
+        /** @brief Engine side: entries that can be pushed without overwriting unread ones. */
+        [[nodiscard]] size_t free_entries() const noexcept {
+            const uint64_t head = write_idx.load(std::memory_order_relaxed);
+            return RESPONSE_CHANNEL_CAPACITY - static_cast<size_t>(head - read_idx.load(std::memory_order_acquire));
+        }
+
+        /** @brief Engine side. Copies `count` entries in and publishes them at once. */
+        bool try_push(const ResponseEntry* items, size_t count) noexcept {
+            if (count > free_entries()) {
+                return false;
+            }
+            const uint64_t head = write_idx.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < count; ++i) {
+                entries[(head + i) & (RESPONSE_CHANNEL_CAPACITY - 1)] = items[i];
+            }
+            write_idx.store(head + count, std::memory_order_release);
+            return true;
+        }
+
+        /** @brief Client side. Copies up to `max` entries out. @return Entries read. */
+        size_t pop(ResponseEntry* out, size_t max) noexcept {
+            const uint64_t tail = read_idx.load(std::memory_order_relaxed);
+            const uint64_t head = write_idx.load(std::memory_order_acquire);
+            const size_t count = std::min(static_cast<size_t>(head - tail), max);
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = entries[(tail + i) & (RESPONSE_CHANNEL_CAPACITY - 1)];
+            }
+            read_idx.store(tail + count, std::memory_order_release);
+            return count;
+        }
+    };
+
+    // All channels share one wakeup word: the engine bumps it once per scheduler
+    // step, after every sequence's output for that step has been published.
+    struct ResponseControl {
+        alignas(64) uint32_t format_version{RESPONSE_FORMAT_VERSION};
+        // Wakeup words driven by EventNotifier (see ipc/event_notifier.hpp).
+        alignas(64) std::atomic<uint32_t> notify_seq{0};
+        std::atomic<uint32_t> notify_waiters{0};
+        // Where the next claim starts scanning; spreads clients across channels.
+        alignas(64) std::atomic<uint32_t> claim_hint{0};
+    };
+    static_assert(sizeof(ResponseControl) % 64 == 0,
+                  "channels must start on a fresh cache line");
+
+    // Segment layout: [ResponseControl][ResponseChannel x RESPONSE_NUM_CHANNELS]
+    constexpr size_t RESPONSE_NUM_CHANNELS = 256;
+    constexpr size_t RESPONSE_CHANNELS_OFFSET = sizeof(ResponseControl);
+    constexpr size_t RESPONSE_SHM_SIZE =
+        RESPONSE_CHANNELS_OFFSET + RESPONSE_NUM_CHANNELS * sizeof(ResponseChannel);
+    const char* const RESPONSE_SHM_NAME = "/pie_response_channels";
+
+    inline ResponseControl* response_control(void* segment_base) {
+        return static_cast<ResponseControl*>(segment_base);
+    }
+
+    inline ResponseChannel* response_channels(void* segment_base) {
+        return reinterpret_cast<ResponseChannel*>(
+            static_cast<char*>(segment_base) + RESPONSE_CHANNELS_OFFSET);
+    }
+
+} // namespace pie_core::ipc
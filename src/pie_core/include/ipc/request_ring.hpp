@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+namespace pie_core::ipc {
+
+    /**
+     * @brief Bounded MPMC ring (Vyukov) over a caller-owned slot array.
+     *
+     * The ring is a *view*: the slots and the control block live in shared memory
+     * mapped by both the engine and the producers. Each slot carries a sequence
+     * number that encodes its state relative to the ring indices:
+     *
+     *   sequence == pos             -> free, a producer may claim position `pos`
+     *   sequence == pos + 1         -> published, a consumer may read position `pos`
+     *   sequence == pos + capacity  -> released, free again for the next lap
+     *
+     * Producers claim a position with one CAS on `producer_idx`; consumers claim a
+     * contiguous run of published positions with one CAS on `consumer_idx`. Intake
+     * is therefore O(requests) rather than O(slots), and requests are consumed in
+     * strict claim order.
+     *
+     * @tparam Slot    Slot type with a `std::atomic<uint64_t> sequence` member.
+     * @tparam Control Control block with `std::atomic<uint64_t>` members
+     *                 `producer_idx` and `consumer_idx`, ideally on separate cache lines.
+     */
+    template <typename Slot, typename Control>
+    class RequestRing {
+    public:
+        RequestRing(Control* control, Slot* slots, size_t capacity)
+            : control_(control), slots_(slots), capacity_(capacity), mask_(capacity - 1)
+        {
+            if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+                throw std::invalid_argument("RequestRing capacity must be a non-zero power of two.");
+            }
+        }
+
+        /**
+         * @brief Resets indices and slot sequences. Engine side only, before any
+         * producer attaches.
+         */
+        void initialize() noexcept {
+            for (size_t i = 0; i < capacity_; ++i) {
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            control_->producer_idx.store(0, std::memory_order_relaxed);
+            control_->consumer_idx.store(0, std::memory_order_release);
+        }
+
+        // --- Producer Side ---
+
+        /**
+         * @brief Claims the next write position.
+         * @param[out] pos The claimed ring position, to be passed to `publish()`.
+         * @return The slot to fill, or nullptr if the ring is full.
+         */
+        Slot* try_claim(uint64_t& pos) noexcept {
+            uint64_t current = control_->producer_idx.load(std::memory_order_relaxed);
+            for (;;) {
+                Slot& slot = slots_[current & mask_];
+                const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<int64_t>(sequence - current);
+                if (diff == 0) {
+                    if (control_->producer_idx.compare_exchange_weak(
+                            current, current + 1, std::memory_order_relaxed)) {
+                        pos = current;
+                        return &slot;
+                    }
+                } else if (diff < 0) {
+                    return nullptr; // Consumer hasn't released this slot yet: full.
+                } else {
+                    current = control_->producer_idx.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /** @brief Makes a filled slot visible to consumers. */
+        void publish(uint64_t pos) noexcept {
+            slots_[pos & mask_].sequence.store(pos + 1, std::memory_order_release);
+        }
+
+        // --- Consumer Side ---
+
+        /**
+         * @brief Claims up to `max_count` contiguous published positions in one CAS.
+         * @param[out] first The first claimed position.
+         * @return Number of claimed positions (0 if nothing is ready).
+         */
+        size_t try_claim_range(uint64_t& first, size_t max_count) noexcept {
+            uint64_t current = control_->consumer_idx.load(std::memory_order_relaxed);
+            for (;;) {
+                size_t count = 0;
+                bool lagging = false;
+                while (count < max_count) {
+                    const uint64_t pos = current + count;
+                    const uint64_t sequence = slots_[pos & mask_].sequence.load(std::memory_order_acquire);
+                    const auto diff = static_cast<int64_t>(sequence - (pos + 1));
+                    if (diff != 0) {
+                        // diff > 0: another consumer already took `pos`.
+                        lagging = diff > 0 && count == 0;
+                        break;
+                    }
+                    ++count;
+                }
+                if (count == 0) {
+                    if (!lagging) {
+                        return 0;
+                    }
+                    current = control_->consumer_idx.load(std::memory_order_relaxed);
+                    continue;
+                }
+                if (control_->consumer_idx.compare_exchange_weak(
+                        current, current + count, std::memory_order_relaxed)) {
+                    first = current;
+                    return count;
+                }
+            }
+        }
+
+        /** @brief Slot at a claimed position. */
+        [[nodiscard]] Slot& at(uint64_t pos) noexcept { return slots_[pos & mask_]; }
+
+        /** @brief Hands a consumed slot back to producers for the next lap. */
+        void release(uint64_t pos) noexcept {
+            slots_[pos & mask_].sequence.store(pos + capacity_, std::memory_order_release);
+        }
+
+        // --- Introspection ---
+
+        /** @brief Claimed-but-unconsumed positions. Approximate under concurrency. */
+        [[nodiscard]] size_t size_approx() const noexcept {
+            const uint64_t produced = control_->producer_idx.load(std::memory_order_relaxed);
+            const uint64_t consumed = control_->consumer_idx.load(std::memory_order_relaxed);
+            return produced > consumed ? static_cast<size_t>(produced - consumed) : 0;
+        }
+
+        [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+
+    private:
+        Control* control_;
+        Slot* slots_;
+        size_t capacity_;
+        size_t mask_;
+    };
+
+} // namespace pie_core::ipc
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "ipc/ipc_request.hpp"
+#include "ipc/bulk_arena.hpp"
+#include "ipc/event_notifier.hpp"
+#include "sequence/logits_params.hpp"
+
+#include <string>
+#include <optional>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+namespace pie_core::ipc {
+
+    enum class SubmitStatus {
+        ACCEPTED,    // Published; the engine has been signalled
+        QUEUE_FULL,  // No free request slot
+        BULK_FULL,   // Not enough reclaimable space in the bulk arena
+        REJECTED     // Engine is shedding load; retry after LoadSnapshot::retry_after_ms
+    };
+
+    /** @brief Point-in-time copy of the engine's published load (see EngineLoad). */
+    struct LoadSnapshot {
+        AdmissionState admission = AdmissionState::ACCEPTING;
+        uint32_t retry_after_ms = 0;
+        uint32_t free_request_slots = 0;
+        uint32_t free_kv_pages = 0;
+        uint32_t total_kv_pages = 0;
+        uint32_t waiting_sequences = 0;
+        uint32_t running_sequences = 0;
+        uint64_t estimated_ttft_us = 0;
+        uint64_t age_us = 0; // Time since the engine last published
+    };
+
+    /**
+     * @brief Producer side of the request queue.
+     *
+     * Maps the request and bulk segments created by the engine process. Request
+     * arrays are placed in a BulkArena block, the fixed-size payload goes into the
+     * request ring, and the engine is signalled as soon as the slot is published.
+     * Exposed to Python through the `pie_core` extension module.
+     *
+     * Each writer claims a request shard of its own, so frontend processes don't
+     * contend on one ring. Writers within a process should share one instance
+     * (submit() is thread-safe).
+     */
+    class RequestWriter {
+    public:
+        explicit RequestWriter(
+            const std::string& request_shm_name = REQUEST_QUEUE_SHM_NAME,
+            const std::string& bulk_shm_name = BULK_DATA_SHM_NAME,
+            std::optional<uint32_t> shard = std::nullopt // Claim a free one
+        );
+        ~RequestWriter();
+
+        /**
+         * @brief Copies the arrays into one bulk block, fills in the payload's
+         * BulkRefs (lease, prompt, logit_bias, stop_token_ids), publishes it and
+         * wakes the engine. The block is handed back by the engine once the prompt
+         * has been consumed and is reclaimed by later submissions.
+         *
+         * Nothing is written while the engine reports REJECTING, so a frontend can
+         * route the request to another replica instead of queueing behind a stall.
+         */
+        SubmitStatus submit(
+            RequestPayload payload,
+            std::span<const int32_t> prompt,
+            std::span<const sequence::TokenBias> logit_bias = {},
+            std::span<const int32_t> stop_token_ids = {}
+        );
+
+        /** @brief Current engine load, for routing and load shedding. */
+        [[nodiscard]] LoadSnapshot load() const noexcept;
+
+        [[nodiscard]] uint32_t shard() const noexcept { return shard_; }
+
+        /** @brief Bytes of the bulk arena currently held by in-flight requests. */
+        [[nodiscard]] size_t bulk_bytes_in_use() const noexcept { return bulk_arena_->used_bytes(); }
+
+        RequestWriter(const RequestWriter&) = delete;
+        RequestWriter& operator=(const RequestWriter&) = delete;
+        RequestWriter(RequestWriter&&) = delete;
+        RequestWriter& operator=(RequestWriter&&) = delete;
+
+    private:
+        int request_shm_fd_ = -1;
+        void* request_shm_map_ptr_ = nullptr;
+        size_t request_shm_size_ = 0;
+        int bulk_data_shm_fd_ = -1;
+        void* bulk_data_map_ptr_ = nullptr;
+
+        RequestSegmentHeader* header_ = nullptr;
+        uint32_t shard_ = 0;
+        bool owns_shard_ = false; // Claimed exclusively; released on destruction
+        std::optional<RequestQueue> request_queue_;
+        std::optional<BulkArena> bulk_arena_;
+        std::optional<EventNotifier> notifier_;
+
+        uint32_t claim_shard(uint32_t num_shards);
+        void cleanup();
+    };
+
+} // namespace pie_core::ipc
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ipc/ipc_response.hpp"
+#include "ipc/event_notifier.hpp"
+
+#include <string>
+#include <optional>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace pie_core::ipc {
+
+    /**
+     * @brief Client side of the response channels.
+     *
+     * Attaches to the segment created by the engine. A client claims a channel
+     * before submitting a request, passes its id as IPCHandles::response_channel_id
+     * and releases it after reading the entry that carries a FinishReason.
+     *
+     * One reader serves every request of a process: take a `snapshot()`, drain
+     * the claimed channels, then `wait()`. The engine notifies once per step, so
+     * the reader wakes at most once per step regardless of how many streams it has.
+     * Exposed to Python through the `pie_core` extension module.
+     */
+    class ResponseReader {
+    public:
+        explicit ResponseReader(const std::string& response_shm_name = RESPONSE_SHM_NAME);
+        ~ResponseReader();
+
+        /** @brief Claims a free channel. @return Its id, or std::nullopt if all are in use. */
+        std::optional<uint64_t> claim_channel();
+
+        /** @brief Returns a channel. Only after its final entry has been read. */
+        void release_channel(uint64_t channel_id);
+
+        /**
+         * @brief Asks the engine to stop the channel's request. Keep reading: the
+         * channel still ends with a final entry (CANCELLED, or however the
+         * request finished if it got there first).
+         */
+        void cancel(uint64_t channel_id);
+
+        /** @brief Copies up to `max` pending entries out of a claimed channel. */
+        size_t read(uint64_t channel_id, ResponseEntry* out, size_t max);
+
+        [[nodiscard]] uint32_t snapshot() const noexcept { return notifier_->snapshot(); }
+        bool wait(uint32_t observed, std::chrono::microseconds timeout) noexcept {
+            return notifier_->wait(observed, timeout);
+        }
+
+        ResponseReader(const ResponseReader&) = delete;
+        ResponseReader& operator=(const ResponseReader&) = delete;
+        ResponseReader(ResponseReader&&) = delete;
+        ResponseReader& operator=(ResponseReader&&) = delete;
+
+    private:
+        int response_shm_fd_ = -1;
+        void* response_shm_map_ptr_ = nullptr;
+        ResponseControl* control_ = nullptr;
+        ResponseChannel* channels_ = nullptr;
+        std::optional<EventNotifier> notifier_;
+
+        ResponseChannel& channel(uint64_t channel_id);
+        void cleanup();
+    };
+
+} // namespace pie_core::ipc
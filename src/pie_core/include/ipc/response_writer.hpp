@@ -0,0 +1,97 @@
+#pragma once
+
+#include "ipc/ipc_response.hpp"
+#include "ipc/event_notifier.hpp"
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include <cstddef>
+
+namespace pie_core::ipc {
+
+    /**
+     * @brief Engine side of the response channels.
+     *
+     * Creates the response segment and streams per-request output into the
+     * channel named by each request's IPCHandles::response_channel_id. Entries are
+     * visible to the client as soon as they are emitted, but the client is only
+     * woken by `flush()`, which the scheduler calls once per step: a step that
+     * produces a token for every running sequence costs a single wakeup.
+     *
+     * A channel whose client is behind doesn't stall the engine; its entries are
+     * kept in an in-process backlog and moved over on later flushes, in order.
+     * The backlog is bounded: a client that stops reading has its stream ended
+     * with FinishReason::ERROR and its request cancelled through the channel's
+     * cancel word, and later output for that request is dropped. Output for a
+     * channel its client has released is dropped too.
+     */
+    class ResponseWriter {
+    public:
+        explicit ResponseWriter(const std::string& response_shm_name = RESPONSE_SHM_NAME);
+        ~ResponseWriter();
+
+        /**
+         * @brief Queues one token's output. `text` longer than one entry is split
+         * across continuation entries, which always reach the client together.
+         * @return False if `channel_id` is out of range.
+         */
+        bool emit(
+            uint64_t channel_id,
+            int32_t token_id,
+            std::optional<float> logprob,
+            std::string_view text,
+            FinishReason finish_reason = FinishReason::NONE
+        );
+
+        /** @brief Closes a channel without a token (errors, cancellation). */
+        bool finish(uint64_t channel_id, FinishReason finish_reason);
+
+        /**
+         * @brief The cancel word of `channel_id` (see ResponseChannel), or
+         * nullptr if it is out of range.
+         */
+        [[nodiscard]] const std::atomic<uint32_t>* cancel_word(uint64_t channel_id) const noexcept;
+
+        /** @brief Moves backlogged entries over and wakes clients if anything was published. */
+        void flush();
+
+        /** @brief Entries waiting for slow clients. */
+        [[nodiscard]] size_t backlog_size() const noexcept { return backlog_entries_; }
+
+        ResponseWriter(const ResponseWriter&) = delete;
+        ResponseWriter& operator=(const ResponseWriter&) = delete;
+        ResponseWriter(ResponseWriter&&) = delete;
+        ResponseWriter& operator=(ResponseWriter&&) = delete;
+
+        static constexpr size_t MAX_BACKLOG_ENTRIES = 4 * RESPONSE_CHANNEL_CAPACITY; // Per channel
+
+    private:
+        static constexpr size_t MAX_TEXT_ENTRIES = 16;
+
+        int response_shm_fd_ = -1;
+        void* response_shm_map_ptr_ = nullptr;
+        ResponseChannel* channels_ = nullptr;
+        std::optional<EventNotifier> notifier_;
+        std::string response_shm_name_;
+
+        std::unordered_map<uint64_t, std::deque<ResponseEntry>> backlog_;
+        size_t backlog_entries_ = 0;
+        // Channels whose stream was ended for overflowing; dropped until the
+        // engine's own final entry for the request.
+        std::unordered_set<uint64_t> abandoned_;
+        bool published_since_flush_ = false;
+        std::vector<ResponseEntry> scratch_;
+
+        void publish(uint64_t channel_id, const ResponseEntry* entries, size_t count);
+        void abandon(uint64_t channel_id, std::deque<ResponseEntry>& pending);
+        void cleanup();
+    };
+
+} // namespace pie_core::ipc
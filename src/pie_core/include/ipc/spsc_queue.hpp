@@ -0,0 +1,205 @@
+#pragma once
+
+#include "ipc/event_notifier.hpp"
+#include "ipc/adaptive_waiter.hpp"
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace pie_core::ipc {
+
+    /**
+     * @brief Bounded single-producer/single-consumer queue for in-process hand-off.
+     *
+     * Used between the IPCReader thread (producer) and the scheduler thread
+     * (consumer). Each side owns one index and keeps a private, cached copy of the
+     * other side's index on its own cache line: it only reloads the shared index
+     * when the cached one says the queue looks full (producer) or empty (consumer).
+     * In steady state a push or pop touches no cache line written by the other
+     * thread except the slot itself.
+     *
+     * `push_batch`/`pop_batch` move many items with a single index publication, so
+     * the scheduler drains every new sequence with one pop per step.
+     *
+     * An optional blocking `wait_for_data()` spins briefly, then sleeps on a futex
+     * word that producers only signal when the consumer is actually asleep (see
+     * AdaptiveWaiter and EventNotifier). `wait_for_space()` is its mirror for a
+     * producer facing a full queue, woken by the consumer's pops.
+     */
+    template <typename T>
+    class SPSCQueue {
+        static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+                      "SPSCQueue moves items in and out of its slots");
+        static_assert(std::is_default_constructible_v<T>);
+
+    public:
+        /** @param capacity Rounded up to a power of two. */
+        explicit SPSCQueue(size_t capacity, AdaptiveWaitConfig wait_config = {})
+            : capacity_(std::bit_ceil(std::max<size_t>(capacity, 2))),
+              mask_(capacity_ - 1),
+              slots_(std::make_unique<T[]>(capacity_)),
+              notifier_(notify_seq_, notify_waiters_),
+              waiter_(notifier_, wait_config),
+              space_notifier_(space_seq_, space_waiters_),
+              space_waiter_(space_notifier_, wait_config)
+        {}
+
+        // --- Producer ---
+
+        bool try_push(T&& value) noexcept {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - cached_head_ == capacity_) {
+                cached_head_ = head_.load(std::memory_order_acquire);
+                if (tail - cached_head_ == capacity_) {
+                    return false;
+                }
+            }
+            slots_[tail & mask_] = std::move(value);
+            tail_.store(tail + 1, std::memory_order_release);
+            notifier_.notify();
+            return true;
+        }
+
+        /**
+         * @brief Moves as many of `[first, first + count)` in as fit.
+         * @return Number of items moved (a prefix of the input).
+         */
+        size_t push_batch(T* first, size_t count) noexcept {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            size_t free_slots = capacity_ - (tail - cached_head_);
+            if (free_slots < count) {
+                cached_head_ = head_.load(std::memory_order_acquire);
+                free_slots = capacity_ - (tail - cached_head_);
+            }
+            const size_t n = std::min(free_slots, count);
+            for (size_t i = 0; i < n; ++i) {
+                slots_[(tail + i) & mask_] = std::move(first[i]);
+            }
+            if (n > 0) {
+                tail_.store(tail + n, std::memory_order_release);
+                notifier_.notify();
+            }
+            return n;
+        }
+
+        /**
+         * @brief Blocks until the queue has a free slot or the timeout elapses.
+         * Producer side only.
+         * @return True if there is room.
+         */
+        bool wait_for_space(std::chrono::microseconds timeout) noexcept {
+            const uint32_t observed = space_notifier_.snapshot();
+            if (!full()) {
+                return true;
+            }
+            space_waiter_.wait(observed, timeout);
+            return !full();
+        }
+
+        /** @brief Wakes a producer blocked in `wait_for_space()` (e.g. for shutdown). */
+        void wake_producer() noexcept { space_notifier_.notify(); }
+
+        // --- Consumer ---
+
+        std::optional<T> try_pop() noexcept {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            if (head == cached_tail_) {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if (head == cached_tail_) {
+                    return std::nullopt;
+                }
+            }
+            std::optional<T> value(std::move(slots_[head & mask_]));
+            head_.store(head + 1, std::memory_order_release);
+            space_notifier_.notify();
+            return value;
+        }
+
+        /**
+         * @brief Moves up to `max` items out through `out` (an output iterator,
+         * e.g. std::back_inserter) and frees their slots in one publication.
+         * @return Number of items popped.
+         */
+        template <typename OutputIt>
+        size_t pop_batch(OutputIt out, size_t max = SIZE_MAX) {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            // Always refresh: a batch pop wants everything published so far.
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            const size_t n = std::min(cached_tail_ - head, max);
+            for (size_t i = 0; i < n; ++i) {
+                *out++ = std::move(slots_[(head + i) & mask_]);
+            }
+            if (n > 0) {
+                head_.store(head + n, std::memory_order_release);
+                space_notifier_.notify();
+            }
+            return n;
+        }
+
+        /**
+         * @brief Blocks until the queue is non-empty or the timeout elapses.
+         * Consumer side only.
+         * @return True if data is available.
+         */
+        bool wait_for_data(std::chrono::microseconds timeout) noexcept {
+            const uint32_t observed = notifier_.snapshot();
+            if (!empty()) {
+                return true;
+            }
+            waiter_.wait(observed, timeout);
+            return !empty();
+        }
+
+        /** @brief Wakes a consumer blocked in `wait_for_data()` (e.g. for shutdown). */
+        void wake() noexcept { notifier_.notify(); }
+
+        // --- Either side (approximate while the other side is active) ---
+
+        [[nodiscard]] bool empty() const noexcept {
+            return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+        }
+        [[nodiscard]] size_t size_approx() const noexcept {
+            return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+        }
+        [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+        [[nodiscard]] bool full() const noexcept { return size_approx() >= capacity_; }
+
+        SPSCQueue(const SPSCQueue&) = delete;
+        SPSCQueue& operator=(const SPSCQueue&) = delete;
+        SPSCQueue(SPSCQueue&&) = delete;
+        SPSCQueue& operator=(SPSCQueue&&) = delete;
+
+    private:
+        const size_t capacity_;
+        const size_t mask_;
+        std::unique_ptr<T[]> slots_;
+
+        // Consumer line: its index and its cached view of the producer's.
+        alignas(64) std::atomic<size_t> head_{0};
+        size_t cached_tail_{0};
+
+        // Producer line.
+        alignas(64) std::atomic<size_t> tail_{0};
+        size_t cached_head_{0};
+
+        alignas(64) std::atomic<uint32_t> notify_seq_{0};
+        std::atomic<uint32_t> notify_waiters_{0};
+        EventNotifier notifier_;
+        AdaptiveWaiter waiter_; // Consumer-owned
+
+        // Pops signal a producer waiting for room.
+        alignas(64) std::atomic<uint32_t> space_seq_{0};
+        std::atomic<uint32_t> space_waiters_{0};
+        EventNotifier space_notifier_;
+        AdaptiveWaiter space_waiter_; // Producer-owned
+    };
+
+} // namespace pie_core::ipc
@@ -2,15 +2,22 @@
 
 #include <cstdint>
 #include <mlx/mlx.h>
-#include <unordered_map>
+#include <vector>
 
 namespace mx = mlx::core;
 
 namespace pie_core::sequence {
 
+    // Additive bias for one token id. Also the element type of the shared-memory
+    // logit-bias array (see ipc/ipc_request.hpp), so decoding is a plain copy.
+    struct TokenBias {
+        int32_t token_id;
+        float bias;
+    };
+
     struct LogitsParams {
         float frequency_penalty = 0.0f;
-        std::unordered_map<int32_t, float> logit_bias;
+        std::vector<TokenBias> logit_bias;
         float presence_penalty = 0.0f;
         int repetition_context_size = 60;
         float repetition_penalty = 1.0f;
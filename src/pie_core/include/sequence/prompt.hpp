@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace pie_core::sequence {
+
+    /**
+     * @brief Read-only prompt tokens, either borrowed in place or owned.
+     *
+     * Prompts arriving over IPC are *borrowed*: the span points straight into the
+     * bulk shared-memory segment and `release_fn` hands the region back to the
+     * producer once the engine no longer reads it. Prompts built in-process are
+     * *owned* and simply live in `owned_`.
+     *
+     * The lease is returned exactly once: on `release()` or on destruction,
+     * whichever comes first. After that `tokens()` is empty.
+     */
+    class Prompt {
+    public:
+        using ReleaseFn = std::function<void()>;
+
+        Prompt() = default;
+
+        // Borrowed prompt: `tokens` must stay valid until `release_fn` runs.
+        Prompt(std::span<const int32_t> tokens, ReleaseFn release_fn)
+            : tokens_(tokens), release_fn_(std::move(release_fn)) {}
+
+        // Owned prompt.
+        explicit Prompt(std::vector<int32_t> tokens)
+            : owned_(std::move(tokens)), tokens_(owned_) {}
+
+        ~Prompt() { release(); }
+
+        Prompt(Prompt&& other) noexcept
+            : owned_(std::move(other.owned_)),
+              tokens_(other.tokens_),
+              release_fn_(std::move(other.release_fn_))
+        {
+            // Moving a vector keeps its buffer, so an owned span stays valid.
+            other.tokens_ = {};
+            other.release_fn_ = nullptr;
+        }
+
+        Prompt& operator=(Prompt&& other) noexcept {
+            if (this != &other) {
+                release();
+                owned_ = std::move(other.owned_);
+                tokens_ = other.tokens_;
+                release_fn_ = std::move(other.release_fn_);
+                other.tokens_ = {};
+                other.release_fn_ = nullptr;
+            }
+            return *this;
+        }
+
+        Prompt(const Prompt&) = delete;
+        Prompt& operator=(const Prompt&) = delete;
+
+        [[nodiscard]] std::span<const int32_t> tokens() const noexcept { return tokens_; }
+        [[nodiscard]] size_t size() const noexcept { return tokens_.size(); }
+        [[nodiscard]] bool is_borrowed() const noexcept { return static_cast<bool>(release_fn_); }
+
+        /** @brief Returns the lease (if any) and drops the tokens. Idempotent. */
+        void release() {
+            tokens_ = {};
+            owned_.clear();
+            owned_.shrink_to_fit();
+            if (release_fn_) {
+                ReleaseFn release_fn = std::move(release_fn_);
+                release_fn_ = nullptr;
+                release_fn();
+            }
+        }
+
+    private:
+        std::vector<int32_t> owned_;
+        std::span<const int32_t> tokens_;
+        ReleaseFn release_fn_;
+    };
+
+} // namespace pie_core::sequence
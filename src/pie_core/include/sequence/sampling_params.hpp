@@ -9,7 +9,7 @@ namespace pie_core::sequence {
         float top_p = 1.0f;
         int top_k = -1;
         float min_p = 0.0f;
-        uint32_t rng_seed;
+        uint32_t rng_seed = 0;
     };
 
 } // namespace pie_core
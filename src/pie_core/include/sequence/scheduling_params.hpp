@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+namespace pie_core::sequence {
+
+    // Lower values are served first.
+    enum class Priority : uint8_t {
+        INTERACTIVE = 0, // Latency-sensitive (chat); may preempt batch prefills
+        STANDARD = 1,
+        BATCH = 2        // Throughput work; runs on whatever interactive traffic leaves
+    };
+
+    struct SchedulingParams {
+        Priority priority = Priority::STANDARD;
+        uint32_t ttft_deadline_ms = 0; // First token due this long after arrival; 0 = no deadline
+        uint32_t tenant_id = 0;        // Fair-share group (see engine::FairShare)
+    };
+
+} // namespace pie_core
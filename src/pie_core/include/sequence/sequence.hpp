@@ -12,7 +12,9 @@
 #include "sequence/sampling_params.hpp"
 #include "sequence/logits_params.hpp"
 #include "sequence/stop_criteria.hpp"
+#include "sequence/scheduling_params.hpp"
 #include "sequence/ipc_handles.hpp"
+#include "sequence/prompt.hpp"
 
 namespace mx = mlx::core;
 
@@ -31,16 +33,18 @@ namespace pie_core::sequence {
     class Sequence {
         public:
 
+            // Containers are taken by value and moved in, so callers that build
+            // them for this sequence pay for exactly one allocation each.
             Sequence(
                 uint64_t sequence_id,
                 SequenceStatus status,
                 uint64_t arrival_timestamp_ns,
-                const std::vector<int32_t>& tokens,
-                size_t prompt_len,
+                Prompt prompt,
                 const SamplingParams& sampling_params,
-                const LogitsParams& logits_params,
-                const StopCriteria& stop_criteria,
-                const IPCHandles& ipc_handles
+                LogitsParams logits_params,
+                StopCriteria stop_criteria,
+                const IPCHandles& ipc_handles,
+                const SchedulingParams& scheduling_params = {}
             );
 
             const uint64_t sequence_id;
@@ -48,13 +52,18 @@ namespace pie_core::sequence {
             const uint64_t arrival_timestamp_ns;
 
             // --- Token & KV Cache State ---
-            std::vector<int32_t> tokens;      // MUTABLE (prompt + generated)
+            // Logical token stream = prompt tokens followed by generated tokens.
+            // The prompt is usually borrowed from shared memory (see Prompt).
+            Prompt prompt;
             const size_t prompt_len;
+            std::vector<int32_t> generated_tokens; // MUTABLE
             std::vector<uint32_t> page_table;
 
             const SamplingParams sampling_params; // Immutable for this sequence
             const LogitsParams logits_params;     // Immutable for this sequence
-            const StopCriteria stop_criteria;     // Immutable for this sequence
+            StopCriteria stop_criteria;           // Changed only by cap_generation()
+            const SchedulingParams scheduling_params;
+            const uint64_t deadline_ns;           // First-token deadline (steady clock); 0 = none
 
             // --- Communication Handles ---
             const IPCHandles ipc_handles;
@@ -65,7 +74,22 @@ namespace pie_core::sequence {
             [[nodiscard]] size_t get_generation_len() const;
             [[nodiscard]] size_t get_logical_len() const;
             [[nodiscard]] bool is_finished() const;
-            void append_token(int32_t token_id); // Non-const, modifies tokens
+            // Both throw std::out_of_range for tokens released by release_prompt()
+            // or past the logical length.
+            [[nodiscard]] int32_t token_at(size_t logical_index) const;
+            [[nodiscard]] int32_t last_token() const;
+            // Copies logical tokens [start, start + count) into `out` without any
+            // intermediate buffer. Prompt tokens are read in place.
+            void copy_tokens(size_t start, size_t count, int32_t* out) const;
+            // Drops the prompt prefix once its KV entries are cached, returning a
+            // borrowed prompt's shared memory early. Keeps the last `keep_tail`
+            // tokens (at least one) for repetition penalties. Prompt indices below
+            // `released_prompt_prefix()` must not be read afterwards.
+            void release_prompt(size_t keep_tail);
+            [[nodiscard]] size_t released_prompt_prefix() const { return released_prompt_prefix_; }
+            // Lowers the generation limit to `max_generated_tokens` if it is above it.
+            void cap_generation(size_t max_generated_tokens);
+            void append_token(int32_t token_id); // Non-const, modifies generated_tokens
             void append_page(uint32_t page_id); // Non-const, modifies page_table
             [[nodiscard]] std::optional<uint32_t> get_physical_page(size_t logical_block_index) const;
 
@@ -76,6 +100,9 @@ namespace pie_core::sequence {
             Sequence& operator=(Sequence&&) = default;
 
         private:
+            size_t released_prompt_prefix_ = 0; // Prompt tokens dropped by release_prompt()
+
+            void check_readable(size_t start, size_t end) const;
     };
 
 } // namespace pie_core
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pie_core::server {
+
+    /**
+     * @brief Token id -> bytes table loaded from a Hugging Face `tokenizer.json`.
+     *
+     * Decode only: the native front end accepts prompts as token ids, so only the
+     * generated side needs text. Handles the two vocabularies our models use:
+     * byte-level BPE (GPT-2 style byte-to-unicode pieces) and SentencePiece
+     * pieces (`▁` for spaces, `<0xNN>` byte fallback). Every piece is converted
+     * to raw bytes once at load time.
+     */
+    class Detokenizer {
+    public:
+        explicit Detokenizer(const std::string& tokenizer_json_path);
+
+        /** @brief Raw bytes of a token; empty for special and unknown ids. */
+        [[nodiscard]] std::string_view token_bytes(int32_t token_id) const noexcept {
+            if (token_id < 0 || static_cast<size_t>(token_id) >= pieces_.size()) {
+                return {};
+            }
+            return pieces_[static_cast<size_t>(token_id)];
+        }
+
+        [[nodiscard]] size_t vocab_size() const noexcept { return pieces_.size(); }
+
+    private:
+        std::vector<std::string> pieces_;
+    };
+
+    /**
+     * @brief Per-request incremental decoder.
+     *
+     * A multi-byte character can be split across tokens; bytes are held back
+     * until the character is complete, so every chunk handed out is valid UTF-8.
+     */
+    class StreamDecoder {
+    public:
+        explicit StreamDecoder(const Detokenizer& detokenizer) noexcept : detokenizer_(&detokenizer) {}
+
+        /** @brief Appends the text completed by `token_id` to `out`. */
+        void append(int32_t token_id, std::string& out);
+
+        /** @brief Flushes held-back bytes at the end of the stream (invalid ones as U+FFFD). */
+        void finish(std::string& out);
+
+    private:
+        const Detokenizer* detokenizer_;
+        std::string pending_;
+    };
+
+    /** @brief EOS ids from a model directory's generation_config.json / config.json. */
+    std::vector<int32_t> read_eos_token_ids(const std::string& model_path);
+
+} // namespace pie_core::server
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ipc/ipc_request.hpp"
+#include "sequence/logits_params.hpp"
+
+namespace pie_core::server {
+
+    /**
+     * @brief A completion request decoded from its JSON body, ready to submit.
+     *
+     * `payload` has everything but the request id and response channel, which
+     * the server assigns.
+     */
+    struct GenerationRequest {
+        ipc::RequestPayload payload;
+        std::vector<int32_t> prompt;
+        std::vector<sequence::TokenBias> logit_bias;
+        std::vector<int32_t> stop_token_ids;
+        bool stream = false;
+    };
+
+    struct DecodeResult {
+        bool ok = false;
+        GenerationRequest request; // Valid if `ok`
+        std::string error;         // Otherwise, why the body was refused (answered with 400)
+    };
+
+    /**
+     * @brief Decodes the body of a /v1/completions (`chat` false) or
+     * /v1/chat/completions request.
+     *
+     * Never throws on client input: a body that is not a JSON object, lacks a
+     * token-id prompt, or has a field of the wrong type or range is refused
+     * with a message. `eos_token_ids` are appended to the stop ids unless the
+     * request sets `ignore_eos`.
+     */
+    DecodeResult decode_generation_request(std::string_view body, bool chat, std::span<const int32_t> eos_token_ids);
+
+} // namespace pie_core::server
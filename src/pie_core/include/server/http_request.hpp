@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace pie_core::server {
+
+    // Longest request head (request line and headers) the parser accepts.
+    constexpr size_t MAX_HEADER_BYTES = 16 * 1024;
+
+    struct HttpRequest {
+        std::string_view method;
+        std::string_view target;
+        std::string_view body;
+        bool keep_alive = true;
+    };
+
+    enum class ParseStatus {
+        INCOMPLETE, // Need more bytes
+        COMPLETE,   // `request` is valid and `consumed` bytes belong to it
+        ERROR       // Respond with `error_status` and close
+    };
+
+    struct ParseResult {
+        ParseStatus status = ParseStatus::INCOMPLETE;
+        HttpRequest request;
+        size_t consumed = 0;
+        int error_status = 0;
+    };
+
+    /**
+     * @brief Parses one HTTP/1.1 request from the front of `buffer`.
+     *
+     * Just enough HTTP for API clients: a request line, headers, and a body
+     * framed by Content-Length (chunked request bodies are refused with 411).
+     * The views in the result point into `buffer`.
+     */
+    ParseResult parse_http_request(std::string_view buffer, size_t max_body_bytes);
+
+} // namespace pie_core::server
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ipc/ipc_request.hpp"
+#include "ipc/ipc_response.hpp"
+
+namespace pie_core::server {
+
+    class Detokenizer;
+
+    struct HttpServerConfig {
+        std::string host = "0.0.0.0";
+        uint16_t port = 8000;
+        std::string model_name = "default";
+        std::vector<int32_t> eos_token_ids;      // Added to every request's stop ids
+        size_t max_connections = 4096;
+        size_t max_body_bytes = 16 * 1024 * 1024;
+    };
+
+    /**
+     * @brief Built-in OpenAI-compatible HTTP/1.1 + SSE front end.
+     *
+     * Serves `/v1/completions` and `/v1/chat/completions` (plus `/v1/models` and
+     * `/health`) from a single-threaded reactor (epoll on Linux, kqueue on macOS).
+     * It is just another producer on the engine's IPC: requests go through its
+     * own RequestWriter shard and tokens come back on response channels, so it
+     * runs inside pie_engine or as a separate process alike.
+     *
+     * Prompts must be token ids (`prompt` as an int array for completions,
+     * `prompt_token_ids` for chat); only the output side is detokenized. A
+     * helper thread sleeps on the response doorbell and wakes the reactor once
+     * per engine step, and every stream's new tokens go out as one SSE event.
+     * Requests pipelined behind a stream are buffered up to one request of
+     * the largest accepted size; past that the connection isn't read until
+     * they are served.
+     */
+    class HttpServer {
+    public:
+        HttpServer(
+            HttpServerConfig config,
+            const Detokenizer& detokenizer,
+            const std::string& request_shm_name = ipc::REQUEST_QUEUE_SHM_NAME,
+            const std::string& bulk_shm_name = ipc::BULK_DATA_SHM_NAME,
+            const std::string& response_shm_name = ipc::RESPONSE_SHM_NAME
+        );
+        ~HttpServer();
+
+        /** @brief Serves until `stop()` is called. */
+        void run();
+
+        /** @brief Makes `run()` return. Async-signal-safe. */
+        void stop() noexcept;
+
+        HttpServer(const HttpServer&) = delete;
+        HttpServer& operator=(const HttpServer&) = delete;
+        HttpServer(HttpServer&&) = delete;
+        HttpServer& operator=(HttpServer&&) = delete;
+
+    private:
+        struct HttpServerImpl;
+        std::unique_ptr<HttpServerImpl> pimpl_;
+    };
+
+} // namespace pie_core::server
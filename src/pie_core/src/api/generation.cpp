@@ -0,0 +1,79 @@
+#include "api/generation.hpp"
+
+namespace pie_core::api {
+
+    namespace {
+
+        // Upper bound on one blocking wait. A stop request needs no polling: the
+        // cancellation closes the stream, which wakes the wait.
+        constexpr std::chrono::milliseconds WAIT_INTERVAL{100};
+
+        // Parameters are copied into the frame before its first suspension, so
+        // the generator owns what it reads and may outlive its Generation.
+        Generator<StreamToken> stream_tokens(
+            std::shared_ptr<engine::TokenStream> stream,
+            CancelHandle handle,
+            std::stop_token stop
+        ) {
+            const std::stop_callback on_stop(stop, [handle] { handle.cancel(); });
+
+            std::vector<StreamToken> batch;
+            for (;;) {
+                batch.clear();
+                if (stream->read(batch) == 0) {
+                    stream->wait(WAIT_INTERVAL);
+                    continue;
+                }
+                for (const StreamToken& token : batch) {
+                    co_yield token;
+                    if (token.finish_reason != FinishReason::NONE) {
+                        co_return;
+                    }
+                }
+            }
+        }
+
+    } // namespace
+
+    Generator<StreamToken> Generation::tokens(std::stop_token stop) {
+        return stream_tokens(stream_, handle_, std::move(stop));
+    }
+
+    std::pair<std::vector<int32_t>, FinishReason> Generation::collect(std::stop_token stop) {
+        std::vector<int32_t> token_ids;
+        for (const StreamToken& token : tokens(std::move(stop))) {
+            if (token.token_id >= 0) {
+                token_ids.push_back(token.token_id);
+            }
+            if (token.finish_reason != FinishReason::NONE) {
+                return {std::move(token_ids), token.finish_reason};
+            }
+        }
+        return {std::move(token_ids), FinishReason::ERROR}; // Unreachable: streams always finish
+    }
+
+    std::optional<Generation> generate(Engine& engine, const GenerationRequest& request) {
+        std::shared_ptr<engine::TokenStream> stream = engine.submit(
+            request.prompt, request.sampling_params, request.logits_params, request.stop_criteria,
+            request.scheduling_params);
+        if (!stream) {
+            return std::nullopt;
+        }
+        return Generation(engine, std::move(stream));
+    }
+
+    std::optional<CancelHandle> generate(
+        Engine& engine,
+        const GenerationRequest& request,
+        engine::TokenStream::Callback on_token
+    ) {
+        const std::shared_ptr<engine::TokenStream> stream = engine.submit(
+            request.prompt, std::move(on_token), request.sampling_params, request.logits_params,
+            request.stop_criteria, request.scheduling_params);
+        if (!stream) {
+            return std::nullopt;
+        }
+        return CancelHandle(engine, stream->request_id());
+    }
+
+} // namespace pie_core::api
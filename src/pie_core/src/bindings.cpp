@@ -1,9 +1,419 @@
 #include <nanobind/nanobind.h>
+#include <nanobind/stl/string.h>
+#include <nanobind/stl/vector.h>
+#include <nanobind/stl/unordered_map.h>
+#include <nanobind/stl/optional.h>
+#include <nanobind/stl/shared_ptr.h>
+#include <nanobind/ndarray.h>
+
+#include <unordered_map>
+#include <vector>
+#include <chrono>
+
+#include "ipc/ipc_request.hpp"
+#include "ipc/request_writer.hpp"
+#include "ipc/response_reader.hpp"
+#include "engine/engine.hpp"
+#include "engine/page_allocator.hpp"
+#include "sequence/sampling_params.hpp"
+#include "sequence/ipc_handles.hpp"
 
 namespace nb = nanobind;
 using namespace nb::literals;
 
 NB_MODULE(pie_core, m)
 {
+    // mlx.core registers the mx::array and mx::Dtype casters (shared through
+    // NB_DOMAIN mlx); load it before anything below converts one.
+    nb::module_::import_("mlx.core");
+
     m.def("hello", []() { return "pie_core ✓"; });
+
+    // --- Request Format ---
+    m.attr("REQUEST_FORMAT_VERSION") = pie_core::ipc::REQUEST_FORMAT_VERSION;
+    m.attr("BULK_DATA_SHM_NAME") = pie_core::ipc::BULK_DATA_SHM_NAME;
+    m.attr("BULK_DATA_SHM_SIZE") = pie_core::ipc::BULK_DATA_SHM_SIZE;
+    m.attr("REQUEST_QUEUE_DEFAULT_SHARDS") = pie_core::ipc::REQUEST_QUEUE_DEFAULT_SHARDS;
+
+    nb::class_<pie_core::ipc::BulkRef>(m, "BulkRef")
+        .def(nb::init<>())
+        .def("__init__", [](pie_core::ipc::BulkRef* ref, uint64_t offset, uint32_t count) {
+            new (ref) pie_core::ipc::BulkRef{.offset = offset, .count = count};
+        }, "offset"_a, "count"_a)
+        .def_rw("offset", &pie_core::ipc::BulkRef::offset, "Byte offset from the start of the bulk segment.")
+        .def_rw("count", &pie_core::ipc::BulkRef::count, "Number of elements.");
+
+    nb::class_<pie_core::sequence::SamplingParams>(m, "SamplingParams")
+        .def(nb::init<>())
+        .def_rw("temperature", &pie_core::sequence::SamplingParams::temperature)
+        .def_rw("top_p", &pie_core::sequence::SamplingParams::top_p)
+        .def_rw("top_k", &pie_core::sequence::SamplingParams::top_k)
+        .def_rw("min_p", &pie_core::sequence::SamplingParams::min_p)
+        .def_rw("rng_seed", &pie_core::sequence::SamplingParams::rng_seed);
+
+    nb::enum_<pie_core::sequence::Priority>(m, "Priority")
+        .value("INTERACTIVE", pie_core::sequence::Priority::INTERACTIVE)
+        .value("STANDARD", pie_core::sequence::Priority::STANDARD)
+        .value("BATCH", pie_core::sequence::Priority::BATCH);
+
+    nb::class_<pie_core::sequence::SchedulingParams>(m, "SchedulingParams")
+        .def(nb::init<>())
+        .def_rw("priority", &pie_core::sequence::SchedulingParams::priority)
+        .def_rw("ttft_deadline_ms", &pie_core::sequence::SchedulingParams::ttft_deadline_ms,
+                "First token due this long after arrival, or the request is shed; 0 = no deadline.")
+        .def_rw("tenant_id", &pie_core::sequence::SchedulingParams::tenant_id,
+                "Fair-share group; see Engine.set_tenant_policy.");
+
+    nb::class_<pie_core::engine::TenantPolicy>(m, "TenantPolicy")
+        .def(nb::init<>())
+        .def_rw("weight", &pie_core::engine::TenantPolicy::weight)
+        .def_rw("tokens_per_second", &pie_core::engine::TenantPolicy::tokens_per_second,
+                "Token-bucket rate limit; 0 = unlimited.")
+        .def_rw("burst_tokens", &pie_core::engine::TenantPolicy::burst_tokens,
+                "Bucket depth; 0 = one second's worth.");
+
+    nb::class_<pie_core::sequence::IPCHandles>(m, "IPCHandles")
+        .def(nb::init<>())
+        .def_rw("request_channel_id", &pie_core::sequence::IPCHandles::request_channel_id)
+        .def_rw("response_channel_id", &pie_core::sequence::IPCHandles::response_channel_id);
+
+    nb::class_<pie_core::ipc::RequestPayload>(m, "RequestPayload")
+        .def(nb::init<>())
+        .def_ro("format_version", &pie_core::ipc::RequestPayload::format_version)
+        .def_rw("request_id", &pie_core::ipc::RequestPayload::request_id)
+        .def_rw("lease", &pie_core::ipc::RequestPayload::lease,
+                "Bulk block (header + arrays) owning this request's data; count is its size in bytes. "
+                "The engine reads the prompt in place and marks the header RELEASED when done.")
+        .def_rw("prompt", &pie_core::ipc::RequestPayload::prompt, "int32 token ids in the bulk segment.")
+        .def_rw("logit_bias", &pie_core::ipc::RequestPayload::logit_bias, "(int32 token_id, float32 bias) pairs in the bulk segment.")
+        .def_rw("stop_token_ids", &pie_core::ipc::RequestPayload::stop_token_ids, "int32 token ids in the bulk segment.")
+        .def_rw("sampling_params", &pie_core::ipc::RequestPayload::sampling_params)
+        .def_rw("frequency_penalty", &pie_core::ipc::RequestPayload::frequency_penalty)
+        .def_rw("presence_penalty", &pie_core::ipc::RequestPayload::presence_penalty)
+        .def_rw("repetition_penalty", &pie_core::ipc::RequestPayload::repetition_penalty)
+        .def_rw("repetition_context_size", &pie_core::ipc::RequestPayload::repetition_context_size)
+        .def_rw("max_generated_tokens", &pie_core::ipc::RequestPayload::max_generated_tokens)
+        .def_rw("scheduling_params", &pie_core::ipc::RequestPayload::scheduling_params)
+        .def_rw("ipc_handles", &pie_core::ipc::RequestPayload::ipc_handles);
+
+    // --- IPC Producer ---
+    nb::enum_<pie_core::ipc::SubmitStatus>(m, "SubmitStatus")
+        .value("ACCEPTED", pie_core::ipc::SubmitStatus::ACCEPTED)
+        .value("QUEUE_FULL", pie_core::ipc::SubmitStatus::QUEUE_FULL)
+        .value("BULK_FULL", pie_core::ipc::SubmitStatus::BULK_FULL)
+        .value("REJECTED", pie_core::ipc::SubmitStatus::REJECTED);
+
+    nb::enum_<pie_core::ipc::AdmissionState>(m, "AdmissionState")
+        .value("ACCEPTING", pie_core::ipc::AdmissionState::ACCEPTING)
+        .value("REJECTING", pie_core::ipc::AdmissionState::REJECTING);
+
+    nb::class_<pie_core::ipc::LoadSnapshot>(m, "LoadSnapshot")
+        .def_ro("admission", &pie_core::ipc::LoadSnapshot::admission)
+        .def_ro("retry_after_ms", &pie_core::ipc::LoadSnapshot::retry_after_ms,
+                "Back-off suggested while REJECTING; 0 otherwise.")
+        .def_ro("free_request_slots", &pie_core::ipc::LoadSnapshot::free_request_slots)
+        .def_ro("free_kv_pages", &pie_core::ipc::LoadSnapshot::free_kv_pages)
+        .def_ro("total_kv_pages", &pie_core::ipc::LoadSnapshot::total_kv_pages)
+        .def_ro("waiting_sequences", &pie_core::ipc::LoadSnapshot::waiting_sequences)
+        .def_ro("running_sequences", &pie_core::ipc::LoadSnapshot::running_sequences)
+        .def_ro("estimated_ttft_us", &pie_core::ipc::LoadSnapshot::estimated_ttft_us)
+        .def_ro("age_us", &pie_core::ipc::LoadSnapshot::age_us,
+                "Microseconds since the engine last published; large values mean it is stuck.");
+
+    nb::class_<pie_core::ipc::RequestWriter>(m, "RequestWriter")
+        .def(nb::init<const std::string&, const std::string&, std::optional<uint32_t>>(),
+             "request_shm_name"_a = pie_core::ipc::REQUEST_QUEUE_SHM_NAME,
+             "bulk_shm_name"_a = pie_core::ipc::BULK_DATA_SHM_NAME,
+             "shard"_a = nb::none(),
+             "Attach to the engine. Each writer claims its own request shard unless one is given; "
+             "use one writer per process.")
+        .def(
+            "submit",
+            [](pie_core::ipc::RequestWriter& writer,
+               const pie_core::ipc::RequestPayload& payload,
+               nb::ndarray<const int32_t, nb::ndim<1>, nb::c_contig> prompt,
+               const std::unordered_map<int32_t, float>& logit_bias,
+               const std::vector<int32_t>& stop_token_ids) {
+                std::vector<pie_core::sequence::TokenBias> biases;
+                biases.reserve(logit_bias.size());
+                for (const auto& [token_id, bias] : logit_bias) {
+                    biases.push_back({.token_id = token_id, .bias = bias});
+                }
+                const std::span<const int32_t> prompt_tokens(prompt.data(), prompt.shape(0));
+                nb::gil_scoped_release release;
+                return writer.submit(payload, prompt_tokens, biases, stop_token_ids);
+            },
+            "payload"_a,
+            "prompt"_a,
+            "logit_bias"_a = std::unordered_map<int32_t, float>{},
+            "stop_token_ids"_a = std::vector<int32_t>{},
+            "Copy the request arrays into the bulk arena, publish the request and wake the engine. "
+            "The prompt is copied straight from the int32 buffer. The payload's BulkRefs are filled in."
+        )
+        .def_prop_ro("shard", &pie_core::ipc::RequestWriter::shard)
+        .def("load", &pie_core::ipc::RequestWriter::load,
+             "Live engine load and admission state, for routing and load shedding.")
+        .def_prop_ro("bulk_bytes_in_use", &pie_core::ipc::RequestWriter::bulk_bytes_in_use);
+
+    // --- IPC Response Streams ---
+    m.attr("RESPONSE_SHM_NAME") = pie_core::ipc::RESPONSE_SHM_NAME;
+
+    nb::enum_<pie_core::ipc::FinishReason>(m, "FinishReason")
+        .value("NONE", pie_core::ipc::FinishReason::NONE)
+        .value("STOP", pie_core::ipc::FinishReason::STOP)
+        .value("LENGTH", pie_core::ipc::FinishReason::LENGTH)
+        .value("CANCELLED", pie_core::ipc::FinishReason::CANCELLED)
+        .value("ERROR", pie_core::ipc::FinishReason::ERROR)
+        .value("DEADLINE", pie_core::ipc::FinishReason::DEADLINE);
+
+    nb::class_<pie_core::ipc::ResponseReader>(m, "ResponseReader")
+        .def(nb::init<const std::string&>(), "response_shm_name"_a = pie_core::ipc::RESPONSE_SHM_NAME)
+        .def("claim_channel", &pie_core::ipc::ResponseReader::claim_channel,
+             "Claim a free response channel for the next request. Returns None if all are in use.")
+        .def("release_channel", &pie_core::ipc::ResponseReader::release_channel, "channel_id"_a,
+             "Return a channel once its final entry has been read.")
+        .def("cancel", &pie_core::ipc::ResponseReader::cancel, "channel_id"_a,
+             "Cancel the channel's request; keep reading until its final (CANCELLED) entry.")
+        .def("snapshot", &pie_core::ipc::ResponseReader::snapshot,
+             "Wakeup sequence to pass to wait(); take it before draining channels.")
+        .def(
+            "wait",
+            [](pie_core::ipc::ResponseReader& reader, uint32_t observed, double timeout_s) {
+                return reader.wait(observed, std::chrono::microseconds(static_cast<int64_t>(timeout_s * 1e6)));
+            },
+            "observed"_a, "timeout_s"_a,
+            nb::call_guard<nb::gil_scoped_release>(),
+            "Sleep until the engine finishes a step that produced output, or the timeout elapses."
+        )
+        .def(
+            "read",
+            [](pie_core::ipc::ResponseReader& reader, uint64_t channel_id) {
+                pie_core::ipc::ResponseEntry entries[pie_core::ipc::RESPONSE_CHANNEL_CAPACITY];
+                size_t count = 0;
+                {
+                    nb::gil_scoped_release release;
+                    count = reader.read(channel_id, entries, pie_core::ipc::RESPONSE_CHANNEL_CAPACITY);
+                }
+                // Continuation entries are folded into the token they belong to.
+                nb::list out;
+                std::string text;
+                for (size_t i = 0; i < count; ++i) {
+                    const auto& entry = entries[i];
+                    text.append(entry.text, entry.text_len);
+                    if (entry.flags & pie_core::ipc::RESPONSE_TEXT_CONTINUES) {
+                        continue;
+                    }
+                    out.append(nb::make_tuple(
+                        entry.token_id >= 0 ? nb::cast(entry.token_id) : nb::none(),
+                        (entry.flags & pie_core::ipc::RESPONSE_HAS_LOGPROB) ? nb::cast(entry.logprob) : nb::none(),
+                        nb::bytes(text.data(), text.size()),
+                        entry.finish_reason
+                    ));
+                    text.clear();
+                }
+                return out;
+            },
+            "channel_id"_a,
+            "Drain a channel. Returns (token_id | None, logprob | None, text: bytes, FinishReason) tuples."
+        );
+
+    // --- In-Process Engine ---
+    nb::class_<pie_core::engine::TokenStream>(m, "TokenStream")
+        .def_prop_ro("request_id", &pie_core::engine::TokenStream::request_id)
+        .def_prop_ro("closed", &pie_core::engine::TokenStream::closed,
+                     "True once the final entry has been produced (it may not be read yet).")
+        .def(
+            "read",
+            [](pie_core::engine::TokenStream& stream) {
+                std::vector<pie_core::engine::StreamToken> tokens;
+                {
+                    nb::gil_scoped_release release;
+                    stream.read(tokens);
+                }
+                nb::list out;
+                for (const auto& token : tokens) {
+                    out.append(nb::make_tuple(
+                        token.token_id >= 0 ? nb::cast(token.token_id) : nb::none(),
+                        token.finish_reason
+                    ));
+                }
+                return out;
+            },
+            "Drain without blocking. Returns (token_id | None, FinishReason) tuples; "
+            "the entry with a FinishReason other than NONE is the last."
+        )
+        .def(
+            "wait",
+            [](pie_core::engine::TokenStream& stream, double timeout_s) {
+                return stream.wait(std::chrono::microseconds(static_cast<int64_t>(timeout_s * 1e6)));
+            },
+            "timeout_s"_a,
+            nb::call_guard<nb::gil_scoped_release>(),
+            "Block until tokens are available, the stream is closed, or the timeout elapses."
+        );
+
+    nb::class_<pie_core::engine::Engine>(m, "Engine")
+        .def(
+            "__init__",
+            [](pie_core::engine::Engine* engine, const std::string& model_path, size_t num_kv_pages,
+               size_t max_num_seqs, size_t max_tokens_in_batch, size_t queue_capacity,
+               const std::string& batch_policy, uint32_t target_step_time_us, size_t decode_steps,
+               double kv_watermark, bool predict_output_lengths) {
+                const pie_core::engine::EngineConfig config{
+                    .num_kv_pages = num_kv_pages,
+                    .max_num_seqs = max_num_seqs,
+                    .max_tokens_in_batch = max_tokens_in_batch,
+                    .queue_capacity = queue_capacity,
+                    .batch_policy = batch_policy,
+                    .target_step_time_us = target_step_time_us,
+                    .decode_steps = decode_steps,
+                    .kv_watermark = kv_watermark,
+                    .predict_output_lengths = predict_output_lengths
+                };
+                new (engine) pie_core::engine::Engine(model_path, config);
+            },
+            "model_path"_a,
+            "num_kv_pages"_a = pie_core::engine::EngineConfig{}.num_kv_pages,
+            "max_num_seqs"_a = pie_core::engine::EngineConfig{}.max_num_seqs,
+            "max_tokens_in_batch"_a = pie_core::engine::EngineConfig{}.max_tokens_in_batch,
+            "queue_capacity"_a = pie_core::engine::EngineConfig{}.queue_capacity,
+            "batch_policy"_a = pie_core::engine::EngineConfig{}.batch_policy,
+            "target_step_time_us"_a = pie_core::engine::EngineConfig{}.target_step_time_us,
+            "decode_steps"_a = pie_core::engine::EngineConfig{}.decode_steps,
+            "kv_watermark"_a = pie_core::engine::EngineConfig{}.kv_watermark,
+            "predict_output_lengths"_a = pie_core::engine::EngineConfig{}.predict_output_lengths,
+            nb::call_guard<nb::gil_scoped_release>(),
+            "Load the model and start the scheduler on a native thread."
+        )
+        .def(
+            "submit",
+            [](pie_core::engine::Engine& engine,
+               nb::ndarray<const int32_t, nb::ndim<1>, nb::c_contig> prompt,
+               const pie_core::sequence::SamplingParams& sampling_params,
+               int max_generated_tokens,
+               const std::vector<int32_t>& stop_token_ids,
+               const std::unordered_map<int32_t, float>& logit_bias,
+               float frequency_penalty,
+               float presence_penalty,
+               float repetition_penalty,
+               int repetition_context_size,
+               const pie_core::sequence::SchedulingParams& scheduling_params) {
+                pie_core::sequence::LogitsParams logits_params{
+                    .frequency_penalty = frequency_penalty,
+                    .logit_bias = {},
+                    .presence_penalty = presence_penalty,
+                    .repetition_context_size = repetition_context_size,
+                    .repetition_penalty = repetition_penalty
+                };
+                logits_params.logit_bias.reserve(logit_bias.size());
+                for (const auto& [token_id, bias] : logit_bias) {
+                    logits_params.logit_bias.push_back({.token_id = token_id, .bias = bias});
+                }
+                pie_core::sequence::StopCriteria stop_criteria{
+                    .max_generated_tokens = max_generated_tokens,
+                    .stop_token_ids = stop_token_ids
+                };
+                const std::span<const int32_t> prompt_tokens(prompt.data(), prompt.shape(0));
+                std::shared_ptr<pie_core::engine::TokenStream> stream;
+                {
+                    nb::gil_scoped_release release;
+                    stream = engine.submit(
+                        prompt_tokens, sampling_params, std::move(logits_params), std::move(stop_criteria), scheduling_params);
+                }
+                if (!stream) {
+                    throw std::runtime_error("Engine: submission queue is full.");
+                }
+                return stream;
+            },
+            "prompt"_a,
+            "sampling_params"_a = pie_core::sequence::SamplingParams{},
+            "max_generated_tokens"_a = pie_core::sequence::StopCriteria{}.max_generated_tokens,
+            "stop_token_ids"_a = std::vector<int32_t>{},
+            "logit_bias"_a = std::unordered_map<int32_t, float>{},
+            "frequency_penalty"_a = 0.0f,
+            "presence_penalty"_a = 0.0f,
+            "repetition_penalty"_a = 1.0f,
+            "repetition_context_size"_a = pie_core::sequence::LogitsParams{}.repetition_context_size,
+            "scheduling_params"_a = pie_core::sequence::SchedulingParams{},
+            "Queue a request (the int32 prompt is copied once) and return its TokenStream."
+        )
+        .def("cancel", &pie_core::engine::Engine::cancel, "request_id"_a,
+             "Cancel a request; its stream closes with CANCELLED.")
+        .def("set_tenant_policy", &pie_core::engine::Engine::set_tenant_policy, "tenant_id"_a, "policy"_a,
+             "Set a tenant's fair-share weight and rate limit, from the next step.")
+        .def("set_batch_policy", &pie_core::engine::Engine::set_batch_policy, "policy_name"_a,
+             "Switch between 'hybrid', 'prefill-first' and 'decode-first' from the next step.")
+        .def_prop_ro("wakeup_fd", &pie_core::engine::Engine::wakeup_fd,
+                     "Readable while take_ready() has streams to report; for event loop readers.")
+        .def("take_ready", &pie_core::engine::Engine::take_ready,
+             "Request ids whose streams received tokens since the last call.")
+        .def("shutdown", &pie_core::engine::Engine::shutdown,
+             nb::call_guard<nb::gil_scoped_release>(),
+             "Stop the scheduler thread and close all open streams.");
+
+    // --- Paged KV Cache ---
+    m.attr("TOKEN_CAPACITY_PER_PAGE") = pie_core::engine::TOKEN_CAPACITY_PER_PAGE;
+
+    // Replacing a scale buffer must keep its layout; token data goes through
+    // KVPage.write, which copies into the page's own storage.
+    auto set_page_array = [](mx::array& slot, const mx::array& value, const char* name) {
+        if (value.shape() != slot.shape() || value.dtype() != slot.dtype()) {
+            throw nb::value_error((std::string(name) + ": shape and dtype must match the page layout.").c_str());
+        }
+        slot = value;
+    };
+
+    nb::class_<pie_core::engine::KVPage>(m, "KVPage",
+        "One page of the KV pool: TOKEN_CAPACITY_PER_PAGE token slots of [num_heads, head_dim]. "
+        "Obtained from PageAllocator.get_page(); a view that must not outlive its allocator.")
+        .def_prop_ro("page_id", &pie_core::engine::KVPage::page_id)
+        .def_prop_ro("num_heads", &pie_core::engine::KVPage::num_heads)
+        .def_prop_ro("head_dim", &pie_core::engine::KVPage::head_dim)
+        .def_prop_ro("capacity", &pie_core::engine::KVPage::capacity)
+        .def_prop_ro("ref_count", &pie_core::engine::KVPage::get_ref_count)
+        .def_prop_rw("num_tokens", &pie_core::engine::KVPage::num_tokens, &pie_core::engine::KVPage::set_num_tokens)
+        .def_prop_ro(
+            "key_cache",
+            [](pie_core::engine::KVPage& page) { return page.key_cache(); },
+            "[capacity, num_heads, head_dim]; written through write().")
+        .def_prop_ro(
+            "value_cache",
+            [](pie_core::engine::KVPage& page) { return page.value_cache(); },
+            "[capacity, num_heads, head_dim]; written through write().")
+        .def("write", &pie_core::engine::KVPage::write_tokens, "slot"_a, "keys"_a, "values"_a,
+             "Copy [count, num_heads, head_dim] keys and values, in the cache dtype, "
+             "into slots [slot, slot + count) in place.")
+        .def_prop_rw(
+            "key_cache_scale",
+            [](pie_core::engine::KVPage& page) { return page.key_cache_scale(); },
+            [set_page_array](pie_core::engine::KVPage& page, const mx::array& value) {
+                set_page_array(page.key_cache_scale(), value, "key_cache_scale");
+            },
+            "[num_heads, 1]; only meaningful for quantized pools.")
+        .def_prop_rw(
+            "value_cache_scale",
+            [](pie_core::engine::KVPage& page) { return page.value_cache_scale(); },
+            [set_page_array](pie_core::engine::KVPage& page, const mx::array& value) {
+                set_page_array(page.value_cache_scale(), value, "value_cache_scale");
+            },
+            "[num_heads, 1]; only meaningful for quantized pools.");
+
+    nb::class_<pie_core::engine::PageAllocator>(m, "PageAllocator",
+        "Fixed pool of KV pages with a lock-free free list and per-page reference counts.")
+        .def(nb::init<size_t, int32_t, int32_t, mx::Dtype, mx::Dtype>(),
+             "num_pages"_a, "num_heads"_a, "head_dim"_a,
+             "cache_dtype"_a = mx::int8, "scale_dtype"_a = mx::float16,
+             nb::call_guard<nb::gil_scoped_release>(),
+             "Allocate every page up front. Use a float cache_dtype for callers that don't quantize.")
+        .def("allocate_page", &pie_core::engine::PageAllocator::allocate_page,
+             "Take a page (ref count 1). Returns None if the pool is exhausted.")
+        .def("free_page", &pie_core::engine::PageAllocator::free_page, "page_id"_a,
+             "Drop one reference; the page returns to the pool when none are left.")
+        .def("add_ref", &pie_core::engine::PageAllocator::add_ref, "page_id"_a,
+             "Share a page (e.g. a common prompt prefix) between page tables.")
+        .def("get_page",
+             nb::overload_cast<uint32_t>(&pie_core::engine::PageAllocator::get_page),
+             "page_id"_a, nb::rv_policy::reference_internal)
+        .def_prop_ro("num_free_pages", &pie_core::engine::PageAllocator::get_num_free_pages)
+        .def("__len__", &pie_core::engine::PageAllocator::size);
 }
@@ -0,0 +1,49 @@
+#include "engine/admission_controller.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace pie_core::engine {
+
+    void AdmissionController::set_watermark(double free_fraction) {
+        if (!(free_fraction >= 0.0 && free_fraction < 1.0)) {
+            throw std::invalid_argument("AdmissionController: the watermark must be in [0, 1).");
+        }
+        watermark_pages_ = static_cast<size_t>(std::ceil(free_fraction * static_cast<double>(total_pages_)));
+    }
+
+    size_t AdmissionController::pages_needed(size_t prompt_len, size_t max_new_tokens) const noexcept {
+        const auto expected_output = static_cast<size_t>(
+            std::ceil(output_fraction() * static_cast<double>(max_new_tokens)));
+        return (prompt_len + expected_output + tokens_per_page_ - 1) / tokens_per_page_;
+    }
+
+    bool AdmissionController::admits(size_t free_pages, size_t outstanding_pages, size_t needed) const noexcept {
+        // Compared as additions: the left side may well not cover the right.
+        return free_pages >= outstanding_pages + needed + watermark_pages_;
+    }
+
+    void AdmissionController::observe_finished(size_t generated_tokens, size_t max_new_tokens) noexcept {
+        if (max_new_tokens == 0) {
+            return;
+        }
+        const double fraction = std::min(1.0, static_cast<double>(generated_tokens) / static_cast<double>(max_new_tokens));
+        if (observations_++ == 0) {
+            mean_fraction_ = fraction;
+            mean_square_fraction_ = fraction * fraction;
+            return;
+        }
+        mean_fraction_ += OBSERVATION_WEIGHT * (fraction - mean_fraction_);
+        mean_square_fraction_ += OBSERVATION_WEIGHT * (fraction * fraction - mean_square_fraction_);
+    }
+
+    double AdmissionController::output_fraction() const noexcept {
+        if (!predict_ || observations_ < MIN_OBSERVATIONS) {
+            return 1.0;
+        }
+        const double variance = std::max(0.0, mean_square_fraction_ - mean_fraction_ * mean_fraction_);
+        return std::clamp(mean_fraction_ + 2.0 * std::sqrt(variance), 0.0, 1.0);
+    }
+
+} // namespace pie_core::engine
@@ -0,0 +1,460 @@
+#include "engine/batch_details.hpp"
+#include "engine/block_table.hpp"
+#include "engine/page.hpp"
+#include "sequence/sequence.hpp"
+
+#include <mlx/allocator.h>
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace pie_core::engine {
+
+    namespace {
+
+        using Deleter = std::function<void(mx::allocator::Buffer)>;
+
+        struct StepShape {
+            size_t total_tokens = 0;
+            size_t max_pages = 1; // DENSE row length
+            size_t total_pages = 0;
+        };
+
+        StepShape measure(std::span<const TokenChunk> chunks) {
+            StepShape shape;
+            for (const auto& chunk : chunks) {
+                shape.total_tokens += chunk.length;
+                shape.max_pages = std::max(shape.max_pages, chunk.sequence->page_table.size());
+                shape.total_pages += chunk.sequence->page_table.size();
+            }
+            return shape;
+        }
+
+        void check_spec(std::span<const TokenChunk> chunks, const BlockTableSpec& spec) {
+            if (spec.layout == BlockTableLayout::PERSISTENT && (!spec.table || spec.rows.size() != chunks.size())) {
+                throw std::invalid_argument("BatchDetails: a persistent block table needs a row per chunk.");
+            }
+        }
+
+        // int32 entries the per-step block table buffer needs (none for PERSISTENT).
+        size_t block_table_entries(const StepShape& shape, size_t num_sequences, BlockTableLayout layout) {
+            switch (layout) {
+                case BlockTableLayout::DENSE: return num_sequences * shape.max_pages;
+                case BlockTableLayout::CSR: return shape.total_pages;
+                case BlockTableLayout::PERSISTENT: return 0;
+            }
+            return 0;
+        }
+
+        // Makes room for `entries` int32s, growing geometrically so long
+        // sequences reallocate only a few times. Contents are not kept.
+        void reserve_entries(mx::allocator::Buffer& buffer, size_t& capacity, size_t entries) {
+            if (entries <= capacity) {
+                return;
+            }
+            mx::allocator::free(buffer);
+            capacity = std::max(entries, capacity * 2);
+            buffer = mx::allocator::malloc(capacity * sizeof(int32_t));
+        }
+
+        void copy_token_ids(std::span<const TokenChunk> chunks, int32_t* out) {
+            for (const auto& chunk : chunks) {
+                chunk.sequence->copy_tokens(chunk.start, chunk.length, out);
+                out += chunk.length;
+            }
+        }
+
+        // Per-sequence metadata, reusing whatever capacity the vectors have.
+        struct StepMetadata {
+            std::vector<uint64_t> sequence_ids;
+            std::vector<int32_t> input_lengths;
+            std::vector<int32_t> context_lengths;
+            size_t num_prefill_sequences = 0;
+            size_t num_decode_sequences = 0;
+        };
+
+        // Writes positions and KV slots for every chunk token, and collects the
+        // per-sequence metadata.
+        void lay_out_tokens(
+            std::span<const TokenChunk> chunks,
+            int32_t* position_out,
+            int32_t* slot_out,
+            StepMetadata& metadata
+        ) {
+            for (const auto& chunk : chunks) {
+                const sequence::Sequence& sequence = *chunk.sequence;
+                metadata.sequence_ids.push_back(sequence.sequence_id);
+                metadata.input_lengths.push_back(static_cast<int32_t>(chunk.length));
+                metadata.context_lengths.push_back(static_cast<int32_t>(chunk.start));
+                if (sequence.status == sequence::SequenceStatus::DECODING) {
+                    ++metadata.num_decode_sequences;
+                } else {
+                    ++metadata.num_prefill_sequences;
+                }
+
+                for (size_t position = chunk.start; position < chunk.start + chunk.length; ++position) {
+                    const size_t page_index = position / TOKEN_CAPACITY_PER_PAGE;
+                    *position_out++ = static_cast<int32_t>(position);
+                    *slot_out++ = page_index < sequence.page_table.size()
+                        ? static_cast<int32_t>(sequence.page_table[page_index] * TOKEN_CAPACITY_PER_PAGE
+                                               + position % TOKEN_CAPACITY_PER_PAGE)
+                        : -1;
+                }
+            }
+        }
+
+        // Writes the DENSE rows or CSR pages into `table_out`, and the
+        // PERSISTENT rows or CSR offsets into `index_out`.
+        void lay_out_block_table(
+            std::span<const TokenChunk> chunks,
+            const BlockTableSpec& spec,
+            const StepShape& shape,
+            int32_t* table_out,
+            int32_t* index_out
+        ) {
+            switch (spec.layout) {
+                case BlockTableLayout::DENSE:
+                    for (const auto& chunk : chunks) {
+                        const std::vector<uint32_t>& pages = chunk.sequence->page_table;
+                        table_out = std::copy(pages.begin(), pages.end(), table_out);
+                        table_out = std::fill_n(table_out, shape.max_pages - pages.size(), -1);
+                    }
+                    break;
+                case BlockTableLayout::CSR: {
+                    int32_t offset = 0;
+                    for (const auto& chunk : chunks) {
+                        const std::vector<uint32_t>& pages = chunk.sequence->page_table;
+                        *index_out++ = offset;
+                        table_out = std::copy(pages.begin(), pages.end(), table_out);
+                        offset += static_cast<int32_t>(pages.size());
+                    }
+                    *index_out = offset;
+                    break;
+                }
+                case BlockTableLayout::PERSISTENT:
+                    std::copy(spec.rows.begin(), spec.rows.end(), index_out);
+                    break;
+            }
+        }
+
+        struct BlockTableArrays {
+            mx::array table;
+            std::optional<mx::array> index;
+        };
+
+        BlockTableArrays wrap_block_table(
+            const BlockTableSpec& spec,
+            const StepShape& shape,
+            size_t num_sequences,
+            mx::allocator::Buffer table,
+            mx::allocator::Buffer index,
+            const Deleter& deleter
+        ) {
+            const auto rows = static_cast<int32_t>(num_sequences);
+            switch (spec.layout) {
+                case BlockTableLayout::DENSE:
+                    return {mx::array(table, {rows, static_cast<int32_t>(shape.max_pages)}, mx::int32, deleter),
+                            std::nullopt};
+                case BlockTableLayout::CSR:
+                    return {mx::array(table, {static_cast<int32_t>(shape.total_pages)}, mx::int32, deleter),
+                            mx::array(index, {rows + 1}, mx::int32, deleter)};
+                case BlockTableLayout::PERSISTENT:
+                    break;
+            }
+            return {spec.table->array(), mx::array(index, {rows}, mx::int32, deleter)};
+        }
+
+        BatchDetails assemble(
+            StepMetadata&& metadata,
+            const StepShape& shape,
+            BlockTableLayout layout,
+            mx::array token_ids,
+            mx::array positions,
+            mx::array slot_mapping,
+            BlockTableArrays&& block_table
+        ) {
+            return BatchDetails{
+                .token_ids = std::move(token_ids),
+                .positions = std::move(positions),
+                .slot_mapping = std::move(slot_mapping),
+                .sequence_ids = std::move(metadata.sequence_ids),
+                .input_lengths = std::move(metadata.input_lengths),
+                .context_lengths = std::move(metadata.context_lengths),
+                .consolidated_block_table = std::move(block_table.table),
+                .block_table_layout = layout,
+                .block_table_index = std::move(block_table.index),
+                .num_prefill_sequences = metadata.num_prefill_sequences,
+                .num_decode_sequences = metadata.num_decode_sequences,
+                .total_tokens_in_step = shape.total_tokens,
+                .attention_mask = std::nullopt
+            };
+        }
+
+    } // namespace
+
+    mx::array gather_token_ids(std::span<const TokenChunk> chunks) {
+        const size_t total_tokens = measure(chunks).total_tokens;
+
+        // The array takes ownership of the buffer; no staging vector in between.
+        mx::allocator::Buffer buffer = mx::allocator::malloc(total_tokens * sizeof(int32_t));
+        copy_token_ids(chunks, static_cast<int32_t*>(buffer.raw_ptr()));
+        return mx::array(buffer, {static_cast<int32_t>(total_tokens)}, mx::int32);
+    }
+
+    BatchDetails build_batch_details(std::span<const TokenChunk> chunks) {
+        return build_batch_details(chunks, gather_token_ids(chunks));
+    }
+
+    BatchDetails build_batch_details(
+        std::span<const TokenChunk> chunks,
+        mx::array token_ids,
+        const BlockTableSpec& block_table
+    ) {
+        check_spec(chunks, block_table);
+        const size_t num_sequences = chunks.size();
+        const StepShape shape = measure(chunks);
+
+        StepMetadata metadata;
+        metadata.sequence_ids.reserve(num_sequences);
+        metadata.input_lengths.reserve(num_sequences);
+        metadata.context_lengths.reserve(num_sequences);
+
+        mx::allocator::Buffer positions = mx::allocator::malloc(shape.total_tokens * sizeof(int32_t));
+        mx::allocator::Buffer slot_mapping = mx::allocator::malloc(shape.total_tokens * sizeof(int32_t));
+        lay_out_tokens(chunks,
+                       static_cast<int32_t*>(positions.raw_ptr()),
+                       static_cast<int32_t*>(slot_mapping.raw_ptr()),
+                       metadata);
+
+        // Only allocate what the layout uses; the arrays take ownership.
+        const size_t table_entries = block_table_entries(shape, num_sequences, block_table.layout);
+        mx::allocator::Buffer table{nullptr};
+        mx::allocator::Buffer index{nullptr};
+        if (block_table.layout != BlockTableLayout::PERSISTENT) {
+            table = mx::allocator::malloc(table_entries * sizeof(int32_t));
+        }
+        if (block_table.layout != BlockTableLayout::DENSE) {
+            index = mx::allocator::malloc((num_sequences + 1) * sizeof(int32_t));
+        }
+        lay_out_block_table(chunks, block_table, shape,
+                            static_cast<int32_t*>(table.raw_ptr()),
+                            static_cast<int32_t*>(index.raw_ptr()));
+
+        const auto num_tokens = static_cast<int32_t>(shape.total_tokens);
+        return assemble(
+            std::move(metadata), shape, block_table.layout, std::move(token_ids),
+            mx::array(positions, {num_tokens}, mx::int32),
+            mx::array(slot_mapping, {num_tokens}, mx::int32),
+            wrap_block_table(block_table, shape, num_sequences, table, index, mx::allocator::free));
+    }
+
+    // --- BatchDetailsBuilder ---
+
+    BatchDetailsBuilder::BatchDetailsBuilder(size_t max_num_seqs, size_t max_tokens_in_batch)
+        : max_num_seqs_(max_num_seqs), max_tokens_in_batch_(max_tokens_in_batch)
+    {
+        for (BufferSet& set : buffer_sets_) {
+            set.token_ids = mx::allocator::malloc(max_tokens_in_batch * sizeof(int32_t));
+            set.positions = mx::allocator::malloc(max_tokens_in_batch * sizeof(int32_t));
+            set.slot_mapping = mx::allocator::malloc(max_tokens_in_batch * sizeof(int32_t));
+            set.token_capacity = max_tokens_in_batch;
+            set.block_table_capacity = max_num_seqs; // One page each to start with
+            set.block_table = mx::allocator::malloc(set.block_table_capacity * sizeof(int32_t));
+            set.block_table_index = mx::allocator::malloc((max_num_seqs + 1) * sizeof(int32_t));
+        }
+    }
+
+    BatchDetailsBuilder::~BatchDetailsBuilder() {
+        for (BufferSet& set : buffer_sets_) {
+            set.details.reset();
+            set.run.clear();
+            mx::allocator::free(set.token_ids);
+            mx::allocator::free(set.positions);
+            mx::allocator::free(set.slot_mapping);
+            mx::allocator::free(set.block_table);
+            mx::allocator::free(set.block_table_index);
+        }
+    }
+
+    const BatchDetails& BatchDetailsBuilder::build(std::span<const TokenChunk> chunks, const BlockTableSpec& block_table) {
+        BufferSet& set = buffer_sets_[next_set_];
+        if (matches_prepared(chunks, block_table)) {
+            // Only what may have changed since prepare(): statuses (a prompt
+            // finished in between) and the persistent table's buffer.
+            BatchDetails& details = *set.details;
+            details.num_prefill_sequences = 0;
+            details.num_decode_sequences = 0;
+            for (const auto& chunk : chunks) {
+                if (chunk.sequence->status == sequence::SequenceStatus::DECODING) {
+                    ++details.num_decode_sequences;
+                } else {
+                    ++details.num_prefill_sequences;
+                }
+            }
+            if (block_table.layout == BlockTableLayout::PERSISTENT) {
+                details.consolidated_block_table = block_table.table->array();
+            }
+        } else {
+            lay_out(set, chunks, block_table);
+        }
+        has_prepared_ = false;
+        next_set_ ^= 1;
+
+        copy_token_ids(chunks, static_cast<int32_t*>(set.token_ids.raw_ptr()));
+        return *set.details;
+    }
+
+    void BatchDetailsBuilder::prepare(std::span<const TokenChunk> chunks, const BlockTableSpec& block_table) {
+        lay_out(buffer_sets_[next_set_], chunks, block_table);
+        prepared_.clear();
+        for (const auto& chunk : chunks) {
+            prepared_.push_back({chunk.sequence, chunk.start, chunk.length, chunk.sequence->page_table.size()});
+        }
+        prepared_rows_.assign(block_table.rows.begin(), block_table.rows.end());
+        prepared_layout_ = block_table.layout;
+        has_prepared_ = true;
+    }
+
+    bool BatchDetailsBuilder::matches_prepared(std::span<const TokenChunk> chunks, const BlockTableSpec& block_table) const {
+        if (!has_prepared_ || block_table.layout != prepared_layout_ || chunks.size() != prepared_.size()
+            || !std::ranges::equal(block_table.rows, prepared_rows_)) {
+            return false;
+        }
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            const PreparedChunk& prepared = prepared_[i];
+            if (chunks[i].sequence != prepared.sequence || chunks[i].start != prepared.start
+                || chunks[i].length != prepared.length || chunks[i].sequence->page_table.size() != prepared.num_pages) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::span<BatchDetails> BatchDetailsBuilder::build_run(
+        std::span<const TokenChunk> chunks,
+        size_t num_steps,
+        const BlockTableSpec& block_table
+    ) {
+        check_spec(chunks, block_table);
+        if (num_steps == 0 || std::ranges::any_of(chunks, [](const TokenChunk& chunk) { return chunk.length != 1; })) {
+            throw std::invalid_argument("BatchDetailsBuilder: a decode run needs steps and one-token chunks.");
+        }
+        const size_t num_sequences = chunks.size();
+        if (num_sequences > max_num_seqs_) {
+            throw std::length_error("BatchDetailsBuilder: step exceeds the preallocated capacity.");
+        }
+        BufferSet& set = buffer_sets_[next_set_];
+        has_prepared_ = false;
+        next_set_ ^= 1;
+
+        // Page tables don't change during a run, so its steps share one block table.
+        const StepShape shape = measure(chunks);
+        reserve_entries(set.block_table, set.block_table_capacity,
+                        block_table_entries(shape, num_sequences, block_table.layout));
+        lay_out_block_table(chunks, block_table, shape,
+                            static_cast<int32_t*>(set.block_table.raw_ptr()),
+                            static_cast<int32_t*>(set.block_table_index.raw_ptr()));
+
+        // Every step's positions and slots, step-major; each step views its row.
+        const size_t run_tokens = num_steps * num_sequences;
+        if (run_tokens > set.token_capacity) {
+            mx::allocator::free(set.positions);
+            mx::allocator::free(set.slot_mapping);
+            set.token_capacity = std::max(run_tokens, set.token_capacity * 2);
+            set.positions = mx::allocator::malloc(set.token_capacity * sizeof(int32_t));
+            set.slot_mapping = mx::allocator::malloc(set.token_capacity * sizeof(int32_t));
+        }
+        const Deleter borrowed = [](mx::allocator::Buffer) {};
+        const auto steps = static_cast<int32_t>(num_steps);
+        const auto rows = static_cast<int32_t>(num_sequences);
+        const mx::array positions(set.positions, {steps, rows}, mx::int32, borrowed);
+        const mx::array slot_mapping(set.slot_mapping, {steps, rows}, mx::int32, borrowed);
+        const mx::array no_token_ids(set.token_ids, {rows}, mx::int32, borrowed); // Set by the caller
+
+        run_chunks_.assign(chunks.begin(), chunks.end());
+        for (size_t step = 0; step < num_steps; ++step) {
+            // Take the vectors back from this step's previous run, capacity intact.
+            StepMetadata metadata;
+            if (step < set.run.size()) {
+                metadata.sequence_ids = std::move(set.run[step].sequence_ids);
+                metadata.input_lengths = std::move(set.run[step].input_lengths);
+                metadata.context_lengths = std::move(set.run[step].context_lengths);
+                metadata.sequence_ids.clear();
+                metadata.input_lengths.clear();
+                metadata.context_lengths.clear();
+            }
+            lay_out_tokens(run_chunks_,
+                           static_cast<int32_t*>(set.positions.raw_ptr()) + step * num_sequences,
+                           static_cast<int32_t*>(set.slot_mapping.raw_ptr()) + step * num_sequences,
+                           metadata);
+            for (TokenChunk& chunk : run_chunks_) {
+                ++chunk.start;
+            }
+
+            const auto row = static_cast<int32_t>(step);
+            BatchDetails details = assemble(
+                std::move(metadata), shape, block_table.layout, no_token_ids,
+                mx::reshape(mx::slice(positions, {row, 0}, {row + 1, rows}), {rows}),
+                mx::reshape(mx::slice(slot_mapping, {row, 0}, {row + 1, rows}), {rows}),
+                wrap_block_table(block_table, shape, num_sequences, set.block_table, set.block_table_index, borrowed));
+            if (step < set.run.size()) {
+                set.run[step] = std::move(details);
+            } else {
+                set.run.push_back(std::move(details));
+            }
+        }
+        set.run.erase(set.run.begin() + steps, set.run.end());
+        return set.run;
+    }
+
+    // Everything but the token ids, into `set`.
+    void BatchDetailsBuilder::lay_out(BufferSet& set, std::span<const TokenChunk> chunks, const BlockTableSpec& block_table) {
+        check_spec(chunks, block_table);
+        const size_t num_sequences = chunks.size();
+        const StepShape shape = measure(chunks);
+        if (num_sequences > max_num_seqs_ || shape.total_tokens > max_tokens_in_batch_) {
+            throw std::length_error("BatchDetailsBuilder: step exceeds the preallocated capacity.");
+        }
+
+        // Take the vectors back from this set's previous step, capacity intact.
+        StepMetadata metadata;
+        if (set.details) {
+            metadata.sequence_ids = std::move(set.details->sequence_ids);
+            metadata.input_lengths = std::move(set.details->input_lengths);
+            metadata.context_lengths = std::move(set.details->context_lengths);
+            set.details.reset();
+        }
+        metadata.sequence_ids.clear();
+        metadata.input_lengths.clear();
+        metadata.context_lengths.clear();
+        metadata.sequence_ids.reserve(max_num_seqs_);
+        metadata.input_lengths.reserve(max_num_seqs_);
+        metadata.context_lengths.reserve(max_num_seqs_);
+
+        reserve_entries(set.block_table, set.block_table_capacity,
+                        block_table_entries(shape, num_sequences, block_table.layout));
+
+        lay_out_tokens(chunks,
+                       static_cast<int32_t*>(set.positions.raw_ptr()),
+                       static_cast<int32_t*>(set.slot_mapping.raw_ptr()),
+                       metadata);
+        lay_out_block_table(chunks, block_table, shape,
+                            static_cast<int32_t*>(set.block_table.raw_ptr()),
+                            static_cast<int32_t*>(set.block_table_index.raw_ptr()));
+
+        // The builder owns the memory; the arrays only borrow it. Token ids
+        // are written by build().
+        const Deleter borrowed = [](mx::allocator::Buffer) {};
+        const auto num_tokens = static_cast<int32_t>(shape.total_tokens);
+        set.details.emplace(assemble(
+            std::move(metadata), shape, block_table.layout,
+            mx::array(set.token_ids, {num_tokens}, mx::int32, borrowed),
+            mx::array(set.positions, {num_tokens}, mx::int32, borrowed),
+            mx::array(set.slot_mapping, {num_tokens}, mx::int32, borrowed),
+            wrap_block_table(block_table, shape, num_sequences, set.block_table, set.block_table_index, borrowed)));
+    }
+
+} // namespace pie_core::engine
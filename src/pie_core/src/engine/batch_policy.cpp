@@ -0,0 +1,85 @@
+#include "engine/batch_policy.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace pie_core::engine {
+
+    std::unordered_map<std::string, BatchPolicyCreatorFunc>& BatchPolicyRegistry::get_registry() {
+        static std::unordered_map<std::string, BatchPolicyCreatorFunc> registry;
+        return registry;
+    }
+
+    bool BatchPolicyRegistry::register_policy(const std::string& policy_name, BatchPolicyCreatorFunc creator) {
+        auto& registry = get_registry();
+        if (registry.count(policy_name)) {
+            throw std::runtime_error("Batch policy already registered: " + policy_name);
+        }
+        registry[policy_name] = std::move(creator);
+        return true;
+    }
+
+    std::unique_ptr<IBatchPolicy> BatchPolicyRegistry::create_policy(const std::string& policy_name) {
+        auto& registry = get_registry();
+        auto it = registry.find(policy_name);
+        if (it == registry.end()) {
+            throw std::runtime_error("Unsupported batch policy: " + policy_name);
+        }
+        return it->second();
+    }
+
+    std::vector<std::string> BatchPolicyRegistry::policy_names() {
+        std::vector<std::string> names;
+        for (const auto& [name, creator] : get_registry()) {
+            names.push_back(name);
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    namespace {
+
+        // --- Built-in policies ---
+        // Registered here rather than in their own files so the static library
+        // can't drop them: the scheduler always links this translation unit.
+
+        class HybridPolicy final : public IBatchPolicy {
+        public:
+            BatchMix plan(const BatchState& state) override {
+                return {.max_decode_tokens = state.token_budget, .max_prefill_tokens = state.token_budget};
+            }
+
+            std::string name() const override { return "hybrid"; }
+        };
+
+        class PrefillFirstPolicy final : public IBatchPolicy {
+        public:
+            BatchMix plan(const BatchState& state) override {
+                if (state.num_prefilling > 0) {
+                    return {.max_decode_tokens = 0, .max_prefill_tokens = state.token_budget};
+                }
+                return {.max_decode_tokens = state.token_budget, .max_prefill_tokens = 0};
+            }
+
+            std::string name() const override { return "prefill-first"; }
+        };
+
+        class DecodeFirstPolicy final : public IBatchPolicy {
+        public:
+            BatchMix plan(const BatchState& state) override {
+                if (state.num_decoding > 0) {
+                    return {.max_decode_tokens = state.token_budget, .max_prefill_tokens = 0};
+                }
+                return {.max_decode_tokens = 0, .max_prefill_tokens = state.token_budget};
+            }
+
+            std::string name() const override { return "decode-first"; }
+        };
+
+        BatchPolicyRegistrar<HybridPolicy> hybrid_registrar("hybrid");
+        BatchPolicyRegistrar<PrefillFirstPolicy> prefill_first_registrar("prefill-first");
+        BatchPolicyRegistrar<DecodeFirstPolicy> decode_first_registrar("decode-first");
+
+    } // namespace
+
+} // namespace pie_core::engine
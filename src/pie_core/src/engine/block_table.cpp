@@ -0,0 +1,72 @@
+#include "engine/block_table.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace pie_core::engine {
+
+    PersistentBlockTable::PersistentBlockTable(size_t num_rows)
+        : row_lengths_(num_rows, 0)
+    {
+        if (num_rows == 0) {
+            throw std::invalid_argument("PersistentBlockTable: needs at least one row.");
+        }
+        buffer_ = mx::allocator::malloc(num_rows * row_capacity_ * sizeof(int32_t));
+        entries_ = static_cast<int32_t*>(buffer_.raw_ptr());
+        std::fill_n(entries_, num_rows * row_capacity_, -1);
+    }
+
+    PersistentBlockTable::~PersistentBlockTable() {
+        mx::allocator::free(buffer_);
+        for (const mx::allocator::Buffer& buffer : outgrown_) {
+            mx::allocator::free(buffer);
+        }
+    }
+
+    void PersistentBlockTable::sync_row(uint32_t row, std::span<const uint32_t> page_table) {
+        uint32_t& length = row_lengths_.at(row);
+        if (page_table.size() > row_capacity_) {
+            grow(page_table.size());
+        }
+        int32_t* entries = entries_ + static_cast<size_t>(row) * row_capacity_;
+        if (page_table.size() < length) {
+            std::fill(entries + page_table.size(), entries + length, -1);
+        } else {
+            std::copy(page_table.begin() + length, page_table.end(), entries + length);
+        }
+        length = static_cast<uint32_t>(page_table.size());
+    }
+
+    mx::array PersistentBlockTable::array() {
+        return mx::array(
+            buffer_,
+            {static_cast<int32_t>(num_rows()), static_cast<int32_t>(row_capacity_)},
+            mx::int32,
+            [](mx::allocator::Buffer) {}); // The table owns the buffer
+    }
+
+    int32_t PersistentBlockTable::page_at(uint32_t row, size_t index) const {
+        if (row >= num_rows() || index >= row_capacity_) {
+            throw std::out_of_range("PersistentBlockTable: entry out of range.");
+        }
+        return entries_[static_cast<size_t>(row) * row_capacity_ + index];
+    }
+
+    void PersistentBlockTable::grow(size_t min_capacity) {
+        size_t capacity = row_capacity_;
+        while (capacity < min_capacity) {
+            capacity *= 2;
+        }
+        mx::allocator::Buffer grown = mx::allocator::malloc(num_rows() * capacity * sizeof(int32_t));
+        auto* out = static_cast<int32_t*>(grown.raw_ptr());
+        for (size_t row = 0; row < num_rows(); ++row) {
+            const int32_t* in = entries_ + row * row_capacity_;
+            std::fill(std::copy(in, in + row_capacity_, out + row * capacity), out + (row + 1) * capacity, -1);
+        }
+        outgrown_.push_back(buffer_);
+        buffer_ = grown;
+        entries_ = out;
+        row_capacity_ = capacity;
+    }
+
+} // namespace pie_core::engine
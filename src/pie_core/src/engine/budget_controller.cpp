@@ -0,0 +1,54 @@
+#include "engine/budget_controller.hpp"
+
+#include <algorithm>
+
+namespace pie_core::engine {
+
+    namespace {
+
+        // A window whose steps filled this much of their budget was limited by
+        // it, so the step time says something about a larger budget.
+        constexpr double BINDING_FILL = 0.9;
+
+    } // namespace
+
+    void BudgetController::set_target(std::chrono::microseconds target) noexcept {
+        target_ = std::max(target, std::chrono::microseconds{0});
+        budget_ = max_tokens_;
+        window_steps_ = 0;
+        window_us_ = 0.0;
+        window_tokens_ = 0;
+        window_budget_ = 0;
+    }
+
+    void BudgetController::observe(double step_us, size_t tokens, bool had_decodes) noexcept {
+        if (target_.count() == 0 || !had_decodes || tokens == 0) {
+            return;
+        }
+        window_us_ += step_us;
+        window_tokens_ += tokens;
+        window_budget_ += budget_;
+        if (++window_steps_ < ADJUST_INTERVAL) {
+            return;
+        }
+
+        const double ratio = static_cast<double>(target_.count()) / (window_us_ / static_cast<double>(window_steps_));
+        const bool binding = static_cast<double>(window_tokens_) >= BINDING_FILL * static_cast<double>(window_budget_);
+        if (ratio < 1.0 || binding) {
+            // Tokens that would have fit in the target, assuming step time
+            // scales with tokens (it has a fixed part, so this undershoots a
+            // little when growing and the next windows close the gap).
+            const double mean_tokens = static_cast<double>(window_tokens_) / static_cast<double>(window_steps_);
+            const double budget = static_cast<double>(budget_);
+            const double wanted = std::clamp(mean_tokens * ratio, budget / 2.0, budget * 2.0);
+            const auto next = static_cast<size_t>((budget + wanted) / 2.0);
+            budget_ = std::clamp(next, std::min(MIN_TOKENS, max_tokens_), max_tokens_);
+        }
+
+        window_steps_ = 0;
+        window_us_ = 0.0;
+        window_tokens_ = 0;
+        window_budget_ = 0;
+    }
+
+} // namespace pie_core::engine
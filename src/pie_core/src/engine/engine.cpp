@@ -0,0 +1,351 @@
+#include "engine/engine.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <spdlog/spdlog.h>
+
+#include "engine/batch_policy.hpp"
+#include "engine/page_allocator.hpp"
+#include "engine/scheduler.hpp"
+#include "engine/token_sink.hpp"
+#include "models/imodel.hpp"
+#include "models/model_factory.hpp"
+#include "sequence/sequence.hpp"
+
+namespace pie_core::engine {
+
+    namespace {
+
+        /**
+         * Routes tokens to in-process TokenStreams by request id. Streams with
+         * output are collected over a step and announced once, in `flush()`,
+         * through a self-pipe that event loops can watch.
+         */
+        class StreamSink final : public ITokenSink {
+        public:
+            StreamSink() {
+                if (pipe(wakeup_fds_) == -1) {
+                    throw std::runtime_error(std::string("Engine: pipe() failed: ") + std::strerror(errno));
+                }
+                for (const int fd : wakeup_fds_) {
+                    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                    fcntl(fd, F_SETFD, FD_CLOEXEC);
+                }
+            }
+
+            ~StreamSink() override {
+                close(wakeup_fds_[0]);
+                close(wakeup_fds_[1]);
+            }
+
+            void add(std::shared_ptr<TokenStream> stream) {
+                std::lock_guard lock(streams_mutex_);
+                const uint64_t request_id = stream->request_id();
+                streams_.emplace(request_id, std::move(stream));
+            }
+
+            void remove(uint64_t request_id) {
+                std::lock_guard lock(streams_mutex_);
+                streams_.erase(request_id);
+            }
+
+            void emit(
+                const sequence::Sequence& sequence,
+                int32_t token_id,
+                std::optional<float> /*logprob*/,
+                ipc::FinishReason finish_reason
+            ) override {
+                deliver(sequence.sequence_id, {.token_id = token_id, .finish_reason = finish_reason});
+            }
+
+            void finish(const sequence::Sequence& sequence, ipc::FinishReason finish_reason) override {
+                deliver(sequence.sequence_id, {.token_id = -1, .finish_reason = finish_reason});
+            }
+
+            void flush() override {
+                if (step_ready_.empty()) {
+                    return;
+                }
+                std::lock_guard lock(ready_mutex_);
+                ready_.insert(ready_.end(), step_ready_.begin(), step_ready_.end());
+                step_ready_.clear();
+                if (!wakeup_pending_) {
+                    // One byte per batch of announcements; take_ready() drains it.
+                    const char byte = 1;
+                    wakeup_pending_ = write(wakeup_fds_[1], &byte, 1) == 1;
+                }
+            }
+
+            // Scheduler thread (or after it has exited).
+            void close_all(ipc::FinishReason finish_reason) {
+                std::unordered_map<uint64_t, std::shared_ptr<TokenStream>> streams;
+                {
+                    std::lock_guard lock(streams_mutex_);
+                    streams.swap(streams_);
+                }
+                for (const auto& [request_id, stream] : streams) {
+                    if (stream->push({.token_id = -1, .finish_reason = finish_reason})) {
+                        step_ready_.push_back(request_id);
+                    }
+                }
+                flush();
+            }
+
+            std::vector<uint64_t> take_ready() {
+                std::lock_guard lock(ready_mutex_);
+                char buffer[64];
+                while (read(wakeup_fds_[0], buffer, sizeof(buffer)) > 0) {
+                }
+                wakeup_pending_ = false;
+                std::vector<uint64_t> ready;
+                ready.swap(ready_);
+                return ready;
+            }
+
+            [[nodiscard]] int wakeup_fd() const noexcept { return wakeup_fds_[0]; }
+
+        private:
+            std::mutex streams_mutex_;
+            std::unordered_map<uint64_t, std::shared_ptr<TokenStream>> streams_;
+
+            std::vector<uint64_t> step_ready_; // Scheduler thread only
+
+            std::mutex ready_mutex_;
+            std::vector<uint64_t> ready_;
+            bool wakeup_pending_ = false;
+            int wakeup_fds_[2] = {-1, -1};
+
+            void deliver(uint64_t request_id, StreamToken token) {
+                std::shared_ptr<TokenStream> stream;
+                {
+                    std::lock_guard lock(streams_mutex_);
+                    const auto it = streams_.find(request_id);
+                    if (it == streams_.end()) {
+                        return;
+                    }
+                    stream = it->second;
+                    if (token.finish_reason != ipc::FinishReason::NONE) {
+                        streams_.erase(it);
+                    }
+                }
+                if (stream->push(token)) {
+                    step_ready_.push_back(request_id);
+                }
+            }
+        };
+
+        uint64_t now_ns() {
+            return static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+    } // namespace
+
+    struct Engine::EngineImpl {
+        // Bounds how long an idle scheduler thread can miss a shutdown.
+        static constexpr std::chrono::milliseconds IDLE_WAIT{100};
+
+        std::unique_ptr<PageAllocator> allocator_;
+        Scheduler::SequenceQueue incoming_;
+        StreamSink sink_;
+        std::unique_ptr<Scheduler> scheduler_;
+
+        std::mutex submit_mutex_; // The hand-off queue has a single producer
+        std::atomic<uint64_t> next_request_id_{1};
+        bool running_ = false;    // Guarded by submit_mutex_
+
+        std::mutex cancel_mutex_; // Also guards the pending policy changes
+        std::vector<uint64_t> pending_cancels_;
+        std::vector<std::pair<uint32_t, TenantPolicy>> pending_policies_;
+        std::unique_ptr<IBatchPolicy> pending_batch_policy_;
+
+        std::atomic<bool> stop_requested_{false};
+        std::thread scheduler_thread_;
+
+        EngineImpl(const std::string& model_path, const EngineConfig& config)
+            : incoming_(config.queue_capacity)
+        {
+            std::unique_ptr<models::IModel> model = models::load_model(model_path);
+            allocator_ = std::make_unique<PageAllocator>(
+                config.num_kv_pages, model->get_num_kv_heads(), model->get_head_dim());
+            scheduler_ = std::make_unique<Scheduler>(
+                *allocator_, std::move(model), incoming_, &sink_,
+                config.max_num_seqs, config.max_tokens_in_batch);
+            scheduler_->set_batch_policy(BatchPolicyRegistry::create_policy(config.batch_policy));
+            scheduler_->set_target_step_time(std::chrono::microseconds(config.target_step_time_us));
+            scheduler_->set_decode_steps(config.decode_steps);
+            scheduler_->set_kv_watermark(config.kv_watermark);
+            scheduler_->set_predict_output_lengths(config.predict_output_lengths);
+        }
+
+        void apply_cancellations() {
+            std::vector<uint64_t> cancels;
+            std::vector<std::pair<uint32_t, TenantPolicy>> policies;
+            std::unique_ptr<IBatchPolicy> batch_policy;
+            {
+                std::lock_guard lock(cancel_mutex_);
+                cancels.swap(pending_cancels_);
+                policies.swap(pending_policies_);
+                batch_policy = std::move(pending_batch_policy_);
+            }
+            if (batch_policy) {
+                scheduler_->set_batch_policy(std::move(batch_policy));
+            }
+            for (const auto& [tenant_id, policy] : policies) {
+                scheduler_->set_tenant_policy(tenant_id, policy);
+            }
+            for (const uint64_t request_id : cancels) {
+                scheduler_->cancel(request_id);
+            }
+        }
+
+        void run() {
+            try {
+                while (!stop_requested_.load(std::memory_order_acquire)) {
+                    apply_cancellations();
+                    if (!scheduler_->step()) {
+                        scheduler_->wait_for_work(IDLE_WAIT);
+                    }
+                }
+            } catch (const std::exception& e) {
+                spdlog::error("Engine: scheduler thread failed: {}", e.what());
+                {
+                    std::lock_guard lock(submit_mutex_);
+                    running_ = false;
+                }
+                sink_.close_all(ipc::FinishReason::ERROR);
+            }
+        }
+    };
+
+    Engine::Engine(const std::string& model_path, EngineConfig config)
+        : pimpl_(std::make_unique<EngineImpl>(model_path, config))
+    {
+        pimpl_->running_ = true;
+        pimpl_->scheduler_thread_ = std::thread([impl = pimpl_.get()] { impl->run(); });
+        spdlog::info("Engine: running '{}' in-process with {} KV pages.", model_path, config.num_kv_pages);
+    }
+
+    Engine::~Engine() {
+        shutdown();
+    }
+
+    std::shared_ptr<TokenStream> Engine::submit(
+        std::span<const int32_t> prompt,
+        const sequence::SamplingParams& sampling_params,
+        sequence::LogitsParams logits_params,
+        sequence::StopCriteria stop_criteria,
+        const sequence::SchedulingParams& scheduling_params
+    ) {
+        const uint64_t request_id = pimpl_->next_request_id_.fetch_add(1, std::memory_order_relaxed);
+        return enqueue(std::make_shared<TokenStream>(request_id), prompt,
+                       sampling_params, std::move(logits_params), std::move(stop_criteria), scheduling_params);
+    }
+
+    std::shared_ptr<TokenStream> Engine::submit(
+        std::span<const int32_t> prompt,
+        TokenStream::Callback on_token,
+        const sequence::SamplingParams& sampling_params,
+        sequence::LogitsParams logits_params,
+        sequence::StopCriteria stop_criteria,
+        const sequence::SchedulingParams& scheduling_params
+    ) {
+        if (!on_token) {
+            throw std::invalid_argument("Engine: on_token must be callable.");
+        }
+        const uint64_t request_id = pimpl_->next_request_id_.fetch_add(1, std::memory_order_relaxed);
+        return enqueue(std::make_shared<TokenStream>(request_id, std::move(on_token)), prompt,
+                       sampling_params, std::move(logits_params), std::move(stop_criteria), scheduling_params);
+    }
+
+    std::shared_ptr<TokenStream> Engine::enqueue(
+        std::shared_ptr<TokenStream> stream,
+        std::span<const int32_t> prompt,
+        const sequence::SamplingParams& sampling_params,
+        sequence::LogitsParams logits_params,
+        sequence::StopCriteria stop_criteria,
+        const sequence::SchedulingParams& scheduling_params
+    ) {
+        if (prompt.empty()) {
+            throw std::invalid_argument("Engine: prompt must not be empty.");
+        }
+        const uint64_t request_id = stream->request_id();
+        auto sequence = std::make_unique<sequence::Sequence>(
+            request_id,
+            sequence::SequenceStatus::WAITING,
+            now_ns(),
+            sequence::Prompt(std::vector<int32_t>(prompt.begin(), prompt.end())),
+            sampling_params,
+            std::move(logits_params),
+            std::move(stop_criteria),
+            sequence::IPCHandles{},
+            scheduling_params
+        );
+
+        std::lock_guard lock(pimpl_->submit_mutex_);
+        if (!pimpl_->running_) {
+            throw std::runtime_error("Engine: not running.");
+        }
+        // Registered first: the scheduler may emit as soon as the push lands.
+        pimpl_->sink_.add(stream);
+        if (!pimpl_->incoming_.try_push(std::move(sequence))) {
+            pimpl_->sink_.remove(request_id);
+            return nullptr;
+        }
+        return stream;
+    }
+
+    void Engine::cancel(uint64_t request_id) {
+        {
+            std::lock_guard lock(pimpl_->cancel_mutex_);
+            pimpl_->pending_cancels_.push_back(request_id);
+        }
+        // Wake an idle scheduler so the cancellation lands this step.
+        pimpl_->incoming_.wake();
+    }
+
+    void Engine::set_tenant_policy(uint32_t tenant_id, const TenantPolicy& policy) {
+        FairShare::validate(policy); // Throw here, not on the scheduler thread
+        std::lock_guard lock(pimpl_->cancel_mutex_);
+        pimpl_->pending_policies_.emplace_back(tenant_id, policy);
+    }
+
+    void Engine::set_batch_policy(const std::string& policy_name) {
+        std::unique_ptr<IBatchPolicy> policy = BatchPolicyRegistry::create_policy(policy_name);
+        std::lock_guard lock(pimpl_->cancel_mutex_);
+        pimpl_->pending_batch_policy_ = std::move(policy); // The latest switch wins
+    }
+
+    int Engine::wakeup_fd() const noexcept {
+        return pimpl_->sink_.wakeup_fd();
+    }
+
+    std::vector<uint64_t> Engine::take_ready() {
+        return pimpl_->sink_.take_ready();
+    }
+
+    void Engine::shutdown() {
+        {
+            // After this no submit() can register a stream close_all() would miss.
+            std::lock_guard lock(pimpl_->submit_mutex_);
+            pimpl_->running_ = false;
+        }
+        pimpl_->stop_requested_.store(true, std::memory_order_release);
+        pimpl_->incoming_.wake();
+        if (pimpl_->scheduler_thread_.joinable()) {
+            pimpl_->scheduler_thread_.join();
+            pimpl_->sink_.close_all(ipc::FinishReason::CANCELLED);
+            spdlog::info("Engine: stopped.");
+        }
+    }
+
+} // namespace pie_core::engine
@@ -0,0 +1,124 @@
+#include "engine/fair_share.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace pie_core::engine {
+
+    namespace {
+
+        double bucket_depth(const TenantPolicy& policy) {
+            return policy.burst_tokens > 0.0 ? policy.burst_tokens : policy.tokens_per_second;
+        }
+
+    } // namespace
+
+    void FairShare::validate(const TenantPolicy& policy) {
+        if (!(policy.weight > 0.0) || policy.tokens_per_second < 0.0 || policy.burst_tokens < 0.0) {
+            throw std::invalid_argument("FairShare: weight must be positive and rates non-negative.");
+        }
+    }
+
+    void FairShare::set_policy(uint32_t tenant_id, const TenantPolicy& policy) {
+        validate(policy);
+        TenantState& tenant = state(tenant_id);
+        tenant.policy = policy;
+        tenant.has_policy = true;
+        tenant.bucket = bucket_depth(policy); // Start full
+    }
+
+    TenantPolicy FairShare::policy(uint32_t tenant_id) const {
+        const TenantState* tenant = find(tenant_id);
+        return tenant ? tenant->policy : TenantPolicy{};
+    }
+
+    void FairShare::add_work(uint32_t tenant_id) {
+        TenantState& tenant = state(tenant_id);
+        if (tenant.active_sequences++ > 0) {
+            return;
+        }
+        // Back from idle: catch up with the slowest active tenant.
+        double floor = std::numeric_limits<double>::max();
+        for (const auto& [id, other] : tenants_) {
+            if (other.active_sequences > 0 && id != tenant_id) {
+                floor = std::min(floor, other.virtual_time);
+            }
+        }
+        if (floor != std::numeric_limits<double>::max()) {
+            tenant.virtual_time = std::max(tenant.virtual_time, floor);
+        }
+    }
+
+    void FairShare::remove_work(uint32_t tenant_id) {
+        const auto it = tenants_.find(tenant_id);
+        if (it == tenants_.end() || it->second.active_sequences == 0) {
+            return;
+        }
+        if (--it->second.active_sequences == 0 && !it->second.has_policy) {
+            // Nothing to remember for an idle default tenant; keeps the map
+            // bounded however many tenant ids producers use.
+            tenants_.erase(it);
+        }
+    }
+
+    void FairShare::refill(uint64_t now_ns) {
+        if (last_refill_ns_ != 0 && now_ns > last_refill_ns_) {
+            const double elapsed_s = static_cast<double>(now_ns - last_refill_ns_) / 1e9;
+            for (auto& [id, tenant] : tenants_) {
+                if (tenant.policy.tokens_per_second > 0.0) {
+                    tenant.bucket = std::min(
+                        bucket_depth(tenant.policy), tenant.bucket + tenant.policy.tokens_per_second * elapsed_s);
+                }
+            }
+        }
+        last_refill_ns_ = now_ns;
+    }
+
+    void FairShare::charge(uint32_t tenant_id, size_t tokens) {
+        TenantState& tenant = state(tenant_id);
+        tenant.virtual_time += static_cast<double>(tokens) / tenant.policy.weight;
+        if (tenant.policy.tokens_per_second > 0.0) {
+            tenant.bucket -= static_cast<double>(tokens);
+        }
+    }
+
+    double FairShare::virtual_time(uint32_t tenant_id) const {
+        const TenantState* tenant = find(tenant_id);
+        return tenant ? tenant->virtual_time : 0.0;
+    }
+
+    double FairShare::weight(uint32_t tenant_id) const {
+        const TenantState* tenant = find(tenant_id);
+        return tenant ? tenant->policy.weight : TenantPolicy{}.weight;
+    }
+
+    bool FairShare::rate_limited(uint32_t tenant_id) const {
+        const TenantState* tenant = find(tenant_id);
+        return tenant && tenant->policy.tokens_per_second > 0.0 && tenant->bucket <= 0.0;
+    }
+
+    uint64_t FairShare::next_refill_ns() const {
+        uint64_t earliest = std::numeric_limits<uint64_t>::max();
+        for (const auto& [id, tenant] : tenants_) {
+            if (tenant.active_sequences == 0 || tenant.policy.tokens_per_second <= 0.0 || tenant.bucket > 0.0) {
+                continue;
+            }
+            // Just past the moment its bucket climbs back above zero.
+            const double wait_ns = -tenant.bucket / tenant.policy.tokens_per_second * 1e9;
+            earliest = std::min(earliest, last_refill_ns_ + static_cast<uint64_t>(std::ceil(wait_ns)) + 1);
+        }
+        return earliest;
+    }
+
+    FairShare::TenantState& FairShare::state(uint32_t tenant_id) {
+        return tenants_[tenant_id];
+    }
+
+    const FairShare::TenantState* FairShare::find(uint32_t tenant_id) const {
+        const auto it = tenants_.find(tenant_id);
+        return it == tenants_.end() ? nullptr : &it->second;
+    }
+
+} // namespace pie_core::engine
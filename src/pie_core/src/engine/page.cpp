@@ -0,0 +1,57 @@
+#include "engine/page.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace pie_core::engine {
+
+    namespace {
+
+        // Evaluates `storage` into a row-contiguous buffer of its own so it can
+        // be written in place; a fresh page is still a broadcast zero.
+        void materialize(mx::array& storage) {
+            mx::eval(storage);
+            if (!storage.flags().row_contiguous || storage.data_size() != storage.size()) {
+                storage = mx::contiguous(storage);
+                mx::eval(storage);
+            }
+        }
+
+        void check_layout(const mx::array& tokens, const mx::array& storage, const char* name) {
+            if (tokens.ndim() != 3 || tokens.shape(1) != storage.shape(1) || tokens.shape(2) != storage.shape(2)
+                || tokens.dtype() != storage.dtype()) {
+                throw std::invalid_argument(
+                    std::string("KVPage: ") + name + " must be [count, num_heads, head_dim] in the cache dtype.");
+            }
+        }
+
+    } // namespace
+
+    void KVPage::write_tokens(size_t slot, const mx::array& keys, const mx::array& values) {
+        check_layout(keys, key_cache_, "keys");
+        check_layout(values, value_cache_, "values");
+        const auto count = static_cast<size_t>(keys.shape(0));
+        if (values.shape(0) != keys.shape(0)) {
+            throw std::invalid_argument("KVPage: keys and values must hold the same number of tokens.");
+        }
+        if (slot > TOKEN_CAPACITY_PER_PAGE || count > TOKEN_CAPACITY_PER_PAGE - slot) {
+            throw std::out_of_range("KVPage: write past the end of the page.");
+        }
+        if (count == 0) {
+            return;
+        }
+
+        const mx::array new_keys = mx::contiguous(keys);
+        const mx::array new_values = mx::contiguous(values);
+        mx::eval(std::vector<mx::array>{new_keys, new_values});
+        materialize(key_cache_);
+        materialize(value_cache_);
+
+        const size_t token_bytes = static_cast<size_t>(num_heads_) * static_cast<size_t>(head_dim_) * key_cache_.itemsize();
+        std::memcpy(key_cache_.data<char>() + slot * token_bytes, new_keys.data<char>(), count * token_bytes);
+        std::memcpy(value_cache_.data<char>() + slot * token_bytes, new_values.data<char>(), count * token_bytes);
+    }
+
+} // namespace pie_core::engine
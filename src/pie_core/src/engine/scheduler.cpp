@@ -1,17 +1,27 @@
 #include <deque>
 #include <vector>
-#include <list>
-#include <unordered_map>
-#include <mutex>
+#include <iterator>
+#include <algorithm>
+#include <array>
+#include <limits>
 #include <random>
 #include <chrono>
 #include <spdlog/spdlog.h>
 
 #include "engine/scheduler.hpp"
+#include "engine/admission_controller.hpp"
+#include "engine/batch_policy.hpp"
+#include "engine/budget_controller.hpp"
+#include "engine/fair_share.hpp"
+#include "engine/page.hpp"
 #include "engine/page_allocator.hpp"
+#include "engine/slot_table.hpp"
 #include "models/imodel.hpp"
 #include "sequence/sequence.hpp"
 #include "engine/batch_details.hpp"
+#include "engine/block_table.hpp"
+#include "engine/token_sink.hpp"
+#include "ipc/ipc_request.hpp"
 #include "samplers/sampler_factory.hpp"
 #include "logit_processors/logit_processor_factory.hpp"
 
@@ -19,11 +29,1160 @@ namespace mx = mlx::core;
 
 namespace pie_core::engine {
 
+    namespace {
+
+        // Per-sequence state that only the scheduler needs.
+        struct RunningSequence {
+            std::unique_ptr<sequence::Sequence> sequence;
+            std::unique_ptr<samplers::ISampler> sampler;
+            std::vector<std::unique_ptr<logit_processors::ILogitProcessor>> processors;
+            std::mt19937 rng;
+            uint32_t slot = 0;      // Its hot state in the SlotTable, and its block table row
+            bool preempted = false; // Pages and slot given back; requeued after this step's scheduling
+            bool in_flight = false; // Part of the launched, unresolved step: keep it and its pages
+
+            // This step's scheduling state.
+            static constexpr size_t NOT_SCHEDULED = SIZE_MAX;
+            size_t scheduled_slot = NOT_SCHEDULED; // Index of its chunk in `scheduled_`
+            bool blocked = false;                  // Out of KV pages
+        };
+
+        // One sequence's slice of the current step.
+        struct ScheduledChunk {
+            RunningSequence* running;
+            size_t start;
+            size_t length;
+            bool samples; // Chunk reaches the end of the sequence: sample a token
+        };
+
+        // A launched step whose sampled tokens haven't been read back yet.
+        struct InFlightStep {
+            bool active = false;
+            std::vector<ScheduledChunk> chunks;
+            std::vector<mx::array> next_tokens;
+            std::vector<mx::array> logprobs; // Of each of next_tokens
+            std::vector<RunningSequence*> sampled;
+            std::chrono::steady_clock::time_point started_at;
+            size_t num_tokens = 0;
+            bool had_decodes = false;
+            size_t num_steps = 1; // > 1 for a multi-step decode run; next_tokens is step-major
+        };
+
+        // The sampled token's log-probability under the processed logits.
+        mx::array token_logprob(const mx::array& row, const mx::array& token) {
+            return mx::take(row, token, 0) - mx::logsumexp(row, 0);
+        }
+
+        ipc::FinishReason finish_reason_for(const sequence::Sequence& sequence) {
+            if (sequence.status == sequence::SequenceStatus::ERROR) {
+                return ipc::FinishReason::ERROR;
+            }
+            if (sequence.cancelled.load(std::memory_order_acquire)) {
+                return ipc::FinishReason::CANCELLED;
+            }
+            if (sequence.get_generation_len() >= static_cast<size_t>(sequence.stop_criteria.max_generated_tokens)) {
+                return ipc::FinishReason::LENGTH;
+            }
+            return ipc::FinishReason::STOP;
+        }
+
+        uint64_t now_ns() {
+            return static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        bool is_batch(const sequence::Sequence& sequence) {
+            return sequence.scheduling_params.priority == sequence::Priority::BATCH;
+        }
+
+        uint32_t tenant_of(const sequence::Sequence& sequence) {
+            return sequence.scheduling_params.tenant_id;
+        }
+
+        size_t max_generated(const sequence::Sequence& sequence) {
+            return static_cast<size_t>(std::max(sequence.stop_criteria.max_generated_tokens, 0));
+        }
+
+    } // namespace
+
     struct Scheduler::SchedulerImpl {
         PageAllocator& allocator_;
-        std::unique_ptr<IModel> model_;
+        std::unique_ptr<models::IModel> model_;
+        SequenceQueue& incoming_;
+        ITokenSink* token_sink_;
         const size_t max_num_seqs_;
         const size_t max_tokens_in_batch_;
+
+        std::deque<std::unique_ptr<sequence::Sequence>> waiting_;
+        std::vector<std::unique_ptr<RunningSequence>> running_;
+
+        // Reused across steps.
+        std::vector<ScheduledChunk> scheduled_;
+        std::vector<TokenChunk> chunks_;
+
+        // --- Pipelining ---
+        // At most one step evaluates on the device while the host prepares the
+        // next: queue intake, retiring, ordering, admission, the next decode
+        // tokens' KV pages and, when it can be predicted, the next step's
+        // layout all run before the scheduler blocks on the launched step's
+        // sampled tokens.
+        InFlightStep in_flight_{};
+        std::unique_ptr<BatchDetailsBuilder> batch_builder_ =
+            std::make_unique<BatchDetailsBuilder>(max_num_seqs_, max_tokens_in_batch_);
+        std::vector<TokenChunk> predicted_chunks_{}; // The step after the one in flight, if it only decodes
+        std::vector<uint32_t> predicted_slots_{};
+
+        // --- Slots ---
+        // Each running sequence holds a slot: its hot per-step state in
+        // slots_, and its row of the persistent block table, patched as pages
+        // are reserved so a step only lists its sequences' rows.
+        SlotTable slots_{max_num_seqs_};
+        BlockTableLayout block_table_layout_ = BlockTableLayout::PERSISTENT;
+        std::unique_ptr<PersistentBlockTable> block_table_ =
+            std::make_unique<PersistentBlockTable>(max_num_seqs_);
+        std::vector<uint32_t> chunk_slots_{};    // Per chunk of the step being built
+        std::vector<int32_t> decode_token_ids_{}; // Reused by launch_decode_run()
+
+        // --- Multi-step decode ---
+        // A steady decode batch may run this many steps per launch, feeding
+        // each step's sampled tokens to the next on the device.
+        size_t decode_steps_ = 1;
+
+        // --- Load publishing & admission signalling ---
+        // Start shedding when the KV pool is nearly exhausted and work is queueing,
+        // or when a new request would wait too long for its first token. Accept
+        // again only once the pool has recovered well past the trigger.
+        static constexpr double REJECT_BELOW_FREE_PAGE_FRACTION = 0.02;
+        static constexpr double ACCEPT_ABOVE_FREE_PAGE_FRACTION = 0.05;
+        static constexpr std::chrono::microseconds MAX_ACCEPTED_TTFT{std::chrono::seconds(30)};
+
+        // Sequences are only admitted when the pool can carry them (and
+        // everything already running) through to the end of generation.
+        AdmissionController admission_{allocator_.size(), TOKEN_CAPACITY_PER_PAGE};
+
+        ipc::EngineLoad* load_ = nullptr;
+        bool rejecting_ = false;
+        double step_time_us_ = 0.0; // EWMA of non-idle step durations
+
+        // --- Step-time feedback ---
+        // Sizes the token budget (at most max_tokens_in_batch_) to a target step time.
+        BudgetController budget_controller_{max_tokens_in_batch_};
+        bool step_had_decodes_ = false;
+
+        // --- Priorities & deadlines ---
+        // Work is served by priority class, then by latest start time (deadline
+        // minus its own estimated prefill time), then in arrival order. A
+        // deadline sequence is at risk once its slack drops below a few steps;
+        // batch prefills then pause, and give up their slots and pages to it.
+        static constexpr double AT_RISK_SLACK_STEPS = 4.0;
+
+        bool waiting_sorted_ = true;
+        std::vector<RunningSequence*> prefill_order_{}; // Reused across steps
+
+        // --- Tenant fair share ---
+        // Within a priority class, the backlogged tenant with the lowest virtual
+        // time is served next: its queued sequences are admitted first and it
+        // gets the next quantum of prefill budget.
+        static constexpr size_t FAIR_SHARE_QUANTUM_TOKENS = 256;
+
+        FairShare fair_share_{};
+        // The last step had work but could run none of it (rate limits, no
+        // pages); wait_for_work() then sleeps instead of spinning on step().
+        bool stalled_ = false;
+        static constexpr std::chrono::milliseconds MAX_STALLED_WAIT{10};
+        std::unique_ptr<IBatchPolicy> batch_policy_ = BatchPolicyRegistry::create_policy("hybrid");
+        std::vector<std::pair<double, std::unique_ptr<sequence::Sequence>>> fair_order_{}; // Reused
+        std::unordered_map<uint32_t, size_t> tenant_queued_tokens_{};                     // Reused
+
+        // Estimated time until a sequence's first token if `tokens_ahead` prefill
+        // tokens are served before its own `remaining` ones.
+        uint64_t estimated_first_token_ns(size_t tokens_ahead, size_t remaining) const {
+            const size_t budget = budget_controller_.token_budget();
+            const size_t steps = std::max<size_t>(1, (tokens_ahead + remaining + budget - 1) / budget);
+            return static_cast<uint64_t>(step_time_us_ * 1000.0 * static_cast<double>(steps));
+        }
+
+        // Latest time the sequence can start its remaining prefill and still meet
+        // its deadline; UINT64_MAX without one.
+        uint64_t latest_start_ns(const sequence::Sequence& sequence, size_t num_computed_tokens) const {
+            if (sequence.deadline_ns == 0) {
+                return std::numeric_limits<uint64_t>::max();
+            }
+            const uint64_t needed = estimated_first_token_ns(0, sequence.prompt_len - std::min(sequence.prompt_len, num_computed_tokens));
+            return sequence.deadline_ns > needed ? sequence.deadline_ns - needed : 0;
+        }
+
+        bool more_urgent(const sequence::Sequence& a, size_t a_computed, const sequence::Sequence& b, size_t b_computed) const {
+            if (a.scheduling_params.priority != b.scheduling_params.priority) {
+                return a.scheduling_params.priority < b.scheduling_params.priority;
+            }
+            const uint64_t a_start = latest_start_ns(a, a_computed);
+            const uint64_t b_start = latest_start_ns(b, b_computed);
+            if (a_start != b_start) {
+                return a_start < b_start;
+            }
+            return a.arrival_timestamp_ns < b.arrival_timestamp_ns;
+        }
+
+        bool at_risk(const sequence::Sequence& sequence, size_t num_computed_tokens, uint64_t now) const {
+            if (sequence.deadline_ns == 0 || is_batch(sequence) || step_time_us_ == 0.0) {
+                return false;
+            }
+            const auto slack_margin = static_cast<uint64_t>(step_time_us_ * 1000.0 * AT_RISK_SLACK_STEPS);
+            return latest_start_ns(sequence, num_computed_tokens) < now + slack_margin;
+        }
+
+        // --- Step phases ---
+
+        void drain_incoming() {
+            // Everything the IPC reader handed over since the last step, in one pop.
+            const size_t first_new = waiting_.size();
+            if (incoming_.pop_batch(std::back_inserter(waiting_)) == 0) {
+                return;
+            }
+            waiting_sorted_ = false;
+            // A sequence needing more pages than the pool has would stall on
+            // them forever: generation limits are capped to the pool, and a
+            // prompt that fills it alone is refused.
+            const size_t pool_tokens = allocator_.size() * TOKEN_CAPACITY_PER_PAGE;
+            for (size_t i = first_new; i < waiting_.size();) {
+                sequence::Sequence& sequence = *waiting_[i];
+                if (sequence.status == sequence::SequenceStatus::ERROR) {
+                    // Refused by the IPC reader (malformed request): answer it.
+                    if (token_sink_) {
+                        token_sink_->finish(sequence, ipc::FinishReason::ERROR);
+                    }
+                    waiting_.erase(waiting_.begin() + static_cast<std::ptrdiff_t>(i));
+                    continue;
+                }
+                if (sequence.prompt_len >= pool_tokens) {
+                    spdlog::warn("Scheduler: refusing sequence {}; its {}-token prompt doesn't fit in the KV pool.",
+                                 sequence.sequence_id, sequence.prompt_len);
+                    sequence.status = sequence::SequenceStatus::ERROR;
+                    if (token_sink_) {
+                        token_sink_->finish(sequence, ipc::FinishReason::ERROR);
+                    }
+                    waiting_.erase(waiting_.begin() + static_cast<std::ptrdiff_t>(i));
+                    continue;
+                }
+                sequence.cap_generation(pool_tokens - sequence.prompt_len);
+                fair_share_.add_work(tenant_of(sequence));
+                ++i;
+            }
+        }
+
+        void finish_waiting(const sequence::Sequence& sequence, ipc::FinishReason finish_reason) {
+            fair_share_.remove_work(tenant_of(sequence));
+            if (token_sink_) {
+                token_sink_->finish(sequence, finish_reason);
+            }
+        }
+
+        // Orders the (urgency-sorted) queue fairly across tenants: each sequence
+        // starts at its tenant's virtual time plus the tokens queued ahead of it
+        // for the same tenant, over the tenant's weight.
+        void interleave_tenants() {
+            fair_order_.clear();
+            tenant_queued_tokens_.clear();
+            for (auto& sequence : waiting_) {
+                const uint32_t tenant = tenant_of(*sequence);
+                size_t& queued = tenant_queued_tokens_[tenant];
+                const double start = fair_share_.virtual_time(tenant) + static_cast<double>(queued) / fair_share_.weight(tenant);
+                queued += sequence->prompt_len;
+                fair_order_.emplace_back(start, std::move(sequence));
+            }
+            std::stable_sort(fair_order_.begin(), fair_order_.end(), [](const auto& a, const auto& b) {
+                if (a.second->scheduling_params.priority != b.second->scheduling_params.priority) {
+                    return a.second->scheduling_params.priority < b.second->scheduling_params.priority;
+                }
+                return a.first < b.first;
+            });
+            for (size_t i = 0; i < fair_order_.size(); ++i) {
+                waiting_[i] = std::move(fair_order_[i].second);
+            }
+            fair_order_.clear();
+        }
+
+        // Puts the queue in service order and sheds what can no longer make its
+        // deadline, counting the prefill work queued ahead of it. Shedding
+        // before prefill means a doomed request never costs GPU time.
+        void order_waiting() {
+            if (waiting_.empty()) {
+                return;
+            }
+            // Tenant virtual times move every step, so with several tenants the
+            // fair interleaving is redone each time.
+            if (!waiting_sorted_ || fair_share_.num_tenants() > 1) {
+                std::stable_sort(waiting_.begin(), waiting_.end(), [this](const auto& a, const auto& b) {
+                    return more_urgent(*a, 0, *b, 0);
+                });
+                interleave_tenants();
+                waiting_sorted_ = true;
+            }
+            if (step_time_us_ == 0.0) {
+                return; // No step-time estimate yet
+            }
+
+            // Running prefills only count against sequences of the same or a
+            // lower class; higher classes preempt them.
+            const std::array<size_t, 3> running_prefill_tokens = slots_.pending_prefill_tokens();
+            const uint64_t now = now_ns();
+            size_t queued_ahead = 0;
+            std::erase_if(waiting_, [&](const std::unique_ptr<sequence::Sequence>& sequence) {
+                const auto priority = static_cast<size_t>(sequence->scheduling_params.priority);
+                size_t tokens_ahead = queued_ahead;
+                for (size_t p = 0; p <= priority; ++p) {
+                    tokens_ahead += running_prefill_tokens[p];
+                }
+                if (sequence->deadline_ns != 0 && sequence->get_generation_len() == 0
+                    && now + estimated_first_token_ns(tokens_ahead, sequence->prompt_len) > sequence->deadline_ns) {
+                    spdlog::debug("Scheduler: shedding sequence {}; its deadline can't be met.", sequence->sequence_id);
+                    finish_waiting(*sequence, ipc::FinishReason::DEADLINE);
+                    return true;
+                }
+                queued_ahead += sequence->prompt_len;
+                return false;
+            });
+        }
+
+        // Gives a sequence's pages back and sends it to the queue; its tokens
+        // so far are prefilled again on readmission. Only sequences whose
+        // prompt is intact can be preempted.
+        void preempt(RunningSequence& running) {
+            sequence::Sequence& sequence = *running.sequence;
+            for (const uint32_t page_id : sequence.page_table) {
+                allocator_.free_page(page_id);
+            }
+            sequence.page_table.clear();
+            block_table_->clear_row(running.slot);
+            slots_.release(running.slot);
+            running.preempted = true;
+            spdlog::debug("Scheduler: preempted sequence {}.", sequence.sequence_id);
+        }
+
+        // Cheapest batch prefill to preempt (least work done), if any.
+        RunningSequence* preemption_victim() {
+            RunningSequence* victim = nullptr;
+            for (const auto& running : running_) {
+                if (!running->preempted && !running->in_flight && is_batch(*running->sequence)
+                    && running->scheduled_slot == RunningSequence::NOT_SCHEDULED
+                    && slots_.state(running->slot) == SlotState::PREFILLING
+                    && (!victim || computed(*running) < computed(*victim))) {
+                    victim = running.get();
+                }
+            }
+            return victim;
+        }
+
+        // With predicted output lengths, running sequences can outgrow their
+        // charge and fill the pool between them. Then the least urgent one
+        // (lowest class, latest arrival) gives its pages back to the rest.
+        RunningSequence* recompute_victim() {
+            RunningSequence* victim = nullptr;
+            for (const auto& running : running_) {
+                const sequence::Sequence& sequence = *running->sequence;
+                if (running->preempted || running->in_flight || sequence.released_prompt_prefix() > 0) {
+                    continue;
+                }
+                if (!victim) {
+                    victim = running.get();
+                    continue;
+                }
+                const sequence::Sequence& current = *victim->sequence;
+                if (sequence.scheduling_params.priority != current.scheduling_params.priority
+                        ? sequence.scheduling_params.priority > current.scheduling_params.priority
+                        : sequence.arrival_timestamp_ns > current.arrival_timestamp_ns) {
+                    victim = running.get();
+                }
+            }
+            return victim;
+        }
+
+        void requeue_preempted() {
+            std::erase_if(running_, [this](std::unique_ptr<RunningSequence>& running) {
+                if (!running->preempted) {
+                    return false;
+                }
+                running->sequence->status = sequence::SequenceStatus::WAITING;
+                waiting_.push_back(std::move(running->sequence));
+                waiting_sorted_ = false;
+                return true;
+            });
+        }
+
+        // Cancelled through the engine, or by its client through the sink's
+        // cancel word; the latter is recorded on the sequence too.
+        bool cancel_requested(sequence::Sequence& sequence) const {
+            if (sequence.cancelled.load(std::memory_order_acquire)) {
+                return true;
+            }
+            const std::atomic<uint32_t>* word = token_sink_ ? token_sink_->cancel_word(sequence) : nullptr;
+            if (word && word->load(std::memory_order_acquire) != 0) {
+                sequence.cancelled.store(true, std::memory_order_release);
+                return true;
+            }
+            return false;
+        }
+
+        // Picks up clients' cancel words, so cancelled sequences are left out
+        // of the next batch and retired (their pages freed) as soon as no
+        // launched step uses them. Queued ones are answered right away: the
+        // whole queue is swept, since admission may stop short of them for
+        // many steps while they hold their bulk lease and response channel.
+        void poll_cancellations() {
+            std::erase_if(waiting_, [this](const std::unique_ptr<sequence::Sequence>& sequence) {
+                if (!cancel_requested(*sequence)) {
+                    return false;
+                }
+                finish_waiting(*sequence, ipc::FinishReason::CANCELLED);
+                return true;
+            });
+            if (slots_.poll_cancellations() == 0) {
+                return;
+            }
+            for (const auto& running : running_) {
+                if (slots_.cancelled(running->slot)) {
+                    running->sequence->cancelled.store(true, std::memory_order_release);
+                }
+            }
+        }
+
+        void admit_waiting() {
+            const uint64_t now = now_ns();
+            size_t outstanding_pages = slots_.outstanding_pages();
+            // Indices, not iterators: requeue_preempted() appends to the queue.
+            for (size_t i = 0; i < waiting_.size();) {
+                // Cancelled ones were answered by poll_cancellations(), which
+                // runs ahead of every admission.
+                sequence::Sequence& candidate = *waiting_[i];
+                if (fair_share_.rate_limited(tenant_of(candidate))) {
+                    // Over its rate: other tenants' sequences go ahead.
+                    ++i;
+                    continue;
+                }
+                const size_t max_new_tokens =
+                    max_generated(candidate) - std::min(max_generated(candidate), candidate.get_generation_len());
+                const size_t charged_pages = admission_.pages_needed(candidate.get_logical_len(), max_new_tokens);
+                if (!running_.empty()
+                    && !admission_.admits(allocator_.get_num_free_pages(), outstanding_pages, charged_pages)) {
+                    // Its pages might run out mid-generation: wait for running
+                    // sequences to finish instead.
+                    break;
+                }
+                if (running_.size() >= max_num_seqs_) {
+                    // Full: an at-risk request may take a batch prefill's slot.
+                    RunningSequence* victim = at_risk(candidate, 0, now) ? preemption_victim() : nullptr;
+                    if (!victim) {
+                        break;
+                    }
+                    preempt(*victim);
+                    requeue_preempted();
+                    outstanding_pages = slots_.outstanding_pages();
+                }
+
+                auto running = std::make_unique<RunningSequence>();
+                running->sequence = std::move(waiting_[i]);
+                waiting_.erase(waiting_.begin() + static_cast<std::ptrdiff_t>(i));
+
+                const sequence::Sequence& sequence = *running->sequence;
+                running->sampler = samplers::create_sampler(sequence.sampling_params);
+                running->processors = logit_processors::create_processors(sequence.logits_params);
+                running->rng.seed(sequence.sampling_params.rng_seed != 0
+                    ? sequence.sampling_params.rng_seed
+                    : static_cast<uint32_t>(sequence.sequence_id));
+                // running_ never exceeds max_num_seqs_, the number of slots.
+                running->slot = slots_.acquire().value();
+                slots_.load(running->slot, sequence.scheduling_params.priority, sequence.get_logical_len(),
+                            sequence.get_logical_len() > 0 ? sequence.last_token() : 0, max_new_tokens,
+                            token_sink_ ? token_sink_->cancel_word(sequence) : nullptr);
+                slots_.set_charged_pages(running->slot, charged_pages);
+                outstanding_pages += charged_pages;
+                running->sequence->status = sequence::SequenceStatus::PREFILLING;
+                running_.push_back(std::move(running));
+            }
+        }
+
+        // Makes sure `running` has pages for its first `num_tokens` tokens, and
+        // patches the new ones (even on failure) into its block table row.
+        bool reserve_pages(RunningSequence& running, size_t num_tokens) {
+            const size_t pages_needed = (num_tokens + TOKEN_CAPACITY_PER_PAGE - 1) / TOKEN_CAPACITY_PER_PAGE;
+            if (slots_.num_pages(running.slot) >= pages_needed) {
+                return true;
+            }
+            sequence::Sequence& sequence = *running.sequence;
+            bool reserved = true;
+            while (sequence.page_table.size() < pages_needed) {
+                const std::optional<uint32_t> page = allocator_.allocate_page();
+                if (!page) {
+                    reserved = false;
+                    break;
+                }
+                sequence.append_page(*page);
+            }
+            block_table_->sync_row(running.slot, sequence.page_table);
+            slots_.set_num_pages(running.slot, sequence.page_table.size());
+            return reserved;
+        }
+
+        [[nodiscard]] size_t computed(const RunningSequence& running) const {
+            return slots_.computed(running.slot);
+        }
+
+        [[nodiscard]] size_t unscheduled_tokens(const RunningSequence& running) const {
+            const size_t scheduled = running.scheduled_slot == RunningSequence::NOT_SCHEDULED
+                ? 0 : scheduled_[running.scheduled_slot].length;
+            return slots_.logical_len(running.slot) - computed(running) - scheduled;
+        }
+
+        // Schedules up to `max_length` more tokens of `running` this step,
+        // extending its chunk if it already has one, and charges them to its
+        // tenant. Returns the tokens added; 0 if its pages can't be reserved.
+        size_t schedule_tokens(RunningSequence& running, size_t max_length) {
+            const size_t length = std::min(unscheduled_tokens(running), max_length);
+            if (length == 0) {
+                return 0;
+            }
+            const bool has_chunk = running.scheduled_slot != RunningSequence::NOT_SCHEDULED;
+            const size_t logical_len = slots_.logical_len(running.slot);
+            const size_t chunk_end = logical_len - unscheduled_tokens(running) + length;
+            if (!reserve_pages(running, chunk_end)) {
+                running.blocked = true;
+                return 0;
+            }
+            if (!has_chunk) {
+                running.scheduled_slot = scheduled_.size();
+                scheduled_.push_back({&running, computed(running), 0, false});
+            }
+            ScheduledChunk& chunk = scheduled_[running.scheduled_slot];
+            chunk.length += length;
+            chunk.samples = chunk_end == logical_len;
+            fair_share_.charge(tenant_of(*running.sequence), length);
+            return length;
+        }
+
+        // Next prefill to give budget to: the first class with work, then the
+        // tenant with the lowest virtual time, then its most urgent sequence.
+        RunningSequence* next_prefill() const {
+            RunningSequence* pick = nullptr;
+            for (RunningSequence* running : prefill_order_) {
+                const sequence::Sequence& sequence = *running->sequence;
+                if (pick && sequence.scheduling_params.priority != pick->sequence->scheduling_params.priority) {
+                    break; // prefill_order_ is sorted by class
+                }
+                if (running->preempted || running->blocked || unscheduled_tokens(*running) == 0
+                    || fair_share_.rate_limited(tenant_of(sequence))) {
+                    continue;
+                }
+                if (!pick || fair_share_.virtual_time(tenant_of(sequence)) < fair_share_.virtual_time(tenant_of(*pick->sequence))) {
+                    pick = running;
+                }
+            }
+            return pick;
+        }
+
+        void schedule_batch() {
+            plan_batch();
+            // Nothing could go for want of pages: preempt until something can.
+            // A sequence alone always fits (see drain_incoming()).
+            while (scheduled_.empty() && running_.size() > 1
+                   && std::any_of(running_.begin(), running_.end(), [](const auto& running) { return running->blocked; })) {
+                RunningSequence* victim = recompute_victim();
+                if (!victim) {
+                    break;
+                }
+                preempt(*victim);
+                requeue_preempted();
+                plan_batch();
+            }
+        }
+
+        void plan_batch() {
+            scheduled_.clear();
+            step_had_decodes_ = false;
+
+            for (auto& running : running_) {
+                running->scheduled_slot = RunningSequence::NOT_SCHEDULED;
+                running->blocked = false;
+            }
+            BatchState state{};
+            state.num_decoding = slots_.count(SlotState::DECODING);
+            state.num_prefilling = slots_.count(SlotState::PREFILLING);
+            for (const size_t tokens : slots_.pending_prefill_tokens()) {
+                state.pending_prefill_tokens += tokens;
+            }
+            // Every decode gets its token even when the controller asks for less.
+            size_t budget = std::min(std::max(budget_controller_.token_budget(), state.num_decoding), max_tokens_in_batch_);
+            state.token_budget = budget;
+            const BatchMix mix = batch_policy_->plan(state);
+
+            // Decodes first (one token each, latency-sensitive).
+            size_t decode_budget = std::min(budget, mix.max_decode_tokens);
+            for (auto& running : running_) {
+                if (slots_.state(running->slot) == SlotState::DECODING && decode_budget > 0) {
+                    // Out of KV pages: the sequence sits this step out.
+                    const size_t added = schedule_tokens(*running, decode_budget);
+                    decode_budget -= added;
+                    budget -= added;
+                    step_had_decodes_ = step_had_decodes_ || added > 0;
+                }
+            }
+            budget = std::min(budget, mix.max_prefill_tokens);
+
+            // Then prefill chunks, most urgent first.
+            prefill_order_.clear();
+            for (auto& running : running_) {
+                if (slots_.state(running->slot) == SlotState::PREFILLING) {
+                    prefill_order_.push_back(running.get());
+                }
+            }
+            std::stable_sort(prefill_order_.begin(), prefill_order_.end(), [this](const RunningSequence* a, const RunningSequence* b) {
+                return more_urgent(*a->sequence, computed(*a), *b->sequence, computed(*b));
+            });
+
+            const uint64_t now = now_ns();
+            bool urgent_work = std::any_of(waiting_.begin(), waiting_.end(), [&](const auto& sequence) {
+                return at_risk(*sequence, 0, now);
+            });
+            // Budget goes out a quantum at a time, so tenants interleave within a step.
+            while (budget > 0) {
+                RunningSequence* running = next_prefill();
+                if (!running) {
+                    break;
+                }
+                const bool urgent = at_risk(*running->sequence, computed(*running), now);
+                urgent_work = urgent_work || urgent;
+                if (urgent_work && is_batch(*running->sequence)) {
+                    // Keep the step short while interactive deadlines are at risk.
+                    break;
+                }
+                size_t added = schedule_tokens(*running, std::min(budget, FAIR_SHARE_QUANTUM_TOKENS));
+                while (added == 0 && urgent) {
+                    // Out of KV pages: an at-risk sequence takes them from batch prefills.
+                    RunningSequence* victim = preemption_victim();
+                    if (!victim) {
+                        break;
+                    }
+                    preempt(*victim);
+                    running->blocked = false;
+                    added = schedule_tokens(*running, std::min(budget, FAIR_SHARE_QUANTUM_TOKENS));
+                }
+                budget -= added;
+            }
+            requeue_preempted();
+        }
+
+        // DENSE and CSR ignore the table and rows.
+        [[nodiscard]] BlockTableSpec block_table_spec() {
+            return {.layout = block_table_layout_, .table = block_table_.get(), .rows = chunk_slots_};
+        }
+
+        // Builds the step's graph (forward, logit processors, sampling) and
+        // starts evaluating it without waiting; finish_in_flight() collects it.
+        void launch_batch(std::chrono::steady_clock::time_point step_start) {
+            chunks_.clear();
+            chunk_slots_.clear();
+            for (const auto& scheduled : scheduled_) {
+                chunks_.push_back({scheduled.running->sequence.get(), scheduled.start, scheduled.length});
+                chunk_slots_.push_back(scheduled.running->slot);
+            }
+            const BatchDetails& batch_details = batch_builder_->build(chunks_, block_table_spec());
+
+            mx::array logits = model_->forward(batch_details);
+            logits = mx::reshape(logits, {static_cast<int32_t>(batch_details.total_tokens_in_step), -1});
+
+            // Sample every sequence whose chunk reached its last token; one eval for all.
+            std::vector<mx::array>& next_tokens = in_flight_.next_tokens;
+            std::vector<mx::array>& logprobs = in_flight_.logprobs;
+            std::vector<RunningSequence*>& sampled = in_flight_.sampled;
+            next_tokens.clear();
+            logprobs.clear();
+            sampled.clear();
+            size_t row_end = 0;
+            for (const auto& scheduled : scheduled_) {
+                row_end += scheduled.length;
+                if (!scheduled.samples) {
+                    continue;
+                }
+                RunningSequence& running = *scheduled.running;
+                const sequence::Sequence& sequence = *running.sequence;
+                mx::array row = mx::take(logits, mx::array(static_cast<int32_t>(row_end - 1)), 0);
+                for (auto& processor : running.processors) {
+                    row = processor->process_logits(row, sequence.logits_params, sequence);
+                }
+                next_tokens.push_back(running.sampler->next_token(row, sequence.sampling_params, running.rng));
+                logprobs.push_back(token_logprob(row, next_tokens.back()));
+                sampled.push_back(&running);
+            }
+            if (next_tokens.empty()) {
+                // Mid-prompt chunks only: still run the forward pass for its KV writes.
+                mx::async_eval({logits});
+            } else {
+                std::vector<mx::array> outputs = next_tokens;
+                outputs.insert(outputs.end(), logprobs.begin(), logprobs.end());
+                mx::async_eval(outputs);
+            }
+
+            mark_in_flight(step_start, 1);
+        }
+
+        void mark_in_flight(std::chrono::steady_clock::time_point step_start, size_t num_steps) {
+            in_flight_.num_tokens = 0;
+            for (const auto& scheduled : scheduled_) {
+                scheduled.running->in_flight = true;
+                in_flight_.num_tokens += scheduled.length;
+            }
+            in_flight_.chunks.swap(scheduled_);
+            in_flight_.started_at = step_start;
+            in_flight_.had_decodes = step_had_decodes_;
+            in_flight_.num_steps = num_steps;
+            in_flight_.active = true;
+        }
+
+        // Steps the running batch can decode back to back: more than one only
+        // when nothing waits for admission or prefill and every sequence can
+        // take them all (no logit processors reading the host-side history, no
+        // length limit inside the run, KV pages for every step reserved here).
+        size_t prepare_decode_run() {
+            if (decode_steps_ <= 1 || running_.empty() || !waiting_.empty() || incoming_.size_approx() > 0
+                || running_.size() > budget_controller_.token_budget()) {
+                return 1;
+            }
+            const size_t steps = std::min(decode_steps_, slots_.min_remaining());
+            if (steps <= 1 || slots_.count(SlotState::DECODING) != running_.size()) {
+                return 1;
+            }
+            for (const auto& running : running_) {
+                const sequence::Sequence& sequence = *running->sequence;
+                if (!running->processors.empty() || slots_.cancelled(running->slot)
+                    || fair_share_.rate_limited(tenant_of(sequence))) {
+                    return 1;
+                }
+            }
+            for (const auto& running : running_) {
+                // Step j computes the token at logical_len - 1 + j.
+                if (!reserve_pages(*running, slots_.logical_len(running->slot) + steps - 1)) {
+                    return 1; // Pages taken so far are used by the coming single steps
+                }
+            }
+            return steps;
+        }
+
+        // Launches `num_steps` decode steps of the whole running batch as one
+        // graph; each step's input tokens are the previous step's samples.
+        void launch_decode_run(std::chrono::steady_clock::time_point step_start, size_t num_steps) {
+            scheduled_.clear();
+            chunks_.clear();
+            chunk_slots_.clear();
+            decode_token_ids_.clear();
+            for (auto& running : running_) {
+                scheduled_.push_back({running.get(), computed(*running), num_steps, true});
+                chunks_.push_back({running->sequence.get(), slots_.logical_len(running->slot) - 1, 1});
+                chunk_slots_.push_back(running->slot);
+                decode_token_ids_.push_back(slots_.last_token(running->slot));
+                fair_share_.charge(tenant_of(*running->sequence), num_steps);
+            }
+            step_had_decodes_ = true;
+
+            std::vector<mx::array>& next_tokens = in_flight_.next_tokens;
+            std::vector<mx::array>& logprobs = in_flight_.logprobs;
+            std::vector<RunningSequence*>& sampled = in_flight_.sampled;
+            next_tokens.clear();
+            logprobs.clear();
+            sampled.clear();
+            for (auto& running : running_) {
+                sampled.push_back(running.get());
+            }
+
+            // Every step laid out up front, in the builder's memory.
+            const std::span<BatchDetails> run = batch_builder_->build_run(chunks_, num_steps, block_table_spec());
+            const auto batch_size = static_cast<int32_t>(chunks_.size());
+            mx::array token_ids(decode_token_ids_.begin(), {batch_size}, mx::int32);
+            std::vector<mx::array> step_tokens;
+            for (size_t step = 0; step < num_steps; ++step) {
+                BatchDetails& batch_details = run[step];
+                batch_details.token_ids = token_ids;
+                const mx::array logits = mx::reshape(
+                    model_->forward(batch_details), {batch_size, -1});
+
+                step_tokens.clear();
+                for (size_t i = 0; i < sampled.size(); ++i) {
+                    RunningSequence& running = *sampled[i];
+                    const mx::array row = mx::take(logits, mx::array(static_cast<int32_t>(i)), 0);
+                    step_tokens.push_back(
+                        running.sampler->next_token(row, running.sequence->sampling_params, running.rng));
+                    logprobs.push_back(token_logprob(row, step_tokens.back()));
+                }
+                next_tokens.insert(next_tokens.end(), step_tokens.begin(), step_tokens.end());
+                token_ids = mx::astype(mx::reshape(mx::stack(step_tokens), {-1}), mx::int32);
+            }
+            std::vector<mx::array> outputs = next_tokens;
+            outputs.insert(outputs.end(), logprobs.begin(), logprobs.end());
+            mx::async_eval(outputs);
+            mark_in_flight(step_start, num_steps);
+        }
+
+        // While the in-flight step runs: reserves the KV page each of its
+        // sampling sequences needs for its next token, and, if the next step
+        // looks like a plain decode of exactly those sequences, lays that step
+        // out so launch_batch() only copies in the sampled tokens. A wrong
+        // guess (a sequence stopped, other work joined) costs a full layout.
+        void prepare_next_step() {
+            if (!in_flight_.active || in_flight_.num_steps > 1) {
+                return; // Decode runs build their own batches (see launch_decode_run())
+            }
+            predicted_chunks_.clear();
+            predicted_slots_.clear();
+            bool predictable = waiting_.empty();
+            for (auto& running : running_) {
+                const size_t index = running->scheduled_slot;
+                if (!running->in_flight || index >= in_flight_.chunks.size()
+                    || in_flight_.chunks[index].running != running.get()) {
+                    predictable = false; // Prefilling or blocked: the next step has other work
+                    continue;
+                }
+                if (!in_flight_.chunks[index].samples) {
+                    predictable = false; // Mid-prompt: the next step prefills it
+                    continue;
+                }
+                if (slots_.remaining(running->slot) <= 1 || slots_.cancelled(running->slot)) {
+                    continue; // Done after this token
+                }
+                // The token being sampled is computed next step. Its page lies
+                // past everything the in-flight step reads.
+                const size_t next_position = slots_.logical_len(running->slot);
+                if (!reserve_pages(*running, next_position + 1)) {
+                    predictable = false;
+                    continue;
+                }
+                predicted_chunks_.push_back({running->sequence.get(), next_position, 1});
+                predicted_slots_.push_back(running->slot);
+            }
+            if (predictable && !predicted_chunks_.empty()) {
+                batch_builder_->prepare(predicted_chunks_, {
+                    .layout = block_table_layout_, .table = block_table_.get(), .rows = predicted_slots_});
+            }
+        }
+
+        // The synchronous part of a step: waits for the launched step's tokens
+        // and applies them. Returns false if nothing was in flight.
+        bool finish_in_flight() {
+            if (!in_flight_.active) {
+                return false;
+            }
+            for (const auto& chunk : in_flight_.chunks) {
+                slots_.add_computed(chunk.running->slot, chunk.length);
+                chunk.running->in_flight = false;
+            }
+            const size_t num_sampled = in_flight_.sampled.size();
+            for (size_t i = 0; i < in_flight_.next_tokens.size(); ++i) {
+                const int32_t token_id = in_flight_.next_tokens[i].item<int32_t>(); // Blocks until evaluated
+                RunningSequence& running = *in_flight_.sampled[i % num_sampled];
+                if (slots_.state(running.slot) == SlotState::STOPPED || slots_.cancelled(running.slot)) {
+                    // Cancelled mid-flight (retire_finished() closes its stream),
+                    // or stopped earlier in a multi-step run: drop the token.
+                    continue;
+                }
+                append_sampled_token(running, token_id, in_flight_.logprobs[i].item<float>());
+            }
+
+            // Timings are per step, so a multi-step run doesn't skew estimates.
+            const auto num_steps = static_cast<double>(in_flight_.num_steps);
+            const double elapsed_us = std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - in_flight_.started_at).count() / num_steps;
+            step_time_us_ = step_time_us_ == 0.0 ? elapsed_us : step_time_us_ + (elapsed_us - step_time_us_) / 8.0;
+            budget_controller_.observe(elapsed_us, in_flight_.num_tokens / in_flight_.num_steps, in_flight_.had_decodes);
+
+            in_flight_.chunks.clear();
+            in_flight_.next_tokens.clear();
+            in_flight_.logprobs.clear();
+            in_flight_.sampled.clear();
+            in_flight_.active = false;
+            return true;
+        }
+
+        void append_sampled_token(RunningSequence& running, int32_t token_id, float logprob) {
+            sequence::Sequence& sequence = *running.sequence;
+            if (sequence.status == sequence::SequenceStatus::PREFILLING) {
+                // The whole prompt is in the KV cache now; hand its shared memory
+                // back, keeping only what repetition penalties still look at.
+                // With predicted output lengths it is kept, so the sequence can
+                // still be preempted and recomputed (see recompute_victim()).
+                if (!admission_.predicts_output_lengths()) {
+                    sequence.release_prompt(static_cast<size_t>(std::max(sequence.logits_params.repetition_context_size, 0)));
+                }
+                sequence.status = sequence::SequenceStatus::DECODING;
+            }
+            sequence.append_token(token_id);
+
+            const bool finished = sequence.is_finished();
+            slots_.append_token(running.slot, token_id, finished);
+            if (token_sink_) {
+                token_sink_->emit(
+                    sequence, token_id, logprob,
+                    finished ? finish_reason_for(sequence) : ipc::FinishReason::NONE);
+            }
+            if (finished) {
+                sequence.status = sequence::SequenceStatus::COMPLETED;
+            }
+        }
+
+        // Drops finished and cancelled sequences and returns their KV pages.
+        void retire_finished() {
+            std::erase_if(running_, [this](const std::unique_ptr<RunningSequence>& running) {
+                sequence::Sequence& sequence = *running->sequence;
+                if (running->in_flight) {
+                    return false; // The device may still be writing its pages
+                }
+                const bool stopped = slots_.state(running->slot) == SlotState::STOPPED;
+                if (!stopped && slots_.remaining(running->slot) > 0 && !slots_.cancelled(running->slot)) {
+                    return false;
+                }
+                if (!stopped && token_sink_) {
+                    // Finished without sampling this step (cancelled): close the stream.
+                    token_sink_->finish(sequence, finish_reason_for(sequence));
+                }
+                if (stopped) {
+                    admission_.observe_finished(sequence.get_generation_len(), max_generated(sequence));
+                }
+                fair_share_.remove_work(tenant_of(sequence));
+                for (const uint32_t page_id : sequence.page_table) {
+                    allocator_.free_page(page_id);
+                }
+                sequence.page_table.clear();
+                block_table_->clear_row(running->slot);
+                slots_.release(running->slot);
+                spdlog::debug("Scheduler: sequence {} finished after {} tokens.",
+                              sequence.sequence_id, sequence.get_generation_len());
+                return true;
+            });
+        }
+
+        // Prompt tokens that still have to go through prefill, queued or running.
+        size_t pending_prefill_tokens() const {
+            size_t tokens = 0;
+            for (const auto& sequence : waiting_) {
+                tokens += sequence->prompt_len;
+            }
+            for (const size_t running_tokens : slots_.pending_prefill_tokens()) {
+                tokens += running_tokens;
+            }
+            return tokens;
+        }
+
+        void publish_load() {
+            if (!load_) {
+                return;
+            }
+            const size_t total_pages = allocator_.size();
+            const size_t free_pages = allocator_.get_num_free_pages();
+            const size_t waiting = waiting_.size() + incoming_.size_approx();
+
+            // A new request's first token waits for everything queued ahead of it to
+            // prefill, at one budget-sized batch per step, plus its own step.
+            const size_t budget = budget_controller_.token_budget();
+            const size_t prefill_steps = (pending_prefill_tokens() + budget - 1) / budget;
+            const auto estimated_ttft = std::chrono::microseconds(
+                static_cast<int64_t>(step_time_us_ * static_cast<double>(prefill_steps + 1)));
+
+            const double free_fraction = static_cast<double>(free_pages) / static_cast<double>(total_pages);
+            if (rejecting_) {
+                rejecting_ = free_fraction < ACCEPT_ABOVE_FREE_PAGE_FRACTION || estimated_ttft > MAX_ACCEPTED_TTFT;
+            } else {
+                rejecting_ = (free_fraction < REJECT_BELOW_FREE_PAGE_FRACTION && waiting > 0)
+                    || estimated_ttft > MAX_ACCEPTED_TTFT;
+            }
+            const auto retry_after = std::clamp<int64_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(estimated_ttft).count(), 100, 60000);
+
+            load_->free_kv_pages.store(static_cast<uint32_t>(free_pages), std::memory_order_relaxed);
+            load_->total_kv_pages.store(static_cast<uint32_t>(total_pages), std::memory_order_relaxed);
+            load_->waiting_sequences.store(static_cast<uint32_t>(waiting), std::memory_order_relaxed);
+            load_->running_sequences.store(static_cast<uint32_t>(running_.size()), std::memory_order_relaxed);
+            load_->estimated_ttft_us.store(static_cast<uint64_t>(estimated_ttft.count()), std::memory_order_relaxed);
+            load_->retry_after_ms.store(rejecting_ ? static_cast<uint32_t>(retry_after) : 0, std::memory_order_relaxed);
+            load_->admission.store(
+                rejecting_ ? ipc::AdmissionState::REJECTING : ipc::AdmissionState::ACCEPTING,
+                std::memory_order_relaxed);
+            load_->updated_at_ns.store(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count()), std::memory_order_relaxed);
+        }
+
+        bool cancel(uint64_t sequence_id) {
+            // It may still be sitting in the hand-off queue.
+            drain_incoming();
+            for (const auto& sequence : waiting_) {
+                if (sequence->sequence_id == sequence_id) {
+                    sequence->cancelled.store(true, std::memory_order_release);
+                    return true;
+                }
+            }
+            for (const auto& running : running_) {
+                if (running->sequence->sequence_id == sequence_id) {
+                    running->sequence->cancelled.store(true, std::memory_order_release);
+                    slots_.cancel(running->slot);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool step() {
+            const auto step_start = std::chrono::steady_clock::now();
+
+            // Host-side work, overlapped with the previous step's evaluation.
+            drain_incoming();
+            fair_share_.refill(now_ns());
+            poll_cancellations();
+            retire_finished();
+            order_waiting();
+            admit_waiting();
+            prepare_next_step();
+
+            // Only what depends on the sampled tokens waits for the device.
+            const bool finished_step = finish_in_flight();
+            poll_cancellations(); // Again: cancels that came in while the device ran
+            retire_finished();
+            if (token_sink_) {
+                // One client wakeup for everything this step produced, before
+                // the next step's graph is built.
+                token_sink_->flush();
+            }
+            if (finished_step) {
+                admit_waiting(); // Into the slots the finished step freed
+            }
+            bool launched = true;
+            if (const size_t run_steps = prepare_decode_run(); run_steps > 1) {
+                launch_decode_run(step_start, run_steps);
+            } else {
+                schedule_batch();
+                launched = !scheduled_.empty();
+                if (launched) {
+                    launch_batch(step_start);
+                }
+            }
+            publish_load();
+            stalled_ = !launched && !finished_step && !(waiting_.empty() && running_.empty());
+            return launched || finished_step;
+        }
+
+        void wait_for_work(std::chrono::microseconds timeout) {
+            if (!waiting_.empty() || !running_.empty()) {
+                if (!stalled_) {
+                    return;
+                }
+                // Until a tenant is back under its rate, a new sequence comes
+                // in, or a short bound passes: pages and cancellations have no
+                // wakeup of their own.
+                timeout = std::min<std::chrono::microseconds>(timeout, MAX_STALLED_WAIT);
+                const uint64_t refill_at = fair_share_.next_refill_ns();
+                const uint64_t now = now_ns();
+                if (refill_at != std::numeric_limits<uint64_t>::max()) {
+                    timeout = std::min<std::chrono::microseconds>(
+                        timeout, std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::nanoseconds(refill_at > now ? refill_at - now : 0)) + std::chrono::microseconds(1));
+                }
+            }
+            incoming_.wait_for_data(timeout);
+        }
     };
 
-}
+    Scheduler::Scheduler(
+        PageAllocator& allocator,
+        std::unique_ptr<models::IModel> model,
+        SequenceQueue& incoming,
+        ITokenSink* token_sink,
+        size_t max_num_seqs,
+        size_t max_tokens_in_batch
+    ) : pimpl_(std::make_unique<SchedulerImpl>(SchedulerImpl{
+            .allocator_ = allocator,
+            .model_ = std::move(model),
+            .incoming_ = incoming,
+            .token_sink_ = token_sink,
+            .max_num_seqs_ = max_num_seqs,
+            .max_tokens_in_batch_ = max_tokens_in_batch,
+            .waiting_ = {},
+            .running_ = {},
+            .scheduled_ = {},
+            .chunks_ = {}
+        }))
+    {
+        if (!pimpl_->model_) {
+            throw std::invalid_argument("Scheduler requires a model.");
+        }
+        if (max_num_seqs == 0 || max_tokens_in_batch == 0) {
+            throw std::invalid_argument("Scheduler limits must be positive.");
+        }
+    }
+
+    Scheduler::~Scheduler() = default;
+
+    bool Scheduler::step() {
+        return pimpl_->step();
+    }
+
+    void Scheduler::wait_for_work(std::chrono::microseconds timeout) {
+        pimpl_->wait_for_work(timeout);
+    }
+
+    bool Scheduler::cancel(uint64_t sequence_id) {
+        return pimpl_->cancel(sequence_id);
+    }
+
+    void Scheduler::set_batch_policy(std::unique_ptr<IBatchPolicy> policy) {
+        if (!policy) {
+            throw std::invalid_argument("Scheduler requires a batch policy.");
+        }
+        spdlog::info("Scheduler: batch policy '{}'.", policy->name());
+        pimpl_->batch_policy_ = std::move(policy);
+    }
+
+    std::string Scheduler::batch_policy_name() const {
+        return pimpl_->batch_policy_->name();
+    }
+
+    void Scheduler::set_target_step_time(std::chrono::microseconds target) noexcept {
+        pimpl_->budget_controller_.set_target(target);
+    }
+
+    void Scheduler::set_decode_steps(size_t steps) {
+        if (steps == 0) {
+            throw std::invalid_argument("Scheduler: decode steps must be positive.");
+        }
+        pimpl_->decode_steps_ = steps;
+    }
+
+    void Scheduler::set_kv_watermark(double free_fraction) {
+        pimpl_->admission_.set_watermark(free_fraction);
+    }
+
+    void Scheduler::set_predict_output_lengths(bool enabled) noexcept {
+        pimpl_->admission_.set_predict_output_lengths(enabled);
+    }
+
+    void Scheduler::set_block_table_layout(BlockTableLayout layout) {
+        pimpl_->block_table_layout_ = layout;
+    }
+
+    size_t Scheduler::token_budget() const noexcept {
+        return pimpl_->budget_controller_.token_budget();
+    }
+
+    void Scheduler::set_tenant_policy(uint32_t tenant_id, const TenantPolicy& policy) {
+        pimpl_->fair_share_.set_policy(tenant_id, policy);
+    }
+
+    void Scheduler::publish_load_to(ipc::EngineLoad* load) noexcept {
+        pimpl_->load_ = load;
+    }
+
+    size_t Scheduler::num_waiting() const noexcept {
+        return pimpl_->waiting_.size() + pimpl_->incoming_.size_approx();
+    }
+
+    size_t Scheduler::num_running() const noexcept {
+        return pimpl_->running_.size();
+    }
+
+} // namespace pie_core::engine
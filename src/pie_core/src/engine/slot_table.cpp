@@ -0,0 +1,118 @@
+#include "engine/slot_table.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace pie_core::engine {
+
+    SlotTable::SlotTable(size_t num_slots)
+        : state_(num_slots, SlotState::FREE),
+          priority_(num_slots, sequence::Priority::STANDARD),
+          logical_len_(num_slots, 0),
+          computed_(num_slots, 0),
+          last_token_(num_slots, 0),
+          num_pages_(num_slots, 0),
+          charged_pages_(num_slots, 0),
+          remaining_(num_slots, 0),
+          cancelled_(num_slots, 0),
+          cancel_words_(num_slots, nullptr)
+    {
+        if (num_slots == 0) {
+            throw std::invalid_argument("SlotTable: needs at least one slot.");
+        }
+        // Handed out lowest first.
+        free_slots_.reserve(num_slots);
+        for (size_t slot = num_slots; slot > 0; --slot) {
+            free_slots_.push_back(static_cast<uint32_t>(slot - 1));
+        }
+    }
+
+    std::optional<uint32_t> SlotTable::acquire() {
+        if (free_slots_.empty()) {
+            return std::nullopt;
+        }
+        const uint32_t slot = free_slots_.back();
+        free_slots_.pop_back();
+        return slot;
+    }
+
+    void SlotTable::release(uint32_t slot) {
+        state_.at(slot) = SlotState::FREE;
+        cancel_words_[slot] = nullptr;
+        free_slots_.push_back(slot);
+    }
+
+    void SlotTable::load(
+        uint32_t slot,
+        sequence::Priority priority,
+        size_t logical_len,
+        int32_t last_token,
+        size_t max_new_tokens,
+        const std::atomic<uint32_t>* cancel_word
+    ) {
+        state_.at(slot) = SlotState::PREFILLING;
+        priority_[slot] = priority;
+        logical_len_[slot] = static_cast<uint32_t>(logical_len);
+        computed_[slot] = 0;
+        last_token_[slot] = last_token;
+        num_pages_[slot] = 0;
+        charged_pages_[slot] = 0;
+        remaining_[slot] = static_cast<uint32_t>(std::min<size_t>(max_new_tokens, UINT32_MAX));
+        cancelled_[slot] = 0;
+        cancel_words_[slot] = cancel_word;
+    }
+
+    void SlotTable::append_token(uint32_t slot, int32_t token_id, bool stop) {
+        ++logical_len_[slot];
+        last_token_[slot] = token_id;
+        remaining_[slot] -= std::min<uint32_t>(remaining_[slot], 1);
+        state_[slot] = stop || remaining_[slot] == 0 ? SlotState::STOPPED : SlotState::DECODING;
+    }
+
+    size_t SlotTable::count(SlotState state) const noexcept {
+        return static_cast<size_t>(std::count(state_.begin(), state_.end(), state));
+    }
+
+    std::array<size_t, 3> SlotTable::pending_prefill_tokens() const noexcept {
+        std::array<size_t, 3> tokens{};
+        for (size_t slot = 0; slot < state_.size(); ++slot) {
+            if (state_[slot] == SlotState::PREFILLING) {
+                tokens[static_cast<size_t>(priority_[slot])] += logical_len_[slot] - computed_[slot];
+            }
+        }
+        return tokens;
+    }
+
+    size_t SlotTable::min_remaining() const noexcept {
+        size_t fewest = SIZE_MAX;
+        for (size_t slot = 0; slot < state_.size(); ++slot) {
+            if (state_[slot] == SlotState::DECODING) {
+                fewest = std::min<size_t>(fewest, remaining_[slot]);
+            }
+        }
+        return fewest;
+    }
+
+    size_t SlotTable::poll_cancellations() noexcept {
+        size_t newly_cancelled = 0;
+        for (size_t slot = 0; slot < state_.size(); ++slot) {
+            const std::atomic<uint32_t>* word = cancel_words_[slot];
+            if (word && !cancelled_[slot] && word->load(std::memory_order_acquire) != 0) {
+                cancelled_[slot] = 1;
+                ++newly_cancelled;
+            }
+        }
+        return newly_cancelled;
+    }
+
+    size_t SlotTable::outstanding_pages() const noexcept {
+        size_t pages = 0;
+        for (size_t slot = 0; slot < state_.size(); ++slot) {
+            if (state_[slot] == SlotState::PREFILLING || state_[slot] == SlotState::DECODING) {
+                pages += charged_pages_[slot] - std::min(charged_pages_[slot], num_pages_[slot]);
+            }
+        }
+        return pages;
+    }
+
+} // namespace pie_core::engine
@@ -0,0 +1,29 @@
+#include "engine/token_sink.hpp"
+
+#include "ipc/response_writer.hpp"
+#include "sequence/sequence.hpp"
+
+namespace pie_core::engine {
+
+    void ResponseChannelSink::emit(
+        const sequence::Sequence& sequence,
+        int32_t token_id,
+        std::optional<float> logprob,
+        ipc::FinishReason finish_reason
+    ) {
+        writer_.emit(sequence.ipc_handles.response_channel_id, token_id, logprob, {}, finish_reason);
+    }
+
+    void ResponseChannelSink::finish(const sequence::Sequence& sequence, ipc::FinishReason finish_reason) {
+        writer_.finish(sequence.ipc_handles.response_channel_id, finish_reason);
+    }
+
+    void ResponseChannelSink::flush() {
+        writer_.flush();
+    }
+
+    const std::atomic<uint32_t>* ResponseChannelSink::cancel_word(const sequence::Sequence& sequence) const {
+        return writer_.cancel_word(sequence.ipc_handles.response_channel_id);
+    }
+
+} // namespace pie_core::engine
@@ -0,0 +1,50 @@
+#include "engine/token_stream.hpp"
+
+namespace pie_core::engine {
+
+    bool TokenStream::push(StreamToken token) {
+        bool wake = false;
+        {
+            std::lock_guard lock(mutex_);
+            if (closed_) {
+                return false;
+            }
+            closed_ = token.finish_reason != ipc::FinishReason::NONE;
+            if (!on_token_) {
+                pending_.push_back(token);
+            }
+            wake = waiters_ > 0;
+        }
+        if (on_token_) {
+            // Only the scheduler thread pushes, so callbacks never overlap.
+            on_token_(token);
+        }
+        // Async consumers never block here; only pay for the notify if a thread does.
+        if (wake) {
+            ready_.notify_all();
+        }
+        return true;
+    }
+
+    size_t TokenStream::read(std::vector<StreamToken>& out) {
+        std::lock_guard lock(mutex_);
+        const size_t count = pending_.size();
+        out.insert(out.end(), pending_.begin(), pending_.end());
+        pending_.clear();
+        return count;
+    }
+
+    bool TokenStream::wait(std::chrono::microseconds timeout) {
+        std::unique_lock lock(mutex_);
+        ++waiters_;
+        const bool ready = ready_.wait_for(lock, timeout, [this] { return !pending_.empty() || closed_; });
+        --waiters_;
+        return ready;
+    }
+
+    bool TokenStream::closed() const {
+        std::lock_guard lock(mutex_);
+        return closed_;
+    }
+
+} // namespace pie_core::engine
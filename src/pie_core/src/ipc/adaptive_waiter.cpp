@@ -0,0 +1,93 @@
+#include "ipc/adaptive_waiter.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace pie_core::ipc {
+
+    namespace {
+
+        // Tells the core we're spinning: frees pipeline resources for the sibling
+        // hyper-thread and saves power without giving up the time slice.
+        inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#elif defined(__aarch64__)
+            asm volatile("yield" ::: "memory");
+#endif
+        }
+
+        // Re-read the clock only every few pauses; it is far slower than the load.
+        constexpr int SPINS_PER_CLOCK_CHECK = 16;
+
+    } // namespace
+
+    AdaptiveWaiter::AdaptiveWaiter(EventNotifier& notifier, AdaptiveWaitConfig config) noexcept
+        : notifier_(notifier),
+          config_(config),
+          spin_budget_(config.min_spin),
+          smoothed_gap_(config.max_spin * 2),
+          last_arrival_(Clock::now())
+    {
+        // Spinning on the only core just delays the thread we're waiting for.
+        if (std::thread::hardware_concurrency() <= 1) {
+            config_.min_spin = config_.max_spin = std::chrono::nanoseconds::zero();
+            spin_budget_ = std::chrono::nanoseconds::zero();
+        }
+    }
+
+    bool AdaptiveWaiter::wait(uint32_t observed, std::chrono::microseconds timeout) noexcept {
+        const Clock::time_point start = Clock::now();
+        const std::chrono::nanoseconds spin_for = std::min<std::chrono::nanoseconds>(spin_budget_, timeout);
+
+        if (spin_for > std::chrono::nanoseconds::zero()) {
+            const Clock::time_point spin_deadline = start + spin_for;
+            for (;;) {
+                for (int i = 0; i < SPINS_PER_CLOCK_CHECK; ++i) {
+                    if (notifier_.snapshot() != observed) {
+                        record_arrival(Clock::now());
+                        return true;
+                    }
+                    cpu_relax();
+                }
+                if (Clock::now() >= spin_deadline) {
+                    break;
+                }
+            }
+        }
+
+        const auto remaining = timeout - std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+        if (remaining <= std::chrono::microseconds::zero()) {
+            return false;
+        }
+        const bool notified = notifier_.wait(observed, remaining);
+        if (notified) {
+            record_arrival(Clock::now());
+        } else {
+            // A full timeout without work: stop spinning until arrivals pick up again.
+            smoothed_gap_ = std::max(smoothed_gap_, config_.max_spin * 2);
+            spin_budget_ = config_.min_spin;
+        }
+        return notified;
+    }
+
+    void AdaptiveWaiter::record_arrival(Clock::time_point now) noexcept {
+        const auto gap = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_arrival_);
+        last_arrival_ = now;
+        // EWMA with weight 1/8: smooths bursts without lagging a load change by much.
+        smoothed_gap_ += (gap - smoothed_gap_) / 8;
+
+        if (smoothed_gap_ <= config_.max_spin) {
+            spin_budget_ = std::clamp<std::chrono::nanoseconds>(
+                smoothed_gap_ * config_.spin_gap_multiplier, config_.min_spin, config_.max_spin);
+        } else {
+            // Work comes too rarely for spinning to pay off.
+            spin_budget_ = config_.min_spin;
+        }
+    }
+
+} // namespace pie_core::ipc
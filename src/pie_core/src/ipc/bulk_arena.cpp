@@ -0,0 +1,98 @@
+#include "ipc/bulk_arena.hpp"
+
+#include <limits>
+#include <stdexcept>
+
+namespace pie_core::ipc {
+
+    BulkArena::BulkArena(void* segment_base, size_t segment_size)
+        : segment_base_(static_cast<char*>(segment_base)),
+          control_(reinterpret_cast<BulkArenaControl*>(segment_base)),
+          data_(static_cast<char*>(segment_base) + sizeof(BulkArenaControl)),
+          capacity_(0)
+    {
+        if (segment_size <= sizeof(BulkArenaControl) + BLOCK_ALIGNMENT) {
+            throw std::invalid_argument("BulkArena segment is too small.");
+        }
+        // Keep every block (and hence every padding block) a multiple of the
+        // alignment, so a header always fits wherever the ring wraps.
+        capacity_ = (segment_size - sizeof(BulkArenaControl)) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+    }
+
+    void BulkArena::initialize() noexcept {
+        control_->head.store(0, std::memory_order_relaxed);
+        control_->tail.store(0, std::memory_order_release);
+    }
+
+    std::optional<uint64_t> BulkArena::allocate(size_t payload_bytes) {
+        const size_t size =
+            (sizeof(BulkBlockHeader) + payload_bytes + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+        if (size > capacity_ || size > std::numeric_limits<uint32_t>::max()) {
+            return std::nullopt;
+        }
+
+        uint64_t head = control_->head.load(std::memory_order_acquire);
+        for (;;) {
+            const size_t offset = head % capacity_;
+            const size_t padding = offset + size > capacity_ ? capacity_ - offset : 0;
+            const uint64_t end = head + padding + size;
+
+            const uint64_t tail = control_->tail.load(std::memory_order_acquire);
+            if (end - tail > capacity_) {
+                // Full unless reclaiming (ours or a concurrent producer's) frees space.
+                if (reclaim() == 0 && control_->tail.load(std::memory_order_acquire) == tail) {
+                    return std::nullopt;
+                }
+                head = control_->head.load(std::memory_order_acquire);
+                continue;
+            }
+            if (!control_->head.compare_exchange_weak(
+                    head, end, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                continue;
+            }
+
+            if (padding > 0) {
+                write_header(head, static_cast<uint32_t>(padding), BulkBlockState::RELEASED);
+            }
+            write_header(head + padding, static_cast<uint32_t>(size), BulkBlockState::IN_USE);
+            return sizeof(BulkArenaControl) + (head + padding) % capacity_;
+        }
+    }
+
+    size_t BulkArena::reclaim() noexcept {
+        size_t reclaimed = 0;
+        uint64_t tail = control_->tail.load(std::memory_order_acquire);
+        while (tail < control_->head.load(std::memory_order_acquire)) {
+            BulkBlockHeader* header = header_for(tail);
+            // A mismatched position means the header at `tail` is still being
+            // written (or is a leftover from an earlier lap): stop here.
+            if (header->position.load(std::memory_order_acquire) != tail
+                || header->state.load(std::memory_order_acquire) != BulkBlockState::RELEASED) {
+                break;
+            }
+            const uint32_t size = header->size.load(std::memory_order_relaxed);
+            if (control_->tail.compare_exchange_strong(
+                    tail, tail + size, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                reclaimed += size;
+                tail += size;
+            }
+            // On failure another producer moved `tail`; `tail` now holds its value.
+        }
+        return reclaimed;
+    }
+
+    size_t BulkArena::used_bytes() const noexcept {
+        const uint64_t head = control_->head.load(std::memory_order_relaxed);
+        const uint64_t tail = control_->tail.load(std::memory_order_relaxed);
+        return head > tail ? static_cast<size_t>(head - tail) : 0;
+    }
+
+    void BulkArena::write_header(uint64_t position, uint32_t size, BulkBlockState state) noexcept {
+        BulkBlockHeader* header = header_for(position);
+        header->state.store(state, std::memory_order_relaxed);
+        header->size.store(size, std::memory_order_relaxed);
+        // Publishing `position` last makes the header trustworthy to reclaimers.
+        header->position.store(position, std::memory_order_release);
+    }
+
+} // namespace pie_core::ipc
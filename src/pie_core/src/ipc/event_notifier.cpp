@@ -0,0 +1,83 @@
+#include "ipc/event_notifier.hpp"
+
+#include <cerrno>
+#include <climits>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#elif defined(__APPLE__)
+#include <os/os_sync_wait_on_address.h>
+#endif
+
+namespace pie_core::ipc {
+
+    namespace {
+
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                      "futex words must be plain 32-bit integers");
+        static_assert(std::atomic<uint32_t>::is_always_lock_free,
+                      "futex words must be lock-free to be shared across processes");
+
+#if defined(__linux__)
+        // Shared (non-PRIVATE) futex ops: the word lives in a MAP_SHARED mapping
+        // and the waker is usually a different process.
+        long futex_wait(std::atomic<uint32_t>* word, uint32_t expected, const timespec* timeout) {
+            return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, timeout, nullptr, 0);
+        }
+
+        long futex_wake_all(std::atomic<uint32_t>* word) {
+            return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+#endif
+
+    } // namespace
+
+    void EventNotifier::notify() noexcept {
+        // seq_cst on both sides pairs with the waiter registration in wait():
+        // either we observe the waiter and wake it, or it observes the new sequence
+        // and never goes to sleep.
+        sequence_.fetch_add(1, std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_seq_cst) == 0) {
+            return;
+        }
+#if defined(__linux__)
+        futex_wake_all(&sequence_);
+#elif defined(__APPLE__)
+        os_sync_wake_by_address_all(&sequence_, sizeof(uint32_t), OS_SYNC_WAKE_BY_ADDRESS_SHARED);
+#endif
+    }
+
+    bool EventNotifier::wait(uint32_t observed, std::chrono::microseconds timeout) noexcept {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        if (sequence_.load(std::memory_order_seq_cst) != observed) {
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+#if defined(__linux__)
+        const auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        const timespec ts{
+            .tv_sec = static_cast<time_t>(secs.count()),
+            .tv_nsec = static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - secs).count())
+        };
+        // EINTR and spurious wakeups are fine: the caller re-checks for work.
+        futex_wait(&sequence_, observed, &ts);
+#elif defined(__APPLE__)
+        const auto timeout_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count());
+        os_sync_wait_on_address_with_timeout(
+            &sequence_, observed, sizeof(uint32_t),
+            OS_SYNC_WAIT_ON_ADDRESS_SHARED, OS_CLOCK_MACH_ABSOLUTE_TIME, timeout_ns);
+#else
+        std::this_thread::sleep_for(timeout);
+#endif
+
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return sequence_.load(std::memory_order_acquire) != observed;
+    }
+
+} // namespace pie_core::ipc
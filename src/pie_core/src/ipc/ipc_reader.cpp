@@ -0,0 +1,343 @@
+#include "ipc/ipc_reader.hpp"
+
+#include <sys/mman.h> // mmap, shm_open
+#include <sys/stat.h> // For mode constants
+#include <fcntl.h>    // For O_* constants
+#include <unistd.h>   // ftruncate, close
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <new>
+#include <chrono>
+#include <thread>
+#include <spdlog/spdlog.h>
+
+namespace pie_core::ipc {
+
+    namespace {
+
+        // Opens (creating if needed) and maps a POSIX shared memory segment.
+        // Returns MAP_FAILED on error; `fd` is left at -1 in that case.
+        void* map_shared_segment(const char* name, size_t size, int& fd) {
+            fd = shm_open(name, O_CREAT | O_RDWR, 0666);
+            if (fd == -1) {
+                spdlog::error("IPCReader: shm_open('{}') failed: {}", name, std::strerror(errno));
+                return MAP_FAILED;
+            }
+            if (ftruncate(fd, static_cast<off_t>(size)) == -1) {
+                spdlog::error("IPCReader: ftruncate('{}') failed: {}", name, std::strerror(errno));
+                close(fd);
+                fd = -1;
+                return MAP_FAILED;
+            }
+            void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (ptr == MAP_FAILED) {
+                spdlog::error("IPCReader: mmap('{}') failed: {}", name, std::strerror(errno));
+                close(fd);
+                fd = -1;
+            }
+            return ptr;
+        }
+
+        // Whether `ref`'s elements lie in the payload of the block `lease` names.
+        bool within_lease(const BulkRef& lease, const BulkRef& ref, size_t element_size) {
+            if (ref.count == 0) {
+                return true;
+            }
+            const uint64_t payload_begin = lease.offset + sizeof(BulkBlockHeader);
+            const uint64_t payload_end = lease.offset + lease.count;
+            const uint64_t bytes = uint64_t{ref.count} * element_size;
+            return ref.offset >= payload_begin && ref.offset <= payload_end && bytes <= payload_end - ref.offset;
+        }
+
+    } // namespace
+
+    IPCReader::IPCReader(
+        SequenceQueueType& output_queue,
+        const std::string& request_shm_name,
+        AdaptiveWaitConfig wait_config,
+        size_t num_shards
+    ) : wait_config_(wait_config),
+        request_shm_name_(request_shm_name),
+        num_shards_(num_shards),
+        output_queue_(output_queue)
+    {
+        if (!initialize_ipc_resources()) {
+            cleanup_ipc_resources();
+            throw std::runtime_error("IPCReader: failed to initialize IPC resources.");
+        }
+        // Armed here rather than in run(), so a stop() that races the thread
+        // start is never lost.
+        running_.store(true, std::memory_order_release);
+    }
+
+    IPCReader::~IPCReader() {
+        stop();
+        cleanup_ipc_resources();
+    }
+
+    void IPCReader::run() {
+        spdlog::info("IPCReader: listening on '{}' ({} shards).", request_shm_name_, num_shards_);
+        while (running_.load(std::memory_order_acquire)) {
+            process_incoming_requests();
+            wait_for_notification();
+        }
+        spdlog::info("IPCReader: stopped.");
+    }
+
+    void IPCReader::stop() {
+        if (running_.exchange(false, std::memory_order_acq_rel) && notifier_) {
+            // Kick the reader out of its kernel wait.
+            notifier_->notify();
+        }
+        output_queue_.wake_producer(); // Or out of waiting for the scheduler
+    }
+
+    // --- Private Helpers ---
+
+    bool IPCReader::initialize_ipc_resources() {
+        if (num_shards_ == 0 || num_shards_ > REQUEST_QUEUE_MAX_SHARDS) {
+            spdlog::error("IPCReader: shard count must be in [1, {}], got {}.", REQUEST_QUEUE_MAX_SHARDS, num_shards_);
+            return false;
+        }
+        request_shm_size_ = request_segment_size(num_shards_);
+        request_shm_map_ptr_ = map_shared_segment(
+            request_shm_name_.c_str(), request_shm_size_, request_shm_fd_);
+        if (request_shm_map_ptr_ == MAP_FAILED) {
+            request_shm_map_ptr_ = nullptr;
+            return false;
+        }
+        // The engine owns the segment: reset the header and every ring before
+        // any producer attaches.
+        request_segment_header_ = new (request_shm_map_ptr_) RequestSegmentHeader{};
+        request_segment_header_->num_shards = static_cast<uint32_t>(num_shards_);
+        request_shards_.reserve(num_shards_);
+        for (size_t shard = 0; shard < num_shards_; ++shard) {
+            request_shards_.push_back(request_queue(request_shm_map_ptr_, shard));
+            request_shards_.back().initialize();
+        }
+
+        bulk_data_map_ptr_ = map_shared_segment(
+            BULK_DATA_SHM_NAME, BULK_DATA_SHM_SIZE, bulk_data_shm_fd_);
+        if (bulk_data_map_ptr_ == MAP_FAILED) {
+            bulk_data_map_ptr_ = nullptr;
+            return false;
+        }
+        // Same for the bulk arena producers place request data in.
+        bulk_arena_.emplace(bulk_data_map_ptr_, BULK_DATA_SHM_SIZE);
+        bulk_arena_->initialize();
+
+        notifier_.emplace(
+            request_segment_header_->notify_seq,
+            request_segment_header_->notify_waiters
+        );
+        waiter_.emplace(*notifier_, wait_config_);
+        last_notify_seq_ = notifier_->snapshot();
+        return true;
+    }
+
+    void IPCReader::cleanup_ipc_resources() {
+        waiter_.reset();
+        notifier_.reset();
+        request_shards_.clear();
+        bulk_arena_.reset();
+        if (bulk_data_map_ptr_ != nullptr) {
+            munmap(bulk_data_map_ptr_, BULK_DATA_SHM_SIZE);
+            bulk_data_map_ptr_ = nullptr;
+        }
+        if (bulk_data_shm_fd_ != -1) {
+            close(bulk_data_shm_fd_);
+            bulk_data_shm_fd_ = -1;
+            shm_unlink(BULK_DATA_SHM_NAME);
+        }
+        if (request_shm_map_ptr_ != nullptr) {
+            munmap(request_shm_map_ptr_, request_shm_size_);
+            request_shm_map_ptr_ = nullptr;
+            request_segment_header_ = nullptr;
+        }
+        if (request_shm_fd_ != -1) {
+            close(request_shm_fd_);
+            request_shm_fd_ = -1;
+            shm_unlink(request_shm_name_.c_str());
+        }
+    }
+
+    bool IPCReader::wait_for_notification() {
+        if (!running_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        // `last_notify_seq_` was sampled before the last drain, so anything
+        // published since then returns immediately instead of sleeping. Under
+        // load the waiter catches the next request while still spinning.
+        return waiter_->wait(last_notify_seq_, MAX_WAIT_INTERVAL);
+    }
+
+    void IPCReader::process_incoming_requests() {
+        last_notify_seq_ = notifier_->snapshot();
+        // Keep making round-robin passes until a whole pass finds nothing, so
+        // requests published mid-drain are picked up without another wait.
+        size_t drained = 0;
+        do {
+            drained = 0;
+            for (size_t i = 0; i < request_shards_.size(); ++i) {
+                RequestQueue& shard = request_shards_[(next_shard_ + i) % request_shards_.size()];
+                if (!drain_shard(shard, drained)) {
+                    return;
+                }
+            }
+            // Rotate the starting shard so no shard is always served first.
+            next_shard_ = (next_shard_ + 1) % request_shards_.size();
+        } while (drained > 0);
+    }
+
+    bool IPCReader::drain_shard(RequestQueue& shard, size_t& drained) {
+        uint64_t first = 0;
+        // One CAS claims up to the per-shard cap, in arrival order.
+        const size_t count = shard.try_claim_range(first, MAX_REQUESTS_PER_SHARD);
+        for (uint64_t pos = first; pos < first + count; ++pos) {
+            std::unique_ptr<sequence::Sequence> sequence = build_sequence_from_slot(shard.at(pos));
+            // Everything needed has been copied out; hand the slot straight back.
+            shard.release(pos);
+            if (!sequence) {
+                continue;
+            }
+            spdlog::debug("IPCReader: received request {}", sequence->sequence_id);
+            // A full queue means the scheduler is behind; hold this request
+            // (and with it the ring) until it catches up, asleep until it pops.
+            while (!output_queue_.try_push(std::move(sequence))) {
+                if (!running_.load(std::memory_order_acquire)) {
+                    // Dropping `sequence` releases its lease; the rest of the
+                    // claim is never built, so release theirs here.
+                    for (uint64_t rest = pos + 1; rest < first + count; ++rest) {
+                        release_lease(shard.at(rest).payload);
+                        shard.release(rest);
+                    }
+                    return false;
+                }
+                output_queue_.wait_for_space(MAX_WAIT_INTERVAL);
+            }
+        }
+        drained += count;
+        return true;
+    }
+
+    BulkBlockHeader* IPCReader::resolve_bulk_block(const BulkRef& lease) {
+        if (lease.count < sizeof(BulkBlockHeader)
+            || lease.offset < sizeof(BulkArenaControl)
+            || lease.offset % alignof(BulkBlockHeader) != 0
+            || lease.offset > BULK_DATA_SHM_SIZE
+            || lease.count > BULK_DATA_SHM_SIZE - lease.offset) {
+            return nullptr;
+        }
+        // Only a live block the lease describes exactly; anything else would
+        // have us mark unrelated bytes released.
+        BulkBlockHeader* block = bulk_arena_->block_at(lease.offset);
+        if (block->state.load(std::memory_order_acquire) != BulkBlockState::IN_USE
+            || block->size.load(std::memory_order_relaxed) != lease.count) {
+            return nullptr;
+        }
+        return block;
+    }
+
+    void IPCReader::release_lease(const RequestPayload& request) {
+        if (request.lease.count == 0) {
+            return;
+        }
+        if (BulkBlockHeader* block = resolve_bulk_block(request.lease)) {
+            BulkArena::release(*block);
+        }
+    }
+
+    std::unique_ptr<sequence::Sequence> IPCReader::build_sequence_from_slot(const RequestSlot& slot) {
+        const RequestPayload& request = slot.payload;
+        // Resolved first, and released on every way out that doesn't hand it
+        // to the prompt: the arena reclaims strictly in order, so one leaked
+        // block would stall it for good.
+        BulkBlockHeader* block = request.lease.count != 0 ? resolve_bulk_block(request.lease) : nullptr;
+        // A malformed request is still handed over, already failed, so the
+        // scheduler answers its client with FinishReason::ERROR.
+        const auto refuse = [&request, block]() {
+            if (block) {
+                BulkArena::release(*block);
+            }
+            return std::make_unique<sequence::Sequence>(
+                request.request_id, sequence::SequenceStatus::ERROR, 0, sequence::Prompt{},
+                sequence::SamplingParams{}, sequence::LogitsParams{}, sequence::StopCriteria{}, request.ipc_handles);
+        };
+
+        if (request.format_version != REQUEST_FORMAT_VERSION) {
+            // Nothing else in it can be trusted, the response channel included.
+            spdlog::warn(
+                "IPCReader: dropping request {} with format version {} (expected {}).",
+                request.request_id, request.format_version, REQUEST_FORMAT_VERSION);
+            if (block) {
+                BulkArena::release(*block);
+            }
+            return nullptr;
+        }
+        if (request.lease.count != 0 && !block) {
+            spdlog::warn("IPCReader: refusing request {} with an invalid bulk lease.", request.request_id);
+            return refuse();
+        }
+
+        const auto prompt = resolve_bulk_ref<int32_t>(bulk_data_map_ptr_, BULK_DATA_SHM_SIZE, request.prompt);
+        const auto logit_bias = resolve_bulk_ref<sequence::TokenBias>(bulk_data_map_ptr_, BULK_DATA_SHM_SIZE, request.logit_bias);
+        const auto stop_token_ids = resolve_bulk_ref<int32_t>(bulk_data_map_ptr_, BULK_DATA_SHM_SIZE, request.stop_token_ids);
+        if (!prompt || !logit_bias || !stop_token_ids) {
+            spdlog::warn("IPCReader: refusing request {} with out-of-bounds bulk reference.", request.request_id);
+            return refuse();
+        }
+        // A leased request's arrays must live in its own block: bytes outside
+        // it can be handed to another producer while we still read them.
+        if (block && (!within_lease(request.lease, request.prompt, sizeof(int32_t))
+                      || !within_lease(request.lease, request.logit_bias, sizeof(sequence::TokenBias))
+                      || !within_lease(request.lease, request.stop_token_ids, sizeof(int32_t)))) {
+            spdlog::warn("IPCReader: refusing request {} with bulk data outside its lease.", request.request_id);
+            return refuse();
+        }
+        if (prompt->empty()) {
+            spdlog::warn("IPCReader: refusing request {} with empty prompt.", request.request_id);
+            return refuse();
+        }
+
+        // Plain copies out of shared memory; the only allocations are the
+        // containers the Sequence keeps.
+        sequence::LogitsParams logits_params{
+            .frequency_penalty = request.frequency_penalty,
+            .logit_bias = {logit_bias->begin(), logit_bias->end()},
+            .presence_penalty = request.presence_penalty,
+            .repetition_context_size = request.repetition_context_size,
+            .repetition_penalty = request.repetition_penalty
+        };
+        sequence::StopCriteria stop_criteria{
+            .max_generated_tokens = request.max_generated_tokens,
+            .stop_token_ids = {stop_token_ids->begin(), stop_token_ids->end()}
+        };
+
+        // The prompt itself is read in place. Only a leased block guarantees the
+        // producer won't overwrite it underneath us; untracked prompts are copied.
+        sequence::Prompt prompt_tokens;
+        if (block) {
+            prompt_tokens = sequence::Prompt(*prompt, [block]() { BulkArena::release(*block); });
+        } else {
+            prompt_tokens = sequence::Prompt(std::vector<int32_t>(prompt->begin(), prompt->end()));
+        }
+
+        const auto arrival_timestamp_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+
+        return std::make_unique<sequence::Sequence>(
+            request.request_id,
+            sequence::SequenceStatus::WAITING,
+            arrival_timestamp_ns,
+            std::move(prompt_tokens),
+            request.sampling_params,
+            std::move(logits_params),
+            std::move(stop_criteria),
+            request.ipc_handles,
+            request.scheduling_params
+        );
+    }
+
+} // namespace pie_core::ipc
@@ -0,0 +1,202 @@
+#include "ipc/request_writer.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace pie_core::ipc {
+
+    namespace {
+
+        // The engine owns (creates and sizes) the segments; producers only attach.
+        // A `size` of 0 means "whatever the engine sized it to" and is filled in.
+        void* attach_shared_segment(const std::string& name, size_t& size, int& fd) {
+            fd = shm_open(name.c_str(), O_RDWR, 0666);
+            if (fd == -1) {
+                throw std::runtime_error(
+                    "RequestWriter: shm_open('" + name + "') failed: " + std::strerror(errno));
+            }
+            if (size == 0) {
+                struct stat st{};
+                if (fstat(fd, &st) == -1 || st.st_size <= 0) {
+                    close(fd);
+                    fd = -1;
+                    throw std::runtime_error("RequestWriter: segment '" + name + "' is not initialized.");
+                }
+                size = static_cast<size_t>(st.st_size);
+            }
+            void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (ptr == MAP_FAILED) {
+                const int err = errno;
+                close(fd);
+                fd = -1;
+                throw std::runtime_error(
+                    "RequestWriter: mmap('" + name + "') failed: " + std::strerror(err));
+            }
+            return ptr;
+        }
+
+        // Appends `values` at `cursor` within the block and returns its BulkRef.
+        template <typename T>
+        BulkRef append_array(char* segment_base, uint64_t& cursor, std::span<const T> values) {
+            static_assert(alignof(T) <= alignof(BulkBlockHeader));
+            BulkRef ref{.offset = cursor, .count = static_cast<uint32_t>(values.size())};
+            if (!values.empty()) {
+                std::memcpy(segment_base + cursor, values.data(), values.size_bytes());
+            }
+            cursor += (values.size_bytes() + alignof(BulkBlockHeader) - 1) / alignof(BulkBlockHeader) * alignof(BulkBlockHeader);
+            return ref;
+        }
+
+        size_t aligned_size(size_t bytes) {
+            return (bytes + alignof(BulkBlockHeader) - 1) / alignof(BulkBlockHeader) * alignof(BulkBlockHeader);
+        }
+
+    } // namespace
+
+    RequestWriter::RequestWriter(
+        const std::string& request_shm_name,
+        const std::string& bulk_shm_name,
+        std::optional<uint32_t> shard
+    ) {
+        try {
+            request_shm_map_ptr_ = attach_shared_segment(request_shm_name, request_shm_size_, request_shm_fd_);
+            size_t bulk_size = BULK_DATA_SHM_SIZE;
+            bulk_data_map_ptr_ = attach_shared_segment(bulk_shm_name, bulk_size, bulk_data_shm_fd_);
+
+            header_ = request_segment_header(request_shm_map_ptr_);
+            const uint32_t num_shards = header_->num_shards;
+            if (num_shards == 0 || request_segment_size(num_shards) > request_shm_size_) {
+                throw std::runtime_error("RequestWriter: request segment '" + request_shm_name + "' is malformed.");
+            }
+            if (shard && *shard >= num_shards) {
+                throw std::out_of_range("RequestWriter: shard " + std::to_string(*shard) + " does not exist.");
+            }
+            shard_ = shard ? *shard : claim_shard(num_shards);
+        } catch (...) {
+            cleanup();
+            throw;
+        }
+        request_queue_.emplace(request_queue(request_shm_map_ptr_, shard_));
+        bulk_arena_.emplace(bulk_data_map_ptr_, BULK_DATA_SHM_SIZE);
+        notifier_.emplace(header_->notify_seq, header_->notify_waiters);
+    }
+
+    uint32_t RequestWriter::claim_shard(uint32_t num_shards) {
+        uint64_t claims = header_->shard_claims.load(std::memory_order_relaxed);
+        for (;;) {
+            uint32_t free_shard = num_shards;
+            for (uint32_t i = 0; i < num_shards; ++i) {
+                if (!(claims & (uint64_t{1} << i))) {
+                    free_shard = i;
+                    break;
+                }
+            }
+            if (free_shard == num_shards) {
+                // More producers than shards. Rings are MPMC, so sharing one is
+                // correct, just contended; spread the overflow by pid.
+                return static_cast<uint32_t>(getpid()) % num_shards;
+            }
+            if (header_->shard_claims.compare_exchange_weak(
+                    claims, claims | (uint64_t{1} << free_shard), std::memory_order_acq_rel)) {
+                owns_shard_ = true;
+                return free_shard;
+            }
+        }
+    }
+
+    RequestWriter::~RequestWriter() {
+        cleanup();
+    }
+
+    SubmitStatus RequestWriter::submit(
+        RequestPayload payload,
+        std::span<const int32_t> prompt,
+        std::span<const sequence::TokenBias> logit_bias,
+        std::span<const int32_t> stop_token_ids
+    ) {
+        if (header_->load.admission.load(std::memory_order_relaxed) == AdmissionState::REJECTING) {
+            return SubmitStatus::REJECTED;
+        }
+        const size_t payload_bytes =
+            aligned_size(prompt.size_bytes()) + aligned_size(logit_bias.size_bytes()) + aligned_size(stop_token_ids.size_bytes());
+        const std::optional<uint64_t> block_offset = bulk_arena_->allocate(payload_bytes);
+        if (!block_offset) {
+            return SubmitStatus::BULK_FULL;
+        }
+        BulkBlockHeader* block = bulk_arena_->block_at(*block_offset);
+
+        char* segment_base = static_cast<char*>(bulk_data_map_ptr_);
+        uint64_t cursor = *block_offset + sizeof(BulkBlockHeader);
+        payload.format_version = REQUEST_FORMAT_VERSION;
+        payload.lease = BulkRef{.offset = *block_offset, .count = block->size.load(std::memory_order_relaxed)};
+        payload.prompt = append_array(segment_base, cursor, prompt);
+        payload.logit_bias = append_array(segment_base, cursor, logit_bias);
+        payload.stop_token_ids = append_array(segment_base, cursor, stop_token_ids);
+
+        uint64_t pos = 0;
+        RequestSlot* slot = request_queue_->try_claim(pos);
+        if (slot == nullptr) {
+            // Never published: hand the block straight back.
+            BulkArena::release(*block);
+            return SubmitStatus::QUEUE_FULL;
+        }
+        slot->payload = payload;
+
+        request_queue_->publish(pos);
+        notifier_->notify();
+        return SubmitStatus::ACCEPTED;
+    }
+
+    LoadSnapshot RequestWriter::load() const noexcept {
+        const EngineLoad& load = header_->load;
+        const auto now_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        const uint64_t updated_at_ns = load.updated_at_ns.load(std::memory_order_relaxed);
+        return LoadSnapshot{
+            .admission = load.admission.load(std::memory_order_relaxed),
+            .retry_after_ms = load.retry_after_ms.load(std::memory_order_relaxed),
+            .free_request_slots = static_cast<uint32_t>(request_queue_->capacity() - request_queue_->size_approx()),
+            .free_kv_pages = load.free_kv_pages.load(std::memory_order_relaxed),
+            .total_kv_pages = load.total_kv_pages.load(std::memory_order_relaxed),
+            .waiting_sequences = load.waiting_sequences.load(std::memory_order_relaxed),
+            .running_sequences = load.running_sequences.load(std::memory_order_relaxed),
+            .estimated_ttft_us = load.estimated_ttft_us.load(std::memory_order_relaxed),
+            .age_us = now_ns > updated_at_ns ? (now_ns - updated_at_ns) / 1000 : 0
+        };
+    }
+
+    void RequestWriter::cleanup() {
+        notifier_.reset();
+        bulk_arena_.reset();
+        request_queue_.reset();
+        if (owns_shard_) {
+            header_->shard_claims.fetch_and(~(uint64_t{1} << shard_), std::memory_order_acq_rel);
+            owns_shard_ = false;
+        }
+        header_ = nullptr;
+        if (bulk_data_map_ptr_ != nullptr) {
+            munmap(bulk_data_map_ptr_, BULK_DATA_SHM_SIZE);
+            bulk_data_map_ptr_ = nullptr;
+        }
+        if (bulk_data_shm_fd_ != -1) {
+            close(bulk_data_shm_fd_);
+            bulk_data_shm_fd_ = -1;
+        }
+        if (request_shm_map_ptr_ != nullptr) {
+            munmap(request_shm_map_ptr_, request_shm_size_);
+            request_shm_map_ptr_ = nullptr;
+        }
+        if (request_shm_fd_ != -1) {
+            close(request_shm_fd_);
+            request_shm_fd_ = -1;
+        }
+    }
+
+} // namespace pie_core::ipc
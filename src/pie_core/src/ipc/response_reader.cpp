@@ -0,0 +1,95 @@
+#include "ipc/response_reader.hpp"
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace pie_core::ipc {
+
+    ResponseReader::ResponseReader(const std::string& response_shm_name) {
+        // The engine owns (creates and sizes) the segment; clients only attach.
+        response_shm_fd_ = shm_open(response_shm_name.c_str(), O_RDWR, 0666);
+        if (response_shm_fd_ == -1) {
+            throw std::runtime_error(
+                "ResponseReader: shm_open('" + response_shm_name + "') failed: " + std::strerror(errno));
+        }
+        void* ptr = mmap(nullptr, RESPONSE_SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, response_shm_fd_, 0);
+        if (ptr == MAP_FAILED) {
+            const int err = errno;
+            cleanup();
+            throw std::runtime_error(
+                "ResponseReader: mmap('" + response_shm_name + "') failed: " + std::strerror(err));
+        }
+        response_shm_map_ptr_ = ptr;
+        control_ = response_control(response_shm_map_ptr_);
+        if (control_->format_version != RESPONSE_FORMAT_VERSION) {
+            const uint32_t found = control_->format_version;
+            cleanup();
+            throw std::runtime_error(
+                "ResponseReader: engine speaks response format " + std::to_string(found)
+                + ", expected " + std::to_string(RESPONSE_FORMAT_VERSION));
+        }
+        channels_ = response_channels(response_shm_map_ptr_);
+        notifier_.emplace(control_->notify_seq, control_->notify_waiters);
+    }
+
+    ResponseReader::~ResponseReader() {
+        cleanup();
+    }
+
+    std::optional<uint64_t> ResponseReader::claim_channel() {
+        const uint32_t start = control_->claim_hint.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < RESPONSE_NUM_CHANNELS; ++i) {
+            const uint64_t channel_id = (start + i) % RESPONSE_NUM_CHANNELS;
+            ResponseChannel& candidate = channels_[channel_id];
+            auto expected = ResponseChannelState::FREE;
+            if (candidate.state.compare_exchange_strong(
+                    expected, ResponseChannelState::CLAIMED, std::memory_order_acq_rel)) {
+                // The previous owner read everything up to its final entry, so
+                // nothing unread can be lost here; just start from the writer.
+                candidate.read_idx.store(
+                    candidate.write_idx.load(std::memory_order_acquire), std::memory_order_release);
+                candidate.cancel.store(0, std::memory_order_release);
+                return channel_id;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void ResponseReader::release_channel(uint64_t channel_id) {
+        channel(channel_id).state.store(ResponseChannelState::FREE, std::memory_order_release);
+    }
+
+    void ResponseReader::cancel(uint64_t channel_id) {
+        channel(channel_id).cancel.store(1, std::memory_order_release);
+    }
+
+    size_t ResponseReader::read(uint64_t channel_id, ResponseEntry* out, size_t max) {
+        return channel(channel_id).pop(out, max);
+    }
+
+    ResponseChannel& ResponseReader::channel(uint64_t channel_id) {
+        if (channel_id >= RESPONSE_NUM_CHANNELS) {
+            throw std::out_of_range("ResponseReader: invalid channel " + std::to_string(channel_id));
+        }
+        return channels_[channel_id];
+    }
+
+    void ResponseReader::cleanup() {
+        notifier_.reset();
+        channels_ = nullptr;
+        control_ = nullptr;
+        if (response_shm_map_ptr_ != nullptr) {
+            munmap(response_shm_map_ptr_, RESPONSE_SHM_SIZE);
+            response_shm_map_ptr_ = nullptr;
+        }
+        if (response_shm_fd_ != -1) {
+            close(response_shm_fd_);
+            response_shm_fd_ = -1;
+        }
+    }
+
+} // namespace pie_core::ipc
@@ -0,0 +1,202 @@
+#include "ipc/response_writer.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <spdlog/spdlog.h>
+
+namespace pie_core::ipc {
+
+    ResponseWriter::ResponseWriter(const std::string& response_shm_name)
+        : response_shm_name_(response_shm_name)
+    {
+        response_shm_fd_ = shm_open(response_shm_name_.c_str(), O_CREAT | O_RDWR, 0666);
+        if (response_shm_fd_ == -1) {
+            throw std::runtime_error(
+                "ResponseWriter: shm_open('" + response_shm_name_ + "') failed: " + std::strerror(errno));
+        }
+        if (ftruncate(response_shm_fd_, static_cast<off_t>(RESPONSE_SHM_SIZE)) == -1) {
+            const int err = errno;
+            cleanup();
+            throw std::runtime_error(
+                "ResponseWriter: ftruncate('" + response_shm_name_ + "') failed: " + std::strerror(err));
+        }
+        void* ptr = mmap(nullptr, RESPONSE_SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, response_shm_fd_, 0);
+        if (ptr == MAP_FAILED) {
+            const int err = errno;
+            cleanup();
+            throw std::runtime_error(
+                "ResponseWriter: mmap('" + response_shm_name_ + "') failed: " + std::strerror(err));
+        }
+        response_shm_map_ptr_ = ptr;
+
+        // The engine owns the segment: reset it before any client attaches.
+        ResponseControl* control = new (response_shm_map_ptr_) ResponseControl{};
+        channels_ = response_channels(response_shm_map_ptr_);
+        for (size_t i = 0; i < RESPONSE_NUM_CHANNELS; ++i) {
+            channels_[i].write_idx.store(0, std::memory_order_relaxed);
+            channels_[i].read_idx.store(0, std::memory_order_relaxed);
+            channels_[i].cancel.store(0, std::memory_order_relaxed);
+            channels_[i].state.store(ResponseChannelState::FREE, std::memory_order_release);
+        }
+        notifier_.emplace(control->notify_seq, control->notify_waiters);
+        spdlog::info("ResponseWriter: serving {} channels on '{}'.", RESPONSE_NUM_CHANNELS, response_shm_name_);
+    }
+
+    ResponseWriter::~ResponseWriter() {
+        cleanup();
+    }
+
+    bool ResponseWriter::emit(
+        uint64_t channel_id,
+        int32_t token_id,
+        std::optional<float> logprob,
+        std::string_view text,
+        FinishReason finish_reason
+    ) {
+        if (channel_id >= RESPONSE_NUM_CHANNELS) {
+            spdlog::warn("ResponseWriter: dropping output for invalid channel {}.", channel_id);
+            return false;
+        }
+
+        // One entry per RESPONSE_TEXT_CAPACITY bytes of text; the token rides on the last.
+        // A single token never decodes to more than a few bytes, but cap the run so
+        // it always fits in an empty channel.
+        text = text.substr(0, MAX_TEXT_ENTRIES * RESPONSE_TEXT_CAPACITY);
+        const size_t num_entries =
+            std::max<size_t>(1, (text.size() + RESPONSE_TEXT_CAPACITY - 1) / RESPONSE_TEXT_CAPACITY);
+        scratch_.resize(num_entries);
+        for (size_t i = 0; i < num_entries; ++i) {
+            ResponseEntry& entry = scratch_[i];
+            const std::string_view chunk = text.substr(
+                std::min(text.size(), i * RESPONSE_TEXT_CAPACITY), RESPONSE_TEXT_CAPACITY);
+            std::memcpy(entry.text, chunk.data(), chunk.size());
+            entry.text_len = static_cast<uint16_t>(chunk.size());
+            if (i + 1 < num_entries) {
+                entry.token_id = -1;
+                entry.logprob = 0.0f;
+                entry.flags = RESPONSE_TEXT_CONTINUES;
+                entry.finish_reason = FinishReason::NONE;
+            } else {
+                entry.token_id = token_id;
+                entry.logprob = logprob.value_or(0.0f);
+                entry.flags = logprob ? RESPONSE_HAS_LOGPROB : 0;
+                entry.finish_reason = finish_reason;
+            }
+        }
+        publish(channel_id, scratch_.data(), num_entries);
+        return true;
+    }
+
+    bool ResponseWriter::finish(uint64_t channel_id, FinishReason finish_reason) {
+        return emit(channel_id, -1, std::nullopt, {}, finish_reason);
+    }
+
+    const std::atomic<uint32_t>* ResponseWriter::cancel_word(uint64_t channel_id) const noexcept {
+        return channel_id < RESPONSE_NUM_CHANNELS ? &channels_[channel_id].cancel : nullptr;
+    }
+
+    void ResponseWriter::publish(uint64_t channel_id, const ResponseEntry* entries, size_t count) {
+        if (abandoned_.contains(channel_id)) {
+            if (entries[count - 1].finish_reason != FinishReason::NONE) {
+                abandoned_.erase(channel_id); // The request is over; the channel is clean again
+            }
+            return;
+        }
+        auto backlog = backlog_.find(channel_id);
+        if (channels_[channel_id].state.load(std::memory_order_acquire) == ResponseChannelState::FREE) {
+            // Released by its client: nobody will read this.
+            if (backlog != backlog_.end()) {
+                backlog_entries_ -= backlog->second.size();
+                backlog_.erase(backlog);
+            }
+            return;
+        }
+        // Never overtake entries that are already waiting.
+        if (backlog == backlog_.end() && channels_[channel_id].try_push(entries, count)) {
+            published_since_flush_ = true;
+            return;
+        }
+        auto& pending = backlog == backlog_.end() ? backlog_[channel_id] : backlog->second;
+        pending.insert(pending.end(), entries, entries + count);
+        backlog_entries_ += count;
+        if (pending.size() > MAX_BACKLOG_ENTRIES) {
+            abandon(channel_id, pending);
+        }
+    }
+
+    void ResponseWriter::abandon(uint64_t channel_id, std::deque<ResponseEntry>& pending) {
+        spdlog::warn("ResponseWriter: channel {} stopped reading; ending its stream.", channel_id);
+        const bool engine_finished = pending.back().finish_reason != FinishReason::NONE;
+        backlog_entries_ -= pending.size();
+        pending.clear();
+        ResponseEntry& error = pending.emplace_back();
+        error.token_id = -1;
+        error.finish_reason = FinishReason::ERROR;
+        backlog_entries_ += 1;
+        if (!engine_finished) {
+            // Stop generating for it; the engine's final entry ends the drop.
+            abandoned_.insert(channel_id);
+            channels_[channel_id].cancel.store(1, std::memory_order_release);
+        }
+    }
+
+    void ResponseWriter::flush() {
+        for (auto it = backlog_.begin(); it != backlog_.end();) {
+            ResponseChannel& channel = channels_[it->first];
+            auto& pending = it->second;
+            if (channel.state.load(std::memory_order_acquire) == ResponseChannelState::FREE) {
+                // Released by its client: nobody will read this, and the next
+                // owner must not.
+                backlog_entries_ -= pending.size();
+                it = backlog_.erase(it);
+                continue;
+            }
+            // Whole continuation runs only, so a client never reads half a token's text.
+            size_t count = 0;
+            size_t run_end = 0;
+            const size_t limit = std::min(pending.size(), channel.free_entries());
+            for (size_t i = 0; i < limit; ++i) {
+                if (!(pending[i].flags & RESPONSE_TEXT_CONTINUES)) {
+                    run_end = i + 1;
+                }
+            }
+            if (run_end > 0) {
+                scratch_.assign(pending.begin(), pending.begin() + run_end);
+                channel.try_push(scratch_.data(), run_end);
+                pending.erase(pending.begin(), pending.begin() + run_end);
+                count = run_end;
+            }
+            if (count > 0) {
+                published_since_flush_ = true;
+                backlog_entries_ -= count;
+            }
+            it = pending.empty() ? backlog_.erase(it) : std::next(it);
+        }
+        if (published_since_flush_) {
+            published_since_flush_ = false;
+            notifier_->notify();
+        }
+    }
+
+    void ResponseWriter::cleanup() {
+        notifier_.reset();
+        channels_ = nullptr;
+        if (response_shm_map_ptr_ != nullptr) {
+            munmap(response_shm_map_ptr_, RESPONSE_SHM_SIZE);
+            response_shm_map_ptr_ = nullptr;
+        }
+        if (response_shm_fd_ != -1) {
+            close(response_shm_fd_);
+            response_shm_fd_ = -1;
+            shm_unlink(response_shm_name_.c_str());
+        }
+    }
+
+} // namespace pie_core::ipc
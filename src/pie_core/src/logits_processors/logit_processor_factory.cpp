@@ -18,7 +18,7 @@ namespace pie_core::logit_processors {
             processors.push_back(create_processor("repetition"));
         }
 
-        // Add logit bias processor if logit_bias map is not empty
+        // Add logit bias processor if logit_bias is not empty
         if (!params.logit_bias.empty()) {
             processors.push_back(create_processor("logit_bias"));
         }
@@ -1,131 +1,283 @@
 // src/pie_core/src/engine_main.cpp
 #include <iostream>
-#include <vector>
+#include <iterator>
 #include <thread>
 #include <chrono>
-#include <sys/mman.h> // mmap, shm_open
-#include <sys/stat.h> // For mode constants
-#include <fcntl.h>    // For O_* constants
-#include <unistd.h>   // ftruncate, close
-#include <sys/event.h> // kqueue
+#include <cmath>
+#include <limits>
 #include <csignal>    // signal handling
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
-#include "ipc/ipc_defs.hpp"
+#include "ipc/ipc_reader.hpp"
+#include "ipc/response_writer.hpp"
+#include "ipc/spsc_queue.hpp"
+#include "engine/batch_policy.hpp"
+#include "engine/fair_share.hpp"
+#include "engine/page_allocator.hpp"
+#include "engine/scheduler.hpp"
+#include "engine/token_sink.hpp"
+#include "models/model_factory.hpp"
+#include "server/detokenizer.hpp"
+#include "server/http_server.hpp"
 
 // --- Global variables (simplify for now, use classes later) ---
-void* shm_ptr = nullptr;
-int kqueue_fd = -1;
-int shm_fd = -1;
-volatile bool running = true;
+std::atomic<bool> running{true};
+pie_core::ipc::IPCReader* ipc_reader = nullptr;
+pie_core::engine::Scheduler::SequenceQueue* incoming_sequences = nullptr;
+pie_core::server::HttpServer* http_server = nullptr;
 // ---
 
 void signal_handler(int signum) {
-    std::cout << "Signal (" << signum << ") received. Shutting down." << std::endl;
+    // Only async-signal-safe work here: flip the flag and kick both threads out
+    // of their futex waits (stop() and wake() are atomics plus a syscall).
     running = false;
+    if (ipc_reader) {
+        ipc_reader->stop();
+    }
+    if (incoming_sequences) {
+        incoming_sequences->wake();
+    }
+    if (http_server) {
+        http_server->stop();
+    }
+    (void)signum;
 }
 
-// --- Placeholder for Scheduler Thread ---
-void scheduler_loop() {
-    std::cout << "Scheduler thread started." << std::endl;
-    pie_core::ipc::RequestSlot* slots = static_cast<pie_core::ipc::RequestSlot*>(shm_ptr);
-
-    while(running) {
-        // --- TODO: Milestone 6: Replace this polling with kqueue wait ---
-        std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Poll interval
-
-        // --- Milestone 3: Implement polling consumer logic ---
-        std::cout << "Scheduler checking for requests..." << std::endl;
-         // Simplified check - a real implementation needs careful indexing
-        for (size_t i = 0; i < pie_core::ipc::NUM_SLOTS; ++i) {
-             // Naive scan - better: use consumer_idx & check producer_idx
-             uint32_t expected_state = 2; // READY
-             if (slots[i].state.compare_exchange_strong(expected_state, 0, std::memory_order_acq_rel)) {
-                  // Successfully claimed a READY slot and marked it FREE (0)
-                  std::cout << "Scheduler received request ID: "
-                            << slots[i].request_id << std::endl;
-                  // TODO: Process the request data (copy out, add to internal queue)
-             }
+constexpr const char* USAGE =
+    " <model_path> [num_kv_pages] [--http PORT] [--batch-policy NAME] [--target-step-ms MS]"
+    " [--decode-steps K] [--kv-watermark FRACTION] [--tenant ID:WEIGHT[:TOKENS_PER_SEC]]...";
+
+// Command-line values are parsed whole: "12abc" or "-1" is an error, not 12
+// or a wrapped-around count.
+uint64_t parse_unsigned(const std::string& flag, const std::string& text, uint64_t max) {
+    size_t parsed = 0;
+    uint64_t value = 0;
+    try {
+        if (!text.empty() && text.front() != '-') {
+            value = std::stoull(text, &parsed);
         }
-        // --- End Milestone 3 ---
+    } catch (const std::exception&) {
+        parsed = 0;
     }
-    std::cout << "Scheduler thread exiting." << std::endl;
+    if (parsed == 0 || parsed != text.size() || value > max) {
+        throw std::invalid_argument(
+            flag + " expects an integer from 0 to " + std::to_string(max) + ", got '" + text + "'.");
+    }
+    return value;
 }
-// ---
 
-int main(int argc, char *argv[]) {
-    std::cout << "Starting PIE Engine Process..." << std::endl;
-    std::cout << "argc: " << argc << std::endl;
-    if (argc > 1) {
-        std::cout << "argv[0]: " << argv[0] << std::endl;
+double parse_number(const std::string& flag, const std::string& text) {
+    size_t parsed = 0;
+    double value = 0.0;
+    try {
+        value = std::stod(text, &parsed);
+    } catch (const std::exception&) {
+        parsed = 0;
     }
+    if (parsed == 0 || parsed != text.size() || !std::isfinite(value)) {
+        throw std::invalid_argument(flag + " expects a number, got '" + text + "'.");
+    }
+    return value;
+}
 
-    // --- Milestone 1 & 2: Setup Shared Memory & kqueue ---
-    // Create/Open Shared Memory
-    shm_fd = shm_open(pie_core::ipc::SHM_NAME, O_CREAT | O_RDWR, 0666);
-    if (shm_fd == -1) {
-        perror("shm_open");
-        return 1;
+// Parses "ID:WEIGHT[:TOKENS_PER_SEC]".
+std::pair<uint32_t, pie_core::engine::TenantPolicy> parse_tenant(const std::string& spec) {
+    const size_t first = spec.find(':');
+    if (first == std::string::npos) {
+        throw std::invalid_argument("--tenant expects ID:WEIGHT[:TOKENS_PER_SEC], got '" + spec + "'.");
     }
-    if (ftruncate(shm_fd, pie_core::ipc::SHM_SIZE) == -1) {
-        perror("ftruncate");
-        close(shm_fd);
-        shm_unlink(pie_core::ipc::SHM_NAME); // Clean up on error
-        return 1;
+    const size_t second = spec.find(':', first + 1);
+    pie_core::engine::TenantPolicy policy;
+    policy.weight = parse_number("--tenant weight", spec.substr(first + 1, second - first - 1));
+    if (second != std::string::npos) {
+        policy.tokens_per_second = parse_number("--tenant rate", spec.substr(second + 1));
     }
-    shm_ptr = mmap(nullptr, pie_core::ipc::SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
-    if (shm_ptr == MAP_FAILED) {
-        perror("mmap");
-        close(shm_fd);
-        shm_unlink(pie_core::ipc::SHM_NAME);
-        return 1;
+    if (policy.weight <= 0.0 || policy.tokens_per_second < 0.0) {
+        throw std::invalid_argument("--tenant needs a positive weight and a rate of at least 0, got '" + spec + "'.");
     }
-    std::cout << "Shared memory '" << pie_core::ipc::SHM_NAME << "' created/mapped." << std::endl;
+    const auto tenant_id = parse_unsigned("--tenant id", spec.substr(0, first), std::numeric_limits<uint32_t>::max());
+    return {static_cast<uint32_t>(tenant_id), policy};
+}
 
-    // Create kqueue
-    kqueue_fd = kqueue();
-    if (kqueue_fd == -1) {
-        perror("kqueue");
-        // Cleanup shm
-        munmap(shm_ptr, pie_core::ipc::SHM_SIZE);
-        close(shm_fd);
-        shm_unlink(pie_core::ipc::SHM_NAME);
-        return 1;
+struct Options {
+    std::string model_path;
+    size_t num_kv_pages = 4096;
+    std::optional<uint16_t> http_port;
+    std::unique_ptr<pie_core::engine::IBatchPolicy> batch_policy;
+    double target_step_ms = 0.0;
+    size_t decode_steps = 1;
+    double kv_watermark = 0.0;
+    std::vector<std::pair<uint32_t, pie_core::engine::TenantPolicy>> tenants;
+};
+
+// @throws std::invalid_argument on a missing or malformed argument.
+Options parse_options(std::vector<std::string> args) {
+    Options options;
+    std::vector<std::string> positional;
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& flag = args[i];
+        if (!flag.starts_with("--")) {
+            positional.push_back(flag);
+            continue;
+        }
+        if (i + 1 >= args.size()) {
+            throw std::invalid_argument(flag + " expects a value.");
+        }
+        const std::string& value = args[++i];
+        if (flag == "--http") {
+            const uint64_t port = parse_unsigned(flag, value, std::numeric_limits<uint16_t>::max());
+            if (port == 0) {
+                throw std::invalid_argument("--http expects a port from 1 to 65535, got '" + value + "'.");
+            }
+            options.http_port = static_cast<uint16_t>(port);
+        } else if (flag == "--batch-policy") {
+            try {
+                options.batch_policy = pie_core::engine::BatchPolicyRegistry::create_policy(value);
+            } catch (const std::runtime_error& e) {
+                throw std::invalid_argument(e.what());
+            }
+        } else if (flag == "--target-step-ms") {
+            options.target_step_ms = parse_number(flag, value);
+            if (options.target_step_ms < 0.0) {
+                throw std::invalid_argument("--target-step-ms must not be negative.");
+            }
+        } else if (flag == "--decode-steps") {
+            options.decode_steps = parse_unsigned(flag, value, std::numeric_limits<uint32_t>::max());
+            if (options.decode_steps == 0) {
+                throw std::invalid_argument("--decode-steps must be at least 1.");
+            }
+        } else if (flag == "--kv-watermark") {
+            options.kv_watermark = parse_number(flag, value);
+            if (options.kv_watermark < 0.0 || options.kv_watermark >= 1.0) {
+                throw std::invalid_argument("--kv-watermark must be in [0, 1).");
+            }
+        } else if (flag == "--tenant") {
+            options.tenants.push_back(parse_tenant(value));
+        } else {
+            throw std::invalid_argument("Unknown option " + flag + ".");
+        }
     }
+    if (!options.batch_policy) {
+        options.batch_policy = pie_core::engine::BatchPolicyRegistry::create_policy("hybrid");
+    }
+    if (positional.empty() || positional.size() > 2) {
+        throw std::invalid_argument("Expected a model path and optionally a KV page count.");
+    }
+    options.model_path = positional[0];
+    if (positional.size() > 1) {
+        options.num_kv_pages = parse_unsigned("num_kv_pages", positional[1], std::numeric_limits<uint32_t>::max());
+    }
+    return options;
+}
+
+// --- Scheduler Thread ---
+void scheduler_loop(pie_core::engine::Scheduler& scheduler) {
+    std::cout << "Scheduler thread started." << std::endl;
+    while (running) {
+        if (!scheduler.step()) {
+            // Nothing runnable: sleep until the IPC reader hands over a sequence;
+            // the timeout only bounds how long a shutdown can go unnoticed.
+            scheduler.wait_for_work(std::chrono::milliseconds(100));
+        }
+    }
+    std::cout << "Scheduler thread exiting." << std::endl;
+}
+// ---
 
-    // Register user event filter
-    struct kevent change;
-    EV_SET(&change, 1, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, nullptr);
-    if (kevent(kqueue_fd, &change, 1, nullptr, 0, nullptr) == -1) {
-        perror("kevent register");
-        // Cleanup kqueue and shm
-        close(kqueue_fd);
-        munmap(shm_ptr, pie_core::ipc::SHM_SIZE);
-        close(shm_fd);
-        shm_unlink(pie_core::ipc::SHM_NAME);
+int main(int argc, char *argv[]) {
+    std::cout << "Starting PIE Engine Process..." << std::endl;
+    Options options;
+    try {
+        options = parse_options(std::vector<std::string>(argv + 1, argv + argc));
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << "\nusage: " << argv[0] << USAGE << std::endl;
         return 1;
     }
-    std::cout << "kqueue created (fd=" << kqueue_fd << ") and user event registered." << std::endl;
-    // --- End Milestone 1 & 2 ---
+    const std::string& model_path = options.model_path;
+    const size_t num_kv_pages = options.num_kv_pages;
 
-    // TODO: Initialize PageAllocator, Scheduler
+    try {
+        // --- Model & KV cache ---
+        std::unique_ptr<pie_core::models::IModel> model = pie_core::models::load_model(model_path);
+        pie_core::engine::PageAllocator allocator(
+            num_kv_pages, model->get_num_kv_heads(), model->get_head_dim());
+        std::cout << "Model loaded from '" << model_path << "' with "
+                  << num_kv_pages << " KV pages." << std::endl;
 
-    // Start Scheduler Thread
-    std::thread scheduler_thread(scheduler_loop);
+        // --- IPC: requests in, tokens out ---
+        // Both constructors create and reset their shared-memory segments, so
+        // they must run before any client attaches.
+        pie_core::engine::Scheduler::SequenceQueue sequences(1024);
+        pie_core::ipc::IPCReader reader(sequences);
+        pie_core::ipc::ResponseWriter responses;
+        pie_core::engine::ResponseChannelSink response_sink(responses);
+        pie_core::engine::Scheduler scheduler(allocator, std::move(model), sequences, &response_sink);
+        scheduler.set_batch_policy(std::move(options.batch_policy));
+        scheduler.set_target_step_time(std::chrono::microseconds(static_cast<int64_t>(options.target_step_ms * 1000.0)));
+        scheduler.set_decode_steps(options.decode_steps);
+        scheduler.set_kv_watermark(options.kv_watermark);
+        for (const auto& [tenant_id, policy] : options.tenants) {
+            scheduler.set_tenant_policy(tenant_id, policy);
+        }
+        // Producers read live load and admission state from the request control block.
+        scheduler.publish_load_to(&reader.engine_load());
 
-    // Handle signals for graceful shutdown
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
+        // --- Optional built-in HTTP front end ---
+        // Attaches to the segments above like any other producer.
+        std::optional<pie_core::server::Detokenizer> detokenizer;
+        std::unique_ptr<pie_core::server::HttpServer> server;
+        if (options.http_port) {
+            detokenizer.emplace(model_path + "/tokenizer.json");
+            server = std::make_unique<pie_core::server::HttpServer>(
+                pie_core::server::HttpServerConfig{
+                    .port = *options.http_port,
+                    .model_name = model_path,
+                    .eos_token_ids = pie_core::server::read_eos_token_ids(model_path)
+                },
+                *detokenizer);
+        }
 
-    // Keep main thread alive (or do other work)
-    scheduler_thread.join(); // Wait for scheduler to finish
+        ipc_reader = &reader;
+        incoming_sequences = &sequences;
+        http_server = server.get();
+        signal(SIGINT, signal_handler);
+        signal(SIGTERM, signal_handler);
 
-    // Cleanup
-    std::cout << "Cleaning up resources..." << std::endl;
-    close(kqueue_fd);
-    munmap(shm_ptr, pie_core::ipc::SHM_SIZE);
-    close(shm_fd);
-    shm_unlink(pie_core::ipc::SHM_NAME); // Remove shared memory object name
-    std::cout << "PIE Engine Process finished." << std::endl;
+        std::thread reader_thread([&reader] { reader.run(); });
+        std::thread scheduler_thread([&scheduler] { scheduler_loop(scheduler); });
+        std::thread http_thread;
+        if (server) {
+            http_thread = std::thread([&server] { server->run(); });
+        }
 
+        scheduler_thread.join();
+        reader.stop();
+        reader_thread.join();
+        if (server) {
+            server->stop();
+            http_thread.join();
+        }
+        // Sequences still in the hand-off queue borrow their prompts from the
+        // reader's bulk segment: drop them while it is still mapped.
+        std::vector<std::unique_ptr<pie_core::sequence::Sequence>> unscheduled;
+        sequences.pop_batch(std::back_inserter(unscheduled));
+        unscheduled.clear();
+
+        ipc_reader = nullptr;
+        incoming_sequences = nullptr;
+        http_server = nullptr;
+        std::cout << "Cleaning up resources..." << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "PIE Engine failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "PIE Engine Process finished." << std::endl;
     return 0;
 }
@@ -0,0 +1,134 @@
+#include "sequence/sequence.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace pie_core::sequence {
+
+    Sequence::Sequence(
+        uint64_t sequence_id,
+        SequenceStatus status,
+        uint64_t arrival_timestamp_ns,
+        Prompt prompt,
+        const SamplingParams& sampling_params,
+        LogitsParams logits_params,
+        StopCriteria stop_criteria,
+        const IPCHandles& ipc_handles,
+        const SchedulingParams& scheduling_params
+    ) : sequence_id(sequence_id),
+        status(status),
+        arrival_timestamp_ns(arrival_timestamp_ns),
+        prompt(std::move(prompt)),
+        prompt_len(this->prompt.size()),
+        sampling_params(sampling_params),
+        logits_params(std::move(logits_params)),
+        stop_criteria(std::move(stop_criteria)),
+        scheduling_params(scheduling_params),
+        deadline_ns(scheduling_params.ttft_deadline_ms == 0
+            ? 0
+            : arrival_timestamp_ns + uint64_t{scheduling_params.ttft_deadline_ms} * 1'000'000),
+        ipc_handles(ipc_handles)
+    {}
+
+    size_t Sequence::get_generation_len() const {
+        return generated_tokens.size();
+    }
+
+    size_t Sequence::get_logical_len() const {
+        return prompt_len + generated_tokens.size();
+    }
+
+    bool Sequence::is_finished() const {
+        if (status == SequenceStatus::COMPLETED || status == SequenceStatus::ERROR) {
+            return true;
+        }
+        if (cancelled.load(std::memory_order_acquire)) {
+            return true;
+        }
+        if (get_generation_len() >= static_cast<size_t>(stop_criteria.max_generated_tokens)) {
+            return true;
+        }
+        if (get_generation_len() == 0) {
+            return false;
+        }
+        const auto& stop_ids = stop_criteria.stop_token_ids;
+        return std::find(stop_ids.begin(), stop_ids.end(), generated_tokens.back()) != stop_ids.end();
+    }
+
+    void Sequence::check_readable(size_t start, size_t end) const {
+        if (start < released_prompt_prefix_ || end > get_logical_len()) {
+            throw std::out_of_range(
+                "Sequence " + std::to_string(sequence_id) + ": tokens [" + std::to_string(start) + ", "
+                + std::to_string(end) + ") are released or past its end.");
+        }
+    }
+
+    int32_t Sequence::token_at(size_t logical_index) const {
+        check_readable(logical_index, logical_index + 1);
+        if (logical_index < prompt_len) {
+            return prompt.tokens()[logical_index - released_prompt_prefix_];
+        }
+        return generated_tokens[logical_index - prompt_len];
+    }
+
+    int32_t Sequence::last_token() const {
+        return token_at(get_logical_len() - 1);
+    }
+
+    void Sequence::copy_tokens(size_t start, size_t count, int32_t* out) const {
+        const size_t end = start + count;
+        if (count == 0) {
+            return;
+        }
+        check_readable(start, end);
+        if (start < prompt_len) {
+            const auto prompt_tokens = prompt.tokens();
+            const size_t prompt_end = std::min(end, prompt_len);
+            out = std::copy(
+                prompt_tokens.begin() + (start - released_prompt_prefix_),
+                prompt_tokens.begin() + (prompt_end - released_prompt_prefix_),
+                out);
+            start = prompt_end;
+        }
+        if (start < end) {
+            std::copy(
+                generated_tokens.begin() + (start - prompt_len),
+                generated_tokens.begin() + (end - prompt_len),
+                out);
+        }
+    }
+
+    void Sequence::release_prompt(size_t keep_tail) {
+        if (!prompt.is_borrowed()) {
+            return;
+        }
+        const size_t keep = std::clamp<size_t>(keep_tail, 1, prompt.size());
+        const auto tokens = prompt.tokens();
+        // Assigning the owned tail runs the borrowed prompt's release hook.
+        prompt = Prompt(std::vector<int32_t>(tokens.end() - keep, tokens.end()));
+        released_prompt_prefix_ = prompt_len - keep;
+    }
+
+    void Sequence::cap_generation(size_t max_generated_tokens) {
+        if (max_generated_tokens < static_cast<size_t>(std::max(stop_criteria.max_generated_tokens, 0))) {
+            stop_criteria.max_generated_tokens = static_cast<int>(max_generated_tokens);
+        }
+    }
+
+    void Sequence::append_token(int32_t token_id) {
+        generated_tokens.push_back(token_id);
+    }
+
+    void Sequence::append_page(uint32_t page_id) {
+        page_table.push_back(page_id);
+    }
+
+    std::optional<uint32_t> Sequence::get_physical_page(size_t logical_block_index) const {
+        if (logical_block_index >= page_table.size()) {
+            return std::nullopt;
+        }
+        return page_table[logical_block_index];
+    }
+
+} // namespace pie_core::sequence
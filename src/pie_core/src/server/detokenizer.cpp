@@ -0,0 +1,196 @@
+#include "server/detokenizer.hpp"
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <nlohmann/json.hpp>
+
+namespace pie_core::server {
+
+    namespace {
+
+        // Inverse of GPT-2's bytes_to_unicode(): printable bytes stand for
+        // themselves, the rest were shifted to code points 256 and up.
+        std::array<int, 512> byte_level_decoder() {
+            std::array<int, 512> decoder{};
+            decoder.fill(-1);
+            int shifted = 0;
+            for (int byte = 0; byte < 256; ++byte) {
+                const bool printable = (byte >= '!' && byte <= '~') || (byte >= 0xA1 && byte <= 0xAC) || byte >= 0xAE;
+                decoder[printable ? byte : 256 + shifted++] = byte;
+            }
+            return decoder;
+        }
+
+        // Decodes one code point; advances `i`. Returns -1 on malformed input.
+        int32_t next_code_point(std::string_view text, size_t& i) {
+            const auto lead = static_cast<unsigned char>(text[i]);
+            const size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+            if (length == 0 || i + length > text.size()) {
+                ++i;
+                return -1;
+            }
+            int32_t code_point = length == 1 ? lead : lead & (0x7F >> length);
+            for (size_t k = 1; k < length; ++k) {
+                code_point = (code_point << 6) | (static_cast<unsigned char>(text[i + k]) & 0x3F);
+            }
+            i += length;
+            return code_point;
+        }
+
+        std::string decode_byte_level(std::string_view piece, const std::array<int, 512>& decoder) {
+            std::string bytes;
+            for (size_t i = 0; i < piece.size();) {
+                const int32_t code_point = next_code_point(piece, i);
+                if (code_point >= 0 && code_point < static_cast<int32_t>(decoder.size()) && decoder[code_point] >= 0) {
+                    bytes.push_back(static_cast<char>(decoder[code_point]));
+                }
+            }
+            return bytes;
+        }
+
+        std::string decode_sentencepiece(std::string_view piece) {
+            // Byte fallback: <0x0A> and friends.
+            if (piece.size() == 6 && piece.starts_with("<0x") && piece.ends_with('>')) {
+                return std::string(1, static_cast<char>(std::stoi(std::string(piece.substr(3, 2)), nullptr, 16)));
+            }
+            static constexpr std::string_view META_SPACE = "\xE2\x96\x81"; // U+2581
+            std::string text;
+            text.reserve(piece.size());
+            for (size_t i = 0; i < piece.size();) {
+                if (piece.substr(i, META_SPACE.size()) == META_SPACE) {
+                    text.push_back(' ');
+                    i += META_SPACE.size();
+                } else {
+                    text.push_back(piece[i++]);
+                }
+            }
+            return text;
+        }
+
+        bool uses_byte_level(const nlohmann::json& decoder) {
+            if (!decoder.is_object()) {
+                return false;
+            }
+            if (decoder.value("type", "") == "ByteLevel") {
+                return true;
+            }
+            if (decoder.contains("decoders")) {
+                for (const auto& inner : decoder["decoders"]) {
+                    if (uses_byte_level(inner)) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        // Length of the longest prefix of `bytes` that doesn't end inside a character.
+        size_t complete_utf8_prefix(std::string_view bytes) {
+            const size_t size = bytes.size();
+            for (size_t back = 1; back <= std::min<size_t>(size, 4); ++back) {
+                const auto byte = static_cast<unsigned char>(bytes[size - back]);
+                if ((byte & 0xC0) == 0x80) {
+                    continue; // Continuation byte; keep looking for the lead.
+                }
+                const size_t length = byte < 0x80 ? 1 : (byte >> 5) == 0x6 ? 2 : (byte >> 4) == 0xE ? 3 : (byte >> 3) == 0x1E ? 4 : 1;
+                return length > back ? size - back : size;
+            }
+            return size;
+        }
+
+        void append_valid_utf8(std::string_view bytes, std::string& out) {
+            for (size_t i = 0; i < bytes.size();) {
+                const size_t start = i;
+                if (next_code_point(bytes, i) < 0) {
+                    out += "\xEF\xBF\xBD"; // U+FFFD
+                } else {
+                    out.append(bytes.substr(start, i - start));
+                }
+            }
+        }
+
+        std::optional<nlohmann::json> read_json(const std::filesystem::path& path) {
+            std::ifstream stream(path);
+            if (!stream) {
+                return std::nullopt;
+            }
+            return nlohmann::json::parse(stream, nullptr, false);
+        }
+
+    } // namespace
+
+    Detokenizer::Detokenizer(const std::string& tokenizer_json_path) {
+        const std::optional<nlohmann::json> tokenizer = read_json(tokenizer_json_path);
+        if (!tokenizer || tokenizer->is_discarded() || !tokenizer->contains("model")) {
+            throw std::runtime_error("Detokenizer: cannot read '" + tokenizer_json_path + "'.");
+        }
+        const nlohmann::json& vocab = (*tokenizer)["model"].value("vocab", nlohmann::json::object());
+        const bool byte_level = uses_byte_level(tokenizer->value("decoder", nlohmann::json{}));
+        const std::array<int, 512> decoder = byte_level_decoder();
+
+        auto set_piece = [this](int64_t id, std::string bytes) {
+            if (id < 0) {
+                return;
+            }
+            if (static_cast<size_t>(id) >= pieces_.size()) {
+                pieces_.resize(static_cast<size_t>(id) + 1);
+            }
+            pieces_[static_cast<size_t>(id)] = std::move(bytes);
+        };
+
+        if (vocab.is_object()) {
+            for (const auto& [piece, id] : vocab.items()) {
+                set_piece(id.get<int64_t>(), byte_level ? decode_byte_level(piece, decoder) : decode_sentencepiece(piece));
+            }
+        } else if (vocab.is_array()) {
+            // Unigram models list [piece, score] pairs by id.
+            for (size_t id = 0; id < vocab.size(); ++id) {
+                set_piece(static_cast<int64_t>(id), decode_sentencepiece(vocab[id][0].get<std::string>()));
+            }
+        }
+        for (const auto& added : tokenizer->value("added_tokens", nlohmann::json::array())) {
+            // Special tokens (BOS/EOS, chat markers) never appear in generated text.
+            const int64_t id = added.value("id", int64_t{-1});
+            set_piece(id, added.value("special", false) ? std::string{} : added.value("content", std::string{}));
+        }
+        if (pieces_.empty()) {
+            throw std::runtime_error("Detokenizer: '" + tokenizer_json_path + "' has an empty vocabulary.");
+        }
+    }
+
+    void StreamDecoder::append(int32_t token_id, std::string& out) {
+        pending_.append(detokenizer_->token_bytes(token_id));
+        const size_t complete = complete_utf8_prefix(pending_);
+        append_valid_utf8(std::string_view(pending_).substr(0, complete), out);
+        pending_.erase(0, complete);
+    }
+
+    void StreamDecoder::finish(std::string& out) {
+        append_valid_utf8(pending_, out);
+        pending_.clear();
+    }
+
+    std::vector<int32_t> read_eos_token_ids(const std::string& model_path) {
+        std::vector<int32_t> eos_token_ids;
+        for (const char* file : {"generation_config.json", "config.json"}) {
+            const std::optional<nlohmann::json> config = read_json(std::filesystem::path(model_path) / file);
+            if (!config || config->is_discarded() || !config->contains("eos_token_id")) {
+                continue;
+            }
+            const nlohmann::json& eos = (*config)["eos_token_id"];
+            if (eos.is_number_integer()) {
+                eos_token_ids.push_back(eos.get<int32_t>());
+            } else if (eos.is_array()) {
+                for (const auto& id : eos) {
+                    eos_token_ids.push_back(id.get<int32_t>());
+                }
+            }
+            break;
+        }
+        return eos_token_ids;
+    }
+
+} // namespace pie_core::server
@@ -0,0 +1,189 @@
+#include "server/generation_request.hpp"
+
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <nlohmann/json.hpp>
+
+namespace pie_core::server {
+
+    namespace {
+
+        using nlohmann::json;
+
+        // A field of the wrong type or out of range; becomes the 400 message.
+        struct FieldError {
+            std::string message;
+        };
+
+        // `body[name]` as a T, or `fallback` if absent or null. Numbers must
+        // be integers for integral T and fit it; nothing is coerced.
+        template <typename T>
+        T field(const json& body, const char* name, T fallback) {
+            const auto it = body.find(name);
+            if (it == body.end() || it->is_null()) {
+                return fallback;
+            }
+            const json& value = *it;
+            if constexpr (std::is_same_v<T, bool>) {
+                if (value.is_boolean()) {
+                    return value.get<bool>();
+                }
+                throw FieldError{std::string(name) + " must be a boolean."};
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                if (value.is_string()) {
+                    return value.get<std::string>();
+                }
+                throw FieldError{std::string(name) + " must be a string."};
+            } else if constexpr (std::is_integral_v<T>) {
+                if (value.is_number_integer()) {
+                    if (value.is_number_unsigned()) {
+                        const auto number = value.get<uint64_t>();
+                        if (number <= static_cast<uint64_t>(std::numeric_limits<T>::max())) {
+                            return static_cast<T>(number);
+                        }
+                    } else {
+                        const auto number = value.get<int64_t>();
+                        if (number >= static_cast<int64_t>(std::numeric_limits<T>::min())
+                            && (number < 0 || static_cast<uint64_t>(number) <= static_cast<uint64_t>(std::numeric_limits<T>::max()))) {
+                            return static_cast<T>(number);
+                        }
+                    }
+                }
+                throw FieldError{std::string(name) + " must be an integer in range."};
+            } else {
+                if (value.is_number()) {
+                    return value.get<T>();
+                }
+                throw FieldError{std::string(name) + " must be a number."};
+            }
+        }
+
+        // Token ids from a JSON int array; std::nullopt if it is anything else.
+        std::optional<std::vector<int32_t>> token_array(const json& value) {
+            if (!value.is_array() || value.empty()) {
+                return std::nullopt;
+            }
+            std::vector<int32_t> tokens;
+            tokens.reserve(value.size());
+            for (const auto& token : value) {
+                if (!token.is_number_integer()
+                    || token.get<int64_t>() < std::numeric_limits<int32_t>::min()
+                    || token.get<int64_t>() > std::numeric_limits<int32_t>::max()) {
+                    return std::nullopt;
+                }
+                tokens.push_back(token.get<int32_t>());
+            }
+            return tokens;
+        }
+
+        DecodeResult refuse(std::string message) {
+            return DecodeResult{.ok = false, .request = {}, .error = std::move(message)};
+        }
+
+        DecodeResult decode(const json& body, bool chat, std::span<const int32_t> eos_token_ids) {
+            GenerationRequest request;
+
+            // TODO: encode text prompts and apply the model's chat template
+            // natively (Detokenizer has the vocabulary; BPE merges and the
+            // pre-tokenizer are missing), so `prompt` strings and `messages`
+            // work like the OpenAI API. Until then they are refused by name.
+            std::optional<std::vector<int32_t>> prompt;
+            if (!chat) {
+                const json& value = body.value("prompt", json{});
+                if (value.is_string() || (value.is_array() && !value.empty() && value[0].is_string())) {
+                    return refuse("Text prompts are not supported yet: the native server does not tokenize. "
+                                  "Send `prompt` as an array of token ids.");
+                }
+                // A batch of one ([[...]]) is accepted too.
+                prompt = token_array(value.is_array() && value.size() == 1 && value[0].is_array() ? value[0] : value);
+            } else {
+                const json& value = body.value("prompt_token_ids", json{});
+                if (value.is_null() && body.contains("messages")) {
+                    return refuse("`messages` is not supported yet: the native server does not apply chat templates "
+                                  "or tokenize. Send the templated chat as `prompt_token_ids`.");
+                }
+                prompt = token_array(value);
+            }
+            if (!prompt) {
+                return refuse(!chat
+                    ? "The native server needs `prompt` as an array of token ids."
+                    : "The native server needs the templated chat as `prompt_token_ids`.");
+            }
+            request.prompt = std::move(*prompt);
+
+            ipc::RequestPayload& payload = request.payload;
+            payload.sampling_params.temperature = field(body, "temperature", payload.sampling_params.temperature);
+            payload.sampling_params.top_p = field(body, "top_p", payload.sampling_params.top_p);
+            payload.sampling_params.top_k = field(body, "top_k", payload.sampling_params.top_k);
+            payload.sampling_params.min_p = field(body, "min_p", payload.sampling_params.min_p);
+            payload.sampling_params.rng_seed = field(body, "seed", payload.sampling_params.rng_seed);
+            payload.frequency_penalty = field(body, "frequency_penalty", payload.frequency_penalty);
+            payload.presence_penalty = field(body, "presence_penalty", payload.presence_penalty);
+            payload.repetition_penalty = field(body, "repetition_penalty", payload.repetition_penalty);
+            payload.max_generated_tokens = field(body, "max_completion_tokens",
+                                                 field(body, "max_tokens", payload.max_generated_tokens));
+            if (payload.max_generated_tokens < 1) {
+                return refuse("max_tokens must be at least 1.");
+            }
+
+            // Scheduling class: "interactive", "standard" (default) or "batch".
+            const std::string priority = field(body, "priority", std::string("standard"));
+            if (priority == "interactive") {
+                payload.scheduling_params.priority = sequence::Priority::INTERACTIVE;
+            } else if (priority == "batch") {
+                payload.scheduling_params.priority = sequence::Priority::BATCH;
+            } else if (priority != "standard") {
+                return refuse("priority must be interactive, standard or batch.");
+            }
+            payload.scheduling_params.ttft_deadline_ms = field(body, "ttft_deadline_ms", uint32_t{0});
+            payload.scheduling_params.tenant_id = field(body, "tenant_id", uint32_t{0});
+
+            const json logit_bias = body.value("logit_bias", json::object());
+            if (!logit_bias.is_object()) {
+                return refuse("logit_bias maps token ids to numbers.");
+            }
+            for (const auto& [token, bias] : logit_bias.items()) {
+                try {
+                    if (!bias.is_number()) {
+                        return refuse("logit_bias maps token ids to numbers.");
+                    }
+                    request.logit_bias.push_back({.token_id = std::stoi(token), .bias = bias.get<float>()});
+                } catch (const std::exception&) {
+                    return refuse("logit_bias maps token ids to numbers.");
+                }
+            }
+            const json stop_token_ids = body.value("stop_token_ids", json{});
+            if (!stop_token_ids.is_null()) {
+                auto ids = token_array(stop_token_ids);
+                if (!ids && !(stop_token_ids.is_array() && stop_token_ids.empty())) {
+                    return refuse("stop_token_ids must be an array of token ids.");
+                }
+                request.stop_token_ids = std::move(ids).value_or(std::vector<int32_t>{});
+            }
+            if (!field(body, "ignore_eos", false)) {
+                request.stop_token_ids.insert(request.stop_token_ids.end(), eos_token_ids.begin(), eos_token_ids.end());
+            }
+
+            request.stream = field(body, "stream", false);
+            return DecodeResult{.ok = true, .request = std::move(request), .error = {}};
+        }
+
+    } // namespace
+
+    DecodeResult decode_generation_request(std::string_view body, bool chat, std::span<const int32_t> eos_token_ids) {
+        const json parsed = json::parse(body, nullptr, false);
+        if (parsed.is_discarded() || !parsed.is_object()) {
+            return refuse("Body must be a JSON object.");
+        }
+        try {
+            return decode(parsed, chat, eos_token_ids);
+        } catch (const FieldError& error) {
+            return refuse(error.message);
+        } catch (const json::exception&) {
+            // Backstop: a client's body must never take down the reactor thread.
+            return refuse("Malformed request body.");
+        }
+    }
+
+} // namespace pie_core::server
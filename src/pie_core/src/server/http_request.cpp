@@ -0,0 +1,103 @@
+#include "server/http_request.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+namespace pie_core::server {
+
+    namespace {
+
+        bool iequals(std::string_view a, std::string_view b) {
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+                return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+            });
+        }
+
+        std::string_view trim(std::string_view text) {
+            while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+                text.remove_prefix(1);
+            }
+            while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+                text.remove_suffix(1);
+            }
+            return text;
+        }
+
+        ParseResult error(int status) {
+            return ParseResult{.status = ParseStatus::ERROR, .request = {}, .consumed = 0, .error_status = status};
+        }
+
+    } // namespace
+
+    ParseResult parse_http_request(std::string_view buffer, size_t max_body_bytes) {
+        const size_t header_end = buffer.find("\r\n\r\n");
+        if (header_end == std::string_view::npos) {
+            return buffer.size() > MAX_HEADER_BYTES ? error(431) : ParseResult{};
+        }
+
+        std::string_view head = buffer.substr(0, header_end);
+        const size_t line_end = head.find("\r\n");
+        const std::string_view request_line = head.substr(0, line_end);
+        head = line_end == std::string_view::npos ? std::string_view{} : head.substr(line_end + 2);
+
+        // METHOD SP TARGET SP VERSION
+        const size_t first_space = request_line.find(' ');
+        const size_t second_space = request_line.find(' ', first_space + 1);
+        if (first_space == std::string_view::npos || second_space == std::string_view::npos) {
+            return error(400);
+        }
+        HttpRequest request;
+        request.method = request_line.substr(0, first_space);
+        request.target = request_line.substr(first_space + 1, second_space - first_space - 1);
+        const std::string_view version = request_line.substr(second_space + 1);
+        if (version != "HTTP/1.1" && version != "HTTP/1.0") {
+            return error(505);
+        }
+        request.keep_alive = version == "HTTP/1.1";
+
+        size_t content_length = 0;
+        while (!head.empty()) {
+            const size_t end = head.find("\r\n");
+            const std::string_view line = head.substr(0, end);
+            head = end == std::string_view::npos ? std::string_view{} : head.substr(end + 2);
+
+            const size_t colon = line.find(':');
+            if (colon == std::string_view::npos) {
+                return error(400);
+            }
+            const std::string_view name = line.substr(0, colon);
+            const std::string_view value = trim(line.substr(colon + 1));
+            if (iequals(name, "Content-Length")) {
+                const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), content_length);
+                if (ec != std::errc() || ptr != value.data() + value.size()) {
+                    return error(400);
+                }
+            } else if (iequals(name, "Transfer-Encoding")) {
+                return error(411);
+            } else if (iequals(name, "Connection")) {
+                if (iequals(value, "close")) {
+                    request.keep_alive = false;
+                } else if (iequals(value, "keep-alive")) {
+                    request.keep_alive = true;
+                }
+            }
+        }
+        if (content_length > max_body_bytes) {
+            return error(413);
+        }
+
+        const size_t body_start = header_end + 4;
+        if (buffer.size() - body_start < content_length) {
+            return ParseResult{};
+        }
+        request.body = buffer.substr(body_start, content_length);
+        return ParseResult{
+            .status = ParseStatus::COMPLETE,
+            .request = request,
+            .consumed = body_start + content_length,
+            .error_status = 0
+        };
+    }
+
+} // namespace pie_core::server
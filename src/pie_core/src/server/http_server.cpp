@@ -0,0 +1,700 @@
+#include "server/http_server.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#elif defined(__APPLE__)
+#include <sys/event.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include "ipc/request_writer.hpp"
+#include "ipc/response_reader.hpp"
+#include "server/detokenizer.hpp"
+#include "server/generation_request.hpp"
+#include "server/http_request.hpp"
+
+namespace pie_core::server {
+
+    namespace {
+
+        using nlohmann::json;
+
+        // Keeps HTTP request ids apart from those of other producers.
+        constexpr uint64_t HTTP_REQUEST_ID_BASE = uint64_t{1} << 63;
+        constexpr size_t READ_CHUNK_BYTES = 16 * 1024;
+        constexpr std::chrono::milliseconds DOORBELL_WAIT{100};
+
+        // --- Readiness polling (level-triggered) ---
+
+        struct PollEvent {
+            int fd;
+            bool readable;
+            bool writable;
+            bool hangup;
+        };
+
+        class Poller {
+        public:
+            Poller() {
+#if defined(__linux__)
+                fd_ = epoll_create1(EPOLL_CLOEXEC);
+#elif defined(__APPLE__)
+                fd_ = kqueue();
+#endif
+                if (fd_ == -1) {
+                    throw std::runtime_error(std::string("HttpServer: poller creation failed: ") + std::strerror(errno));
+                }
+            }
+
+            ~Poller() { close(fd_); }
+
+            void add(int fd) {
+#if defined(__linux__)
+                epoll_event event{.events = EPOLLIN | EPOLLRDHUP, .data = {.fd = fd}};
+                epoll_ctl(fd_, EPOLL_CTL_ADD, fd, &event);
+#elif defined(__APPLE__)
+                struct kevent change;
+                EV_SET(&change, fd, EVFILT_READ, EV_ADD, 0, 0, nullptr);
+                kevent(fd_, &change, 1, nullptr, 0, nullptr);
+#endif
+            }
+
+            // Errors and hangups are reported either way.
+            void watch(int fd, bool read, bool write) {
+#if defined(__linux__)
+                epoll_event event{
+                    .events = (read ? EPOLLIN | EPOLLRDHUP : 0u) | (write ? EPOLLOUT : 0u), .data = {.fd = fd}};
+                epoll_ctl(fd_, EPOLL_CTL_MOD, fd, &event);
+#elif defined(__APPLE__)
+                struct kevent changes[2];
+                EV_SET(&changes[0], fd, EVFILT_READ, read ? EV_ENABLE : EV_DISABLE, 0, 0, nullptr);
+                EV_SET(&changes[1], fd, EVFILT_WRITE, write ? EV_ADD : EV_DELETE, 0, 0, nullptr);
+                kevent(fd_, changes, 2, nullptr, 0, nullptr);
+#endif
+            }
+
+            // Closing the fd unregisters it from both epoll and kqueue.
+
+            size_t wait(std::vector<PollEvent>& out, int timeout_ms) {
+                out.clear();
+#if defined(__linux__)
+                epoll_event events[256];
+                const int count = epoll_wait(fd_, events, 256, timeout_ms);
+                for (int i = 0; i < count; ++i) {
+                    out.push_back({
+                        .fd = events[i].data.fd,
+                        .readable = (events[i].events & EPOLLIN) != 0,
+                        .writable = (events[i].events & EPOLLOUT) != 0,
+                        .hangup = (events[i].events & (EPOLLHUP | EPOLLERR)) != 0
+                    });
+                }
+#elif defined(__APPLE__)
+                struct kevent events[256];
+                const timespec timeout{.tv_sec = timeout_ms / 1000, .tv_nsec = (timeout_ms % 1000) * 1000000L};
+                const int count = kevent(fd_, nullptr, 0, events, 256, timeout_ms < 0 ? nullptr : &timeout);
+                for (int i = 0; i < count; ++i) {
+                    out.push_back({
+                        .fd = static_cast<int>(events[i].ident),
+                        .readable = events[i].filter == EVFILT_READ,
+                        .writable = events[i].filter == EVFILT_WRITE,
+                        .hangup = (events[i].flags & EV_ERROR) != 0
+                    });
+                }
+#endif
+                return out.size();
+            }
+
+        private:
+            int fd_ = -1;
+        };
+
+        void set_nonblocking(int fd) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+
+        ssize_t send_nosignal(int fd, const char* data, size_t size) {
+#if defined(MSG_NOSIGNAL)
+            return send(fd, data, size, MSG_NOSIGNAL);
+#else
+            return send(fd, data, size, 0); // SO_NOSIGPIPE is set on accept
+#endif
+        }
+
+        std::string_view reason_phrase(int status) {
+            switch (status) {
+                case 200: return "OK";
+                case 400: return "Bad Request";
+                case 404: return "Not Found";
+                case 405: return "Method Not Allowed";
+                case 411: return "Length Required";
+                case 413: return "Payload Too Large";
+                case 431: return "Request Header Fields Too Large";
+                case 503: return "Service Unavailable";
+                case 505: return "HTTP Version Not Supported";
+                default: return "Error";
+            }
+        }
+
+        std::string_view finish_reason_name(ipc::FinishReason reason) {
+            switch (reason) {
+                case ipc::FinishReason::STOP: return "stop";
+                case ipc::FinishReason::LENGTH: return "length";
+                case ipc::FinishReason::CANCELLED: return "cancelled";
+                case ipc::FinishReason::ERROR: return "error";
+                case ipc::FinishReason::DEADLINE: return "deadline_exceeded";
+                case ipc::FinishReason::NONE: break;
+            }
+            return "";
+        }
+
+        std::string error_body(std::string_view message) {
+            return json{{"error", {{"message", message}, {"type", "invalid_request_error"}}}}.dump();
+        }
+
+        enum class Endpoint { COMPLETIONS, CHAT_COMPLETIONS };
+
+        // A generation in flight, keyed by its response channel.
+        struct Stream {
+            int fd;                  // Owning connection; -1 once the client is gone
+            Endpoint endpoint;
+            bool sse;
+            bool keep_alive;
+            std::string id;
+            int64_t created;
+            size_t prompt_tokens;
+            size_t completion_tokens = 0;
+            StreamDecoder decoder;
+            std::string text;        // Whole completion, for non-streaming responses
+        };
+
+        struct Connection {
+            std::string in;
+            std::string out;
+            size_t out_offset = 0;
+            bool reading = true;           // Registered for readability; off while `in` is full
+            bool writing = false;          // Registered for writability
+            bool close_after_write = false;
+            std::optional<uint64_t> channel; // Active stream; requests behind it wait
+        };
+
+    } // namespace
+
+    struct HttpServer::HttpServerImpl {
+        HttpServerConfig config_;
+        const Detokenizer& detokenizer_;
+        ipc::RequestWriter writer_;
+        ipc::ResponseReader reader_;
+
+        Poller poller_;
+        int listen_fd_ = -1;
+        int wake_fds_[2] = {-1, -1};
+        std::atomic<bool> running_{true};
+        std::atomic<bool> wake_pending_{false};
+
+        std::unordered_map<int, Connection> connections_;
+        std::unordered_map<uint64_t, Stream> streams_;
+        uint64_t next_request_id_ = 0;
+        std::vector<ipc::ResponseEntry> entries_ = std::vector<ipc::ResponseEntry>(ipc::RESPONSE_CHANNEL_CAPACITY);
+
+        HttpServerImpl(
+            HttpServerConfig config,
+            const Detokenizer& detokenizer,
+            const std::string& request_shm_name,
+            const std::string& bulk_shm_name,
+            const std::string& response_shm_name
+        ) : config_(std::move(config)),
+            detokenizer_(detokenizer),
+            writer_(request_shm_name, bulk_shm_name),
+            reader_(response_shm_name)
+        {
+            if (pipe(wake_fds_) == -1) {
+                throw std::runtime_error(std::string("HttpServer: pipe() failed: ") + std::strerror(errno));
+            }
+            set_nonblocking(wake_fds_[0]);
+            set_nonblocking(wake_fds_[1]);
+            open_listener();
+            poller_.add(wake_fds_[0]);
+            poller_.add(listen_fd_);
+        }
+
+        ~HttpServerImpl() {
+            for (const auto& [fd, connection] : connections_) {
+                close(fd);
+            }
+            if (listen_fd_ != -1) {
+                close(listen_fd_);
+            }
+            close(wake_fds_[0]);
+            close(wake_fds_[1]);
+        }
+
+        void open_listener() {
+            listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+            if (listen_fd_ == -1) {
+                throw std::runtime_error(std::string("HttpServer: socket() failed: ") + std::strerror(errno));
+            }
+            const int enable = 1;
+            setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(config_.port);
+            if (inet_pton(AF_INET, config_.host.c_str(), &address.sin_addr) != 1) {
+                throw std::invalid_argument("HttpServer: invalid host '" + config_.host + "'.");
+            }
+            if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1
+                || listen(listen_fd_, SOMAXCONN) == -1) {
+                throw std::runtime_error(
+                    fmt::format("HttpServer: cannot listen on {}:{}: {}", config_.host, config_.port, std::strerror(errno)));
+            }
+            set_nonblocking(listen_fd_);
+        }
+
+        // --- Wakeups ---
+
+        void wake() noexcept {
+            if (!wake_pending_.exchange(true, std::memory_order_acq_rel)) {
+                const char byte = 1;
+                [[maybe_unused]] const ssize_t written = write(wake_fds_[1], &byte, 1);
+            }
+        }
+
+        // Sleeps on the response doorbell and turns each engine step that
+        // produced output into one reactor wakeup.
+        void watch_responses() {
+            uint32_t observed = reader_.snapshot();
+            while (running_.load(std::memory_order_acquire)) {
+                reader_.wait(observed, DOORBELL_WAIT);
+                const uint32_t current = reader_.snapshot();
+                if (current != observed) {
+                    observed = current;
+                    wake();
+                }
+            }
+        }
+
+        // --- Reactor ---
+
+        void run() {
+            std::thread watcher([this] { watch_responses(); });
+            spdlog::info("HttpServer: listening on {}:{}.", config_.host, config_.port);
+
+            std::vector<PollEvent> events;
+            while (running_.load(std::memory_order_acquire)) {
+                poller_.wait(events, -1);
+                bool responses_ready = false;
+                for (const PollEvent& event : events) {
+                    if (event.fd == wake_fds_[0]) {
+                        char buffer[64];
+                        while (read(wake_fds_[0], buffer, sizeof(buffer)) > 0) {
+                        }
+                        wake_pending_.store(false, std::memory_order_release);
+                        responses_ready = true;
+                    } else if (event.fd == listen_fd_) {
+                        accept_connections();
+                    } else {
+                        handle_connection_event(event);
+                    }
+                }
+                if (responses_ready) {
+                    pump_responses();
+                }
+            }
+
+            watcher.join();
+            spdlog::info("HttpServer: stopped.");
+        }
+
+        void accept_connections() {
+            for (;;) {
+                const int fd = accept(listen_fd_, nullptr, nullptr);
+                if (fd == -1) {
+                    return; // EAGAIN, or a transient error
+                }
+                if (connections_.size() >= config_.max_connections) {
+                    close(fd);
+                    continue;
+                }
+                set_nonblocking(fd);
+                const int enable = 1;
+                // Each SSE event is small and latency-bound.
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+#if defined(SO_NOSIGPIPE)
+                setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+                connections_.emplace(fd, Connection{});
+                poller_.add(fd);
+            }
+        }
+
+        void handle_connection_event(const PollEvent& event) {
+            const auto it = connections_.find(event.fd);
+            if (it == connections_.end()) {
+                return;
+            }
+            Connection& connection = it->second;
+            if (event.writable) {
+                flush(event.fd, connection);
+                if (!connections_.contains(event.fd)) {
+                    return;
+                }
+            }
+            if (event.hangup && !connection.reading) {
+                close_connection(event.fd); // Gone, with input we have no room for
+                return;
+            }
+            if (event.readable || event.hangup) {
+                // Requests pipelined behind an active stream wait in `in`; past
+                // what one request may take, stop reading until they are served.
+                char buffer[READ_CHUNK_BYTES];
+                while (connection.reading) {
+                    const size_t room = max_buffered_bytes() - connection.in.size();
+                    if (room == 0) {
+                        connection.reading = false;
+                        poller_.watch(event.fd, false, connection.writing);
+                        break;
+                    }
+                    const ssize_t count = read(event.fd, buffer, std::min(sizeof(buffer), room));
+                    if (count > 0) {
+                        connection.in.append(buffer, static_cast<size_t>(count));
+                        continue;
+                    }
+                    if (count == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                        close_connection(event.fd);
+                        return;
+                    }
+                    break;
+                }
+                process_requests(event.fd, connection);
+            }
+        }
+
+        void close_connection(int fd) {
+            const auto it = connections_.find(fd);
+            if (it == connections_.end()) {
+                return;
+            }
+            if (it->second.channel) {
+                // Nobody is listening any more: stop the request, and keep
+                // draining the channel until the engine finishes it.
+                reader_.cancel(*it->second.channel);
+                streams_.at(*it->second.channel).fd = -1;
+            }
+            connections_.erase(it);
+            close(fd);
+        }
+
+        // A whole request of the largest size the parser accepts.
+        [[nodiscard]] size_t max_buffered_bytes() const noexcept {
+            return MAX_HEADER_BYTES + 4 + config_.max_body_bytes;
+        }
+
+        void process_requests(int fd, Connection& connection) {
+            while (!connection.channel && !connection.close_after_write) {
+                const ParseResult parsed = parse_http_request(connection.in, config_.max_body_bytes);
+                if (parsed.status == ParseStatus::INCOMPLETE) {
+                    break;
+                }
+                if (parsed.status == ParseStatus::ERROR) {
+                    respond(fd, connection, parsed.error_status, error_body(reason_phrase(parsed.error_status)), false);
+                    return;
+                }
+                handle_request(fd, connection, parsed.request);
+                if (!connections_.contains(fd)) {
+                    return;
+                }
+                connection.in.erase(0, parsed.consumed);
+            }
+            if (!connection.reading && connection.in.size() < max_buffered_bytes()) {
+                connection.reading = true;
+                poller_.watch(fd, true, connection.writing);
+            }
+        }
+
+        void handle_request(int fd, Connection& connection, const HttpRequest& request) {
+            const std::string_view path = request.target.substr(0, request.target.find('?'));
+            if (path == "/health") {
+                respond(fd, connection, 200, R"({"status":"ok"})", request.keep_alive);
+            } else if (path == "/v1/models") {
+                const json models{
+                    {"object", "list"},
+                    {"data", json::array({{{"id", config_.model_name}, {"object", "model"}, {"owned_by", "pie"}}})}
+                };
+                respond(fd, connection, 200, models.dump(), request.keep_alive);
+            } else if (path == "/v1/completions" || path == "/v1/chat/completions") {
+                if (request.method != "POST") {
+                    respond(fd, connection, 405, error_body("Use POST."), request.keep_alive);
+                    return;
+                }
+                const Endpoint endpoint = path == "/v1/completions" ? Endpoint::COMPLETIONS : Endpoint::CHAT_COMPLETIONS;
+                start_generation(fd, connection, endpoint, request);
+            } else {
+                respond(fd, connection, 404, error_body("Unknown route."), request.keep_alive);
+            }
+        }
+
+        // --- Generation ---
+
+        void start_generation(int fd, Connection& connection, Endpoint endpoint, const HttpRequest& request) {
+            DecodeResult decoded = decode_generation_request(
+                request.body, endpoint == Endpoint::CHAT_COMPLETIONS, config_.eos_token_ids);
+            if (!decoded.ok) {
+                respond(fd, connection, 400, error_body(decoded.error), request.keep_alive);
+                return;
+            }
+            GenerationRequest& generation = decoded.request;
+            ipc::RequestPayload& payload = generation.payload;
+            payload.request_id = HTTP_REQUEST_ID_BASE | next_request_id_++;
+
+            const std::optional<uint64_t> channel = reader_.claim_channel();
+            if (!channel) {
+                respond(fd, connection, 503, error_body("All response channels are busy."), request.keep_alive, "Retry-After: 1\r\n");
+                return;
+            }
+            payload.ipc_handles.response_channel_id = *channel;
+
+            const ipc::SubmitStatus status = writer_.submit(payload, generation.prompt, generation.logit_bias, generation.stop_token_ids);
+            if (status != ipc::SubmitStatus::ACCEPTED) {
+                reader_.release_channel(*channel);
+                const uint32_t retry_after_ms = status == ipc::SubmitStatus::REJECTED ? writer_.load().retry_after_ms : 1000;
+                respond(fd, connection, 503, error_body("The engine is at capacity."), request.keep_alive,
+                        fmt::format("Retry-After: {}\r\n", (retry_after_ms + 999) / 1000));
+                return;
+            }
+
+            const bool sse = generation.stream;
+            const std::string_view prefix = endpoint == Endpoint::COMPLETIONS ? "cmpl-" : "chatcmpl-";
+            streams_.emplace(*channel, Stream{
+                .fd = fd,
+                .endpoint = endpoint,
+                .sse = sse,
+                .keep_alive = request.keep_alive && !sse,
+                .id = fmt::format("{}{:x}", prefix, payload.request_id & ~HTTP_REQUEST_ID_BASE),
+                .created = static_cast<int64_t>(std::time(nullptr)),
+                .prompt_tokens = generation.prompt.size(),
+                .decoder = StreamDecoder(detokenizer_),
+                .text = {}
+            });
+            connection.channel = *channel;
+            if (sse) {
+                // Streams end with the connection: no chunked framing needed.
+                connection.out += "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+                                  "Cache-Control: no-cache\r\nConnection: close\r\n\r\n";
+                flush(fd, connection);
+            }
+        }
+
+        void pump_responses() {
+            for (auto it = streams_.begin(); it != streams_.end();) {
+                const uint64_t channel = it->first;
+                Stream& stream = it->second;
+                const size_t count = reader_.read(channel, entries_.data(), entries_.size());
+
+                std::string delta;
+                ipc::FinishReason finish_reason = ipc::FinishReason::NONE;
+                for (size_t i = 0; i < count; ++i) {
+                    const ipc::ResponseEntry& entry = entries_[i];
+                    if (entry.flags & ipc::RESPONSE_TEXT_CONTINUES) {
+                        continue;
+                    }
+                    if (entry.token_id >= 0) {
+                        // The stop token itself is not part of the completion text.
+                        if (entry.finish_reason != ipc::FinishReason::STOP) {
+                            stream.decoder.append(entry.token_id, delta);
+                        }
+                        ++stream.completion_tokens;
+                    }
+                    if (entry.finish_reason != ipc::FinishReason::NONE) {
+                        finish_reason = entry.finish_reason;
+                        stream.decoder.finish(delta);
+                    }
+                }
+                if (count > 0 && stream.fd != -1) {
+                    deliver(stream, delta, finish_reason);
+                }
+                if (finish_reason == ipc::FinishReason::NONE) {
+                    ++it;
+                    continue;
+                }
+
+                reader_.release_channel(channel);
+                const int fd = stream.fd;
+                const bool keep_alive = stream.keep_alive;
+                it = streams_.erase(it);
+                if (fd != -1) {
+                    finish_connection_stream(fd, keep_alive);
+                }
+            }
+        }
+
+        void deliver(Stream& stream, const std::string& delta, ipc::FinishReason finish_reason) {
+            if (!stream.sse) {
+                stream.text += delta;
+                if (finish_reason != ipc::FinishReason::NONE) {
+                    Connection& connection = connections_.at(stream.fd);
+                    respond(stream.fd, connection, 200, completion_body(stream, finish_reason).dump(), stream.keep_alive);
+                }
+                return;
+            }
+            if (delta.empty() && finish_reason == ipc::FinishReason::NONE) {
+                return; // Only held-back bytes so far
+            }
+            Connection& connection = connections_.at(stream.fd);
+            connection.out += "data: ";
+            connection.out += chunk_body(stream, delta, finish_reason).dump();
+            connection.out += "\n\n";
+            if (finish_reason != ipc::FinishReason::NONE) {
+                connection.out += "data: [DONE]\n\n";
+            }
+            flush(stream.fd, connection);
+        }
+
+        void finish_connection_stream(int fd, bool keep_alive) {
+            const auto it = connections_.find(fd);
+            if (it == connections_.end()) {
+                return;
+            }
+            Connection& connection = it->second;
+            connection.channel.reset();
+            if (!keep_alive) {
+                connection.close_after_write = true;
+                flush(fd, connection);
+                return;
+            }
+            // Serve any request that was pipelined behind this one.
+            process_requests(fd, connection);
+        }
+
+        json usage(const Stream& stream) const {
+            return {
+                {"prompt_tokens", stream.prompt_tokens},
+                {"completion_tokens", stream.completion_tokens},
+                {"total_tokens", stream.prompt_tokens + stream.completion_tokens}
+            };
+        }
+
+        json chunk_body(const Stream& stream, const std::string& delta, ipc::FinishReason finish_reason) const {
+            const json reason = finish_reason == ipc::FinishReason::NONE ? json(nullptr) : json(finish_reason_name(finish_reason));
+            json chunk{{"id", stream.id}, {"created", stream.created}, {"model", config_.model_name}};
+            if (stream.endpoint == Endpoint::COMPLETIONS) {
+                chunk["object"] = "text_completion";
+                chunk["choices"] = json::array({{{"index", 0}, {"text", delta}, {"finish_reason", reason}}});
+            } else {
+                chunk["object"] = "chat.completion.chunk";
+                json choice_delta = json::object();
+                if (stream.completion_tokens <= 1 || !delta.empty()) {
+                    choice_delta["content"] = delta;
+                }
+                if (stream.completion_tokens <= 1) {
+                    choice_delta["role"] = "assistant";
+                }
+                chunk["choices"] = json::array({{{"index", 0}, {"delta", choice_delta}, {"finish_reason", reason}}});
+            }
+            if (finish_reason != ipc::FinishReason::NONE) {
+                chunk["usage"] = usage(stream);
+            }
+            return chunk;
+        }
+
+        json completion_body(const Stream& stream, ipc::FinishReason finish_reason) const {
+            json body{{"id", stream.id}, {"created", stream.created}, {"model", config_.model_name}, {"usage", usage(stream)}};
+            if (stream.endpoint == Endpoint::COMPLETIONS) {
+                body["object"] = "text_completion";
+                body["choices"] = json::array({{
+                    {"index", 0}, {"text", stream.text}, {"finish_reason", finish_reason_name(finish_reason)}
+                }});
+            } else {
+                body["object"] = "chat.completion";
+                body["choices"] = json::array({{
+                    {"index", 0},
+                    {"message", {{"role", "assistant"}, {"content", stream.text}}},
+                    {"finish_reason", finish_reason_name(finish_reason)}
+                }});
+            }
+            return body;
+        }
+
+        // --- Output ---
+
+        void respond(int fd, Connection& connection, int status, const std::string& body, bool keep_alive,
+                     std::string_view extra_headers = {}) {
+            connection.out += fmt::format(
+                "HTTP/1.1 {} {}\r\nContent-Type: application/json\r\nContent-Length: {}\r\n{}{}\r\n",
+                status, reason_phrase(status), body.size(), keep_alive ? "" : "Connection: close\r\n", extra_headers);
+            connection.out += body;
+            connection.close_after_write = connection.close_after_write || !keep_alive;
+            flush(fd, connection);
+        }
+
+        void flush(int fd, Connection& connection) {
+            while (connection.out_offset < connection.out.size()) {
+                const ssize_t written = send_nosignal(
+                    fd, connection.out.data() + connection.out_offset, connection.out.size() - connection.out_offset);
+                if (written > 0) {
+                    connection.out_offset += static_cast<size_t>(written);
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                    if (!connection.writing) {
+                        connection.writing = true;
+                        poller_.watch(fd, connection.reading, true);
+                    }
+                    return;
+                }
+                close_connection(fd);
+                return;
+            }
+            connection.out.clear();
+            connection.out_offset = 0;
+            if (connection.writing) {
+                connection.writing = false;
+                poller_.watch(fd, connection.reading, false);
+            }
+            if (connection.close_after_write && !connection.channel) {
+                close_connection(fd);
+            }
+        }
+    };
+
+    HttpServer::HttpServer(
+        HttpServerConfig config,
+        const Detokenizer& detokenizer,
+        const std::string& request_shm_name,
+        const std::string& bulk_shm_name,
+        const std::string& response_shm_name
+    ) : pimpl_(std::make_unique<HttpServerImpl>(
+            std::move(config), detokenizer, request_shm_name, bulk_shm_name, response_shm_name))
+    {}
+
+    HttpServer::~HttpServer() = default;
+
+    void HttpServer::run() {
+        pimpl_->run();
+    }
+
+    void HttpServer::stop() noexcept {
+        pimpl_->running_.store(false, std::memory_order_release);
+        const char byte = 1;
+        [[maybe_unused]] const ssize_t written = write(pimpl_->wake_fds_[1], &byte, 1);
+    }
+
+} // namespace pie_core::server
@@ -1,8 +1,15 @@
-from proxy_inference_engine.cache.kv_cache import KVCache, QuantizedKVCache, ReusableKVCache, RotatingKVCache
+from proxy_inference_engine.cache.kv_cache import (
+    KVCache,
+    PagedKVCache,
+    QuantizedKVCache,
+    ReusableKVCache,
+    RotatingKVCache,
+)
 from proxy_inference_engine.cache.prompt_cache import PromptCache
 
 __all__ = [
     "KVCache",
+    "PagedKVCache",
     "QuantizedKVCache",
     "ReusableKVCache",
     "RotatingKVCache",
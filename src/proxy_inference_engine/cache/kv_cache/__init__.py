@@ -1,6 +1,7 @@
 from __future__ import annotations
 
 from abc import ABC, abstractmethod
+from typing import Any
 
 import mlx.core as mx
 import mlx.nn as nn
@@ -24,6 +25,7 @@ class BaseCache(ABC):
         model: nn.Module,
         max_kv_size: int | None = None,
         reusable: bool = False,
+        page_allocator: Any | None = None,
     ) -> list[BaseCache]:
         """
         Construct the model's key-value cache for use during generation.
@@ -36,12 +38,16 @@ class BaseCache(ABC):
             max_kv_size (Optional[int]): If provided and the model does not have a
                 ``make_cache`` method, a ``RotatingKVCache`` is used with a maximum
                 size of ``max_kv_size``
+            page_allocator (Optional[pie_core.PageAllocator]): If provided, every
+                layer gets a ``PagedKVCache`` drawing pages from this pool.
         """
         if hasattr(model, "make_cache") and model.make_cache is not None:
             return model.make_cache()
 
         num_layers = len(model.layers) if model.layers else 0
-        if max_kv_size is not None:
+        if page_allocator is not None:
+            return [PagedKVCache(page_allocator) for _ in range(num_layers)]
+        elif max_kv_size is not None:
             return [
                 RotatingKVCache(max_size=max_kv_size, keep=4) for _ in range(num_layers)
             ]
@@ -266,6 +272,7 @@ class BaseCache(ABC):
 
 
 from proxy_inference_engine.cache.kv_cache.cache import KVCache  # noqa: E402
+from proxy_inference_engine.cache.kv_cache.paged import PagedKVCache  # noqa: E402
 from proxy_inference_engine.cache.kv_cache.quantized import (  # noqa: E402
     QuantizedKVCache,
 )
@@ -1,14 +1,253 @@
+from __future__ import annotations
+
 from typing import Any
 
+import mlx.core as mx
+
 from proxy_inference_engine.cache.kv_cache import BaseCache
 
 
 class PagedKVCache(BaseCache):
     """
-    A key-value cache that uses blocks of memory to store the cache,
-    and a page manager to manage the memory.
+    A key-value cache that stores one layer's keys and values in fixed-size
+    pages drawn from a shared `pie_core.PageAllocator`.
+
+    Memory grows one page (`TOKEN_CAPACITY_PER_PAGE` tokens) at a time and is
+    handed back to the pool on `trim` or `release`, so there is no doubling
+    over-allocation and no copy of the existing cache when it grows. Pages can be
+    shared between caches (`fork`); a shared page is copied before it is written.
+    New tokens are copied into the pages' own storage (`KVPage.write`), in place.
+
+    Python attention reads contiguous keys and values, so the cache also keeps a
+    contiguous view that each update extends with just its new tokens. The view
+    doubles its capacity when it fills, so existing entries are copied a
+    logarithmic number of times over a generation, not once per page. It is
+    rebuilt from the pages only after `fork` or a `state` assignment.
+
+    Only batch size 1 is supported, and the allocator must hold a floating-point
+    cache dtype (quantized pools are for the native engine).
     """
 
+    offset: int
+    step: int
+
     def __init__(self, page_manager: Any):
-        """Initialize a PagedKVCache with a page manager."""
+        """
+        Initialize an empty PagedKVCache.
+
+        Args:
+            page_manager: The `pie_core.PageAllocator` pages are taken from. One
+                allocator is normally shared by every layer of a model.
+        """
+        from proxy_inference_engine import pie_core
+
         self.page_manager = page_manager
+        self.page_table: list[int] = []
+        self.offset = 0
+        self.step = pie_core.TOKEN_CAPACITY_PER_PAGE
+        # Contiguous [1, n_kv_heads, capacity, head_dim] copies for attention;
+        # entries past `offset` are stale.
+        self._keys: mx.array | None = None
+        self._values: mx.array | None = None
+
+    def update_and_fetch(
+        self, keys: mx.array, values: mx.array
+    ) -> tuple[mx.array, mx.array]:
+        """
+        Write new key-value pairs into the pages and return the full cache.
+
+        Args:
+            keys: New keys, shape [1, n_kv_heads, #tokens, head_dim].
+            values: New values, shape [1, n_kv_heads, #tokens, head_dim].
+
+        Returns:
+            The cached keys and values up to the current offset, in the same
+            [1, n_kv_heads, offset, head_dim] layout.
+        """
+        if keys.shape[0] != 1:
+            raise ValueError("PagedKVCache supports batch size 1 only.")
+
+        # Pages are token-major: [tokens, heads, head_dim].
+        new_keys = keys[0].transpose(1, 0, 2)
+        new_values = values[0].transpose(1, 0, 2)
+        num_new = new_keys.shape[0]
+
+        written = 0
+        while written < num_new:
+            page_index, slot = divmod(self.offset + written, self.step)
+            page = self._writable_page(page_index)
+            count = min(self.step - slot, num_new - written)
+
+            dtype = page.key_cache.dtype
+            if not mx.issubdtype(dtype, mx.floating):
+                raise TypeError("PagedKVCache needs a pool with a floating-point cache dtype.")
+            page.write(
+                slot,
+                new_keys[written : written + count].astype(dtype),
+                new_values[written : written + count].astype(dtype),
+            )
+            page.num_tokens = slot + count
+            written += count
+
+        previous_offset = self.offset
+        self.offset += num_new
+        return self._extend_view(keys, values, previous_offset)
+
+    def fork(self) -> PagedKVCache:
+        """
+        Return a cache sharing every page with this one (e.g. a common prompt
+        prefix). Either side copies a shared page before writing to it.
+        """
+        other = PagedKVCache(self.page_manager)
+        for page_id in self.page_table:
+            self.page_manager.add_ref(page_id)
+        other.page_table = list(self.page_table)
+        other.offset = self.offset
+        # `other` builds its own view: mlx arrays are updated in place, so
+        # sharing one would leak each side's writes into the other.
+        return other
+
+    def reuse(self, new_prompt_length: int, common_prefix_length: int) -> None:
+        """
+        Keep only the common prefix with a new prompt. Pages are allocated as
+        the new tokens are written, so nothing is reserved up front.
+        """
+        self.trim(self.offset - min(common_prefix_length, self.offset))
+
+    def release(self) -> None:
+        """
+        Return every page to the pool.
+        """
+        for page_id in self.page_table:
+            self.page_manager.free_page(page_id)
+        self.page_table = []
+        self.offset = 0
+        self._keys = None
+        self._values = None
+
+    def __del__(self):
+        if getattr(self, "page_table", None):
+            self.release()
+
+    @property
+    def state(self) -> tuple[mx.array | None, mx.array | None]:
+        """
+        Get the current state of the cache.
+
+        Returns:
+            (keys, values) up to the current offset, or (None, None) if empty.
+        """
+        if self.offset == 0:
+            return None, None
+        if self._keys is not None and self._values is not None:
+            return self._keys[..., : self.offset, :], self._values[..., : self.offset, :]
+        return self._gather()
+
+    @state.setter
+    def state(self, v: tuple[mx.array, mx.array]):
+        """
+        Replace the cache contents, writing (keys, values) into fresh pages.
+        """
+        self.release()
+        keys, values = v
+        if keys is not None and values is not None:
+            self.update_and_fetch(keys, values)
+
+    def is_trimmable(self) -> bool:
+        """
+        Check if this cache can be trimmed.
+
+        Returns:
+            True, as PagedKVCache supports trimming.
+        """
+        return True
+
+    def trim(self, n: int) -> int:
+        """
+        Drop the last n tokens and return pages that no longer hold any.
+
+        Args:
+            n: Number of tokens to trim.
+
+        Returns:
+            The actual number of tokens trimmed.
+        """
+        n = min(self.offset, n)
+        self.offset -= n
+        pages_needed = (self.offset + self.step - 1) // self.step
+        for page_id in self.page_table[pages_needed:]:
+            self.page_manager.free_page(page_id)
+        del self.page_table[pages_needed:]
+        return n
+
+    def to_quantized(self, group_size: int = 64, bits: int = 4) -> BaseCache:
+        """
+        Paged storage is already sized by the pool; quantization is not supported.
+        """
+        return self
+
+    def _writable_page(self, page_index: int) -> Any:
+        """
+        The page at `page_index` of the page table, allocating it if it is the
+        next one and copying it first if another cache shares it.
+        """
+        if page_index == len(self.page_table):
+            page_id = self._allocate()
+            self.page_table.append(page_id)
+            return self.page_manager.get_page(page_id)
+
+        page = self.page_manager.get_page(self.page_table[page_index])
+        if page.ref_count == 1:
+            return page
+
+        # Copy-on-write: the new page starts as a copy of the shared one.
+        page_id = self._allocate()
+        copy = self.page_manager.get_page(page_id)
+        copy.write(0, page.key_cache[: page.num_tokens], page.value_cache[: page.num_tokens])
+        copy.num_tokens = page.num_tokens
+        self.page_manager.free_page(page.page_id)
+        self.page_table[page_index] = page_id
+        return copy
+
+    def _allocate(self) -> int:
+        page_id = self.page_manager.allocate_page()
+        if page_id is None:
+            raise MemoryError("PagedKVCache: the page pool is exhausted.")
+        return page_id
+
+    def _extend_view(
+        self, keys: mx.array, values: mx.array, previous_offset: int
+    ) -> tuple[mx.array, mx.array]:
+        """
+        Write the new tokens (already in the pages) into the contiguous view
+        and return it up to the current offset.
+        """
+        if self._keys is None or self._values is None:
+            # First update, or after fork: one gather, which includes the new tokens.
+            self._keys, self._values = self._gather()
+            return self._keys, self._values
+
+        capacity = self._keys.shape[2]
+        if self.offset > capacity:
+            # Double, so the entries are copied O(log n) times over a generation.
+            needed = -(-self.offset // self.step) * self.step
+            grow_by = max(capacity, needed - capacity)
+            _, n_kv_heads, _, k_head_dim = self._keys.shape
+            v_head_dim = self._values.shape[3]
+            new_k = mx.zeros((1, n_kv_heads, grow_by, k_head_dim), dtype=self._keys.dtype)
+            new_v = mx.zeros((1, n_kv_heads, grow_by, v_head_dim), dtype=self._values.dtype)
+            self._keys = mx.concatenate([self._keys, new_k], axis=2)
+            self._values = mx.concatenate([self._values, new_v], axis=2)
+
+        self._keys[..., previous_offset : self.offset, :] = keys.astype(self._keys.dtype)
+        self._values[..., previous_offset : self.offset, :] = values.astype(self._values.dtype)
+        return self._keys[..., : self.offset, :], self._values[..., : self.offset, :]
+
+    def _gather(self) -> tuple[mx.array, mx.array]:
+        """
+        The cached tokens as contiguous [1, n_kv_heads, offset, head_dim] arrays.
+        """
+        pages = [self.page_manager.get_page(page_id) for page_id in self.page_table]
+        keys = mx.concatenate([page.key_cache for page in pages], axis=0)[: self.offset]
+        values = mx.concatenate([page.value_cache for page in pages], axis=0)[: self.offset]
+        return keys.transpose(1, 0, 2)[None], values.transpose(1, 0, 2)[None]
@@ -4,8 +4,10 @@ from proxy_inference_engine.engine.client import (
     InferenceEngineClient,
 )
 from proxy_inference_engine.engine.inference_engine import InferenceEngine
+from proxy_inference_engine.engine.native import AsyncEngine
 
 __all__ = [
+    "AsyncEngine",
     "GenerationKwargs",
     "GenerationRequest",
     "InferenceEngine",
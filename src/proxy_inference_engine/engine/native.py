@@ -0,0 +1,89 @@
+from __future__ import annotations
+
+import asyncio
+import logging
+from array import array
+from collections.abc import AsyncIterator, Sequence
+from typing import Any
+
+from proxy_inference_engine import pie_core
+
+logger = logging.getLogger(__name__)
+
+
+class AsyncEngine:
+    """
+    The native engine running inside this process, exposed through asyncio.
+
+    Scheduling and generation happen on a native thread that never holds the
+    GIL. After every step that produced output the engine makes its wakeup fd
+    readable; the event loop then fans the new tokens out to the waiting
+    generators, so a step costs one loop callback however many requests it
+    served.
+    """
+
+    def __init__(self, model_path: str, **engine_kwargs: Any):
+        self._engine = pie_core.Engine(model_path, **engine_kwargs)
+        self._streams: dict[int, tuple[Any, asyncio.Queue]] = {}
+        self._loop: asyncio.AbstractEventLoop | None = None
+
+    async def generate(
+        self,
+        prompt: Sequence[int],
+        **request_kwargs: Any,
+    ) -> AsyncIterator[int]:
+        """
+        Submit a tokenized prompt and yield generated token ids as they arrive.
+
+        An `array("i")` is handed over as is; other sequences are packed into
+        one first. Keyword arguments are forwarded to `pie_core.Engine.submit`. Leaving
+        the iterator early cancels the request.
+        """
+        self._attach(asyncio.get_running_loop())
+        prompt_tokens = prompt if isinstance(prompt, array) else array("i", prompt)
+        stream = self._engine.submit(prompt_tokens, **request_kwargs)
+        queue: asyncio.Queue = asyncio.Queue()
+        # Registered before the next loop iteration, so no wakeup can miss it.
+        self._streams[stream.request_id] = (stream, queue)
+
+        finished = False
+        try:
+            while True:
+                token_id, finish_reason = await queue.get()
+                if token_id is not None:
+                    yield token_id
+                if finish_reason != pie_core.FinishReason.NONE:
+                    finished = True
+                    return
+        finally:
+            self._streams.pop(stream.request_id, None)
+            if not finished:
+                self._engine.cancel(stream.request_id)
+
+    def shutdown(self) -> None:
+        """
+        Stop the engine. Open generators receive their final (CANCELLED) entry.
+        """
+        self._engine.shutdown()
+        self._on_wakeup()
+        if self._loop is not None:
+            self._loop.remove_reader(self._engine.wakeup_fd)
+            self._loop = None
+
+    def _attach(self, loop: asyncio.AbstractEventLoop) -> None:
+        if self._loop is loop:
+            return
+        if self._loop is not None:
+            raise RuntimeError("AsyncEngine is already bound to another event loop.")
+        loop.add_reader(self._engine.wakeup_fd, self._on_wakeup)
+        self._loop = loop
+
+    def _on_wakeup(self) -> None:
+        for request_id in self._engine.take_ready():
+            entry = self._streams.get(request_id)
+            if entry is None:
+                # The generator was closed; its cancellation is in flight.
+                continue
+            stream, queue = entry
+            for item in stream.read():
+                queue.put_nowait(item)
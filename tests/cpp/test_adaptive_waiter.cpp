@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "ipc/adaptive_waiter.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace pie_core;
+using namespace std::chrono_literals;
+
+// -----------------------------------------------------------------------------
+// Test fixture: notifier words owned by the test instead of shared memory
+// -----------------------------------------------------------------------------
+class AdaptiveWaiterTest : public ::testing::Test {
+protected:
+    std::atomic<uint32_t> sequence_{0};
+    std::atomic<uint32_t> waiters_{0};
+    ipc::EventNotifier notifier_{sequence_, waiters_};
+};
+
+TEST_F(AdaptiveWaiterTest, ReturnsImmediatelyIfAlreadyNotified) {
+    ipc::AdaptiveWaiter waiter(notifier_);
+    const uint32_t observed = notifier_.snapshot();
+    notifier_.notify();
+    EXPECT_TRUE(waiter.wait(observed, 1s));
+}
+
+TEST_F(AdaptiveWaiterTest, TimesOutAndStopsSpinning) {
+    ipc::AdaptiveWaiter waiter(notifier_, {.min_spin = 0ns, .max_spin = 50us});
+    EXPECT_FALSE(waiter.wait(notifier_.snapshot(), 2ms));
+    EXPECT_EQ(waiter.spin_budget(), 0ns);
+}
+
+TEST_F(AdaptiveWaiterTest, FrequentArrivalsRaiseSpinBudget) {
+    if (std::thread::hardware_concurrency() <= 1) {
+        GTEST_SKIP() << "spinning is disabled on single-core machines";
+    }
+    ipc::AdaptiveWaiter waiter(notifier_, {.min_spin = 0ns, .max_spin = 1ms});
+    for (int i = 0; i < 64; ++i) {
+        const uint32_t observed = notifier_.snapshot();
+        notifier_.notify();
+        ASSERT_TRUE(waiter.wait(observed, 1s));
+    }
+    EXPECT_GT(waiter.spin_budget(), 0ns);
+    EXPECT_LE(waiter.spin_budget(), 1ms);
+}
+
+TEST_F(AdaptiveWaiterTest, BlockedWaiterIsWoken) {
+    ipc::AdaptiveWaiter waiter(notifier_, {.min_spin = 0ns, .max_spin = 0ns});
+    const uint32_t observed = notifier_.snapshot();
+    std::thread producer([&] {
+        std::this_thread::sleep_for(20ms);
+        notifier_.notify();
+    });
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(waiter.wait(observed, 5s));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 2s);
+    producer.join();
+}
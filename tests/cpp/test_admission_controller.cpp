@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "engine/admission_controller.hpp"
+#include <stdexcept>
+
+using namespace pie_core;
+
+namespace {
+
+    constexpr size_t TOKENS_PER_PAGE = 64;
+
+} // namespace
+
+TEST(AdmissionControllerTest, ChargesPromptPlusMaximumOutput) {
+    engine::AdmissionController admission(1000, TOKENS_PER_PAGE);
+    EXPECT_EQ(admission.pages_needed(100, 0), 2u);
+    EXPECT_EQ(admission.pages_needed(100, 1024), 18u); // ceil(1124 / 64)
+}
+
+TEST(AdmissionControllerTest, KeepsTheWatermarkFree) {
+    engine::AdmissionController admission(1000, TOKENS_PER_PAGE);
+    EXPECT_TRUE(admission.admits(100, 80, 20));
+    EXPECT_FALSE(admission.admits(100, 80, 21));
+
+    admission.set_watermark(0.05); // 50 pages
+    EXPECT_EQ(admission.watermark_pages(), 50u);
+    EXPECT_TRUE(admission.admits(100, 30, 20));
+    EXPECT_FALSE(admission.admits(100, 31, 20));
+
+    EXPECT_THROW(admission.set_watermark(1.0), std::invalid_argument);
+    EXPECT_THROW(admission.set_watermark(-0.1), std::invalid_argument);
+}
+
+TEST(AdmissionControllerTest, PredictsOutputOnlyWhenAskedAndWarmedUp) {
+    engine::AdmissionController admission(1000, TOKENS_PER_PAGE);
+    for (size_t i = 0; i < engine::AdmissionController::MIN_OBSERVATIONS; ++i) {
+        admission.observe_finished(i % 2 == 0 ? 200 : 300, 1000); // 20-30% of the limit
+    }
+    EXPECT_DOUBLE_EQ(admission.output_fraction(), 1.0); // Prediction is off
+
+    admission.set_predict_output_lengths(true);
+    const double fraction = admission.output_fraction();
+    EXPECT_GT(fraction, 0.25); // A high estimate: above the mean
+    EXPECT_LT(fraction, 0.4);
+    EXPECT_LT(admission.pages_needed(0, 1024), 1024 / TOKENS_PER_PAGE);
+}
+
+TEST(AdmissionControllerTest, NotEnoughHistoryChargesTheMaximum) {
+    engine::AdmissionController admission(1000, TOKENS_PER_PAGE);
+    admission.set_predict_output_lengths(true);
+    admission.observe_finished(10, 1000);
+    EXPECT_DOUBLE_EQ(admission.output_fraction(), 1.0);
+}
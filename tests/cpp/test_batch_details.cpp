@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include "engine/batch_details.hpp"
+#include "engine/page.hpp"
+#include "sequence/sequence.hpp"
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace pie_core;
+
+namespace {
+
+    // Prompt tokens 0..7, so a token id tells its position.
+    std::unique_ptr<sequence::Sequence> make_sequence(uint64_t id, std::vector<uint32_t> pages) {
+        std::vector<int32_t> prompt(8);
+        std::iota(prompt.begin(), prompt.end(), 0);
+        auto sequence = std::make_unique<sequence::Sequence>(
+            id, sequence::SequenceStatus::DECODING, 0,
+            sequence::Prompt(std::move(prompt)),
+            sequence::SamplingParams{}, sequence::LogitsParams{}, sequence::StopCriteria{}, sequence::IPCHandles{});
+        for (const uint32_t page : pages) {
+            sequence->append_page(page);
+        }
+        return sequence;
+    }
+
+    int32_t slot(uint32_t page, size_t position) {
+        return static_cast<int32_t>(page * engine::TOKEN_CAPACITY_PER_PAGE + position % engine::TOKEN_CAPACITY_PER_PAGE);
+    }
+
+    constexpr engine::BlockTableSpec DENSE{.layout = engine::BlockTableLayout::DENSE};
+
+} // namespace
+
+TEST(BatchDetailsBuilderTest, AlternatesBufferSetsWithoutReallocating) {
+    const auto a = make_sequence(1, {4});
+    const std::vector<engine::TokenChunk> first{{a.get(), 5, 1}};
+    const std::vector<engine::TokenChunk> second{{a.get(), 6, 1}};
+
+    engine::BatchDetailsBuilder builder(2, 16);
+    const engine::BatchDetails& step1 = builder.build(first, DENSE);
+    const int32_t* step1_positions = step1.positions.data<int32_t>();
+    const int32_t* step1_table = step1.consolidated_block_table.data<int32_t>();
+    const engine::BatchDetails& step2 = builder.build(second, DENSE);
+
+    // The next step is built beside the last one, which stays intact.
+    EXPECT_NE(step2.positions.data<int32_t>(), step1_positions);
+    EXPECT_EQ(step1.positions.data<int32_t>()[0], 5);
+    EXPECT_EQ(step2.positions.data<int32_t>()[0], 6);
+    EXPECT_EQ(step2.token_ids.data<int32_t>()[0], 6);
+
+    // The step after that reuses the first set's memory.
+    const engine::BatchDetails& step3 = builder.build(first, DENSE);
+    EXPECT_EQ(&step3, &step1);
+    EXPECT_EQ(step3.positions.data<int32_t>(), step1_positions);
+    EXPECT_EQ(step3.consolidated_block_table.data<int32_t>(), step1_table);
+    EXPECT_EQ(step3.slot_mapping.data<int32_t>()[0], slot(4, 5));
+}
+
+TEST(BatchDetailsBuilderTest, BuildKeepsAMatchingPreparedLayout) {
+    const auto a = make_sequence(1, {4, 5});
+    const auto b = make_sequence(2, {8});
+    const std::vector<engine::TokenChunk> chunks{{a.get(), 7, 1}, {b.get(), 7, 1}};
+
+    engine::BatchDetailsBuilder builder(2, 16);
+    builder.prepare(chunks, DENSE);
+    const engine::BatchDetails& details = builder.build(chunks, DENSE);
+    EXPECT_EQ(details.token_ids.data<int32_t>()[1], 7);
+    EXPECT_EQ(details.positions.data<int32_t>()[1], 7);
+    EXPECT_EQ(details.slot_mapping.data<int32_t>()[1], slot(8, 7));
+    EXPECT_EQ(details.num_decode_sequences, 2u);
+}
+
+TEST(BatchDetailsBuilderTest, BuildRedoesAStalePreparedLayout) {
+    const auto a = make_sequence(1, {4, 5});
+    const auto b = make_sequence(2, {8});
+    const std::vector<engine::TokenChunk> chunks{{a.get(), 7, 1}, {b.get(), 7, 1}};
+
+    engine::BatchDetailsBuilder builder(2, 16);
+    builder.prepare(chunks, DENSE);
+    b->append_page(9); // Its page table changed since
+    const engine::BatchDetails& grown = builder.build(chunks, DENSE);
+    EXPECT_EQ(grown.consolidated_block_table.data<int32_t>()[3], 9);
+
+    builder.prepare(chunks, DENSE);
+    const std::vector<engine::TokenChunk> other{{b.get(), 7, 1}};
+    const engine::BatchDetails& details = builder.build(other, DENSE);
+    ASSERT_EQ(details.sequence_ids.size(), 1u);
+    EXPECT_EQ(details.sequence_ids[0], 2u);
+    EXPECT_EQ(details.slot_mapping.data<int32_t>()[0], slot(8, 7));
+}
+
+TEST(BatchDetailsBuilderTest, RejectsStepsBeyondCapacity) {
+    const auto a = make_sequence(1, {4});
+    const auto b = make_sequence(2, {8});
+    engine::BatchDetailsBuilder builder(1, 4);
+    EXPECT_THROW(builder.build(std::vector<engine::TokenChunk>{{a.get(), 0, 1}, {b.get(), 0, 1}}, DENSE),
+                 std::length_error);
+    EXPECT_THROW(builder.build(std::vector<engine::TokenChunk>{{a.get(), 0, 8}}, DENSE), std::length_error);
+}
+
+TEST(BatchDetailsBuilderTest, RunLaysOutEveryStep) {
+    // b's run crosses into its second page.
+    const auto a = make_sequence(1, {4});
+    const auto b = make_sequence(2, {8, 9});
+    const size_t b_start = engine::TOKEN_CAPACITY_PER_PAGE - 2;
+    const std::vector<engine::TokenChunk> chunks{{a.get(), 5, 1}, {b.get(), b_start, 1}};
+
+    // More run tokens (3 x 2) than a step may hold (4): the run's buffers grow.
+    engine::BatchDetailsBuilder builder(2, 4);
+    const std::span<engine::BatchDetails> run = builder.build_run(chunks, 3, DENSE);
+    ASSERT_EQ(run.size(), 3u);
+    for (size_t step = 0; step < run.size(); ++step) {
+        engine::BatchDetails& details = run[step];
+        details.token_ids = mx::array({0, 0});
+        mx::eval(details.positions);
+        mx::eval(details.slot_mapping);
+        EXPECT_EQ(details.total_tokens_in_step, 2u);
+        EXPECT_EQ(details.context_lengths, (std::vector<int32_t>{
+            static_cast<int32_t>(5 + step), static_cast<int32_t>(b_start + step)}));
+        EXPECT_EQ(details.positions.data<int32_t>()[0], static_cast<int32_t>(5 + step));
+        EXPECT_EQ(details.slot_mapping.data<int32_t>()[0], slot(4, 5 + step));
+        EXPECT_EQ(details.slot_mapping.data<int32_t>()[1], slot(step < 2 ? 8 : 9, b_start + step));
+        EXPECT_EQ(details.consolidated_block_table.data<int32_t>()[1], -1); // a's padding
+    }
+
+    EXPECT_THROW(builder.build_run(std::vector<engine::TokenChunk>{{a.get(), 0, 2}}, 2, DENSE),
+                 std::invalid_argument);
+    EXPECT_THROW(builder.build_run(chunks, 0, DENSE), std::invalid_argument);
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include "engine/batch_policy.hpp"
+#include <stdexcept>
+
+using namespace pie_core;
+
+namespace {
+
+    constexpr engine::BatchState MIXED{
+        .num_decoding = 8, .num_prefilling = 2, .pending_prefill_tokens = 3000, .token_budget = 2048};
+
+    class FixedPolicy final : public engine::IBatchPolicy {
+    public:
+        engine::BatchMix plan(const engine::BatchState&) override {
+            return {.max_decode_tokens = 16, .max_prefill_tokens = 512};
+        }
+
+        std::string name() const override { return "fixed"; }
+    };
+
+    engine::BatchPolicyRegistrar<FixedPolicy> fixed_registrar("test-fixed");
+
+} // namespace
+
+TEST(BatchPolicyTest, HybridRunsDecodesAndPrefills) {
+    const auto policy = engine::BatchPolicyRegistry::create_policy("hybrid");
+    const engine::BatchMix mix = policy->plan(MIXED);
+    EXPECT_EQ(mix.max_decode_tokens, 2048u);
+    EXPECT_EQ(mix.max_prefill_tokens, 2048u);
+}
+
+TEST(BatchPolicyTest, PrefillFirstStallsDecodes) {
+    const auto policy = engine::BatchPolicyRegistry::create_policy("prefill-first");
+    engine::BatchMix mix = policy->plan(MIXED);
+    EXPECT_EQ(mix.max_decode_tokens, 0u);
+    EXPECT_EQ(mix.max_prefill_tokens, 2048u);
+
+    // Nothing left to prefill: decodes resume.
+    mix = policy->plan({.num_decoding = 8, .num_prefilling = 0, .pending_prefill_tokens = 0, .token_budget = 2048});
+    EXPECT_EQ(mix.max_decode_tokens, 2048u);
+    EXPECT_EQ(mix.max_prefill_tokens, 0u);
+}
+
+TEST(BatchPolicyTest, DecodeFirstDefersPrefills) {
+    const auto policy = engine::BatchPolicyRegistry::create_policy("decode-first");
+    engine::BatchMix mix = policy->plan(MIXED);
+    EXPECT_EQ(mix.max_decode_tokens, 2048u);
+    EXPECT_EQ(mix.max_prefill_tokens, 0u);
+
+    mix = policy->plan({.num_decoding = 0, .num_prefilling = 2, .pending_prefill_tokens = 3000, .token_budget = 2048});
+    EXPECT_EQ(mix.max_prefill_tokens, 2048u);
+}
+
+TEST(BatchPolicyTest, RegistryCreatesCustomPoliciesAndRejectsUnknownNames) {
+    EXPECT_EQ(engine::BatchPolicyRegistry::create_policy("test-fixed")->name(), "fixed");
+    EXPECT_THROW(engine::BatchPolicyRegistry::create_policy("round-robin"), std::runtime_error);
+    EXPECT_THROW(engine::BatchPolicyRegistry::register_policy("hybrid", [] { return std::make_unique<FixedPolicy>(); }),
+                 std::runtime_error);
+
+    const std::vector<std::string> names = engine::BatchPolicyRegistry::policy_names();
+    EXPECT_EQ(names, (std::vector<std::string>{"decode-first", "hybrid", "prefill-first", "test-fixed"}));
+}
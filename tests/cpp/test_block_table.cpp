@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "engine/batch_details.hpp"
+#include "engine/block_table.hpp"
+#include "engine/page.hpp"
+#include "sequence/sequence.hpp"
+#include <memory>
+#include <vector>
+
+using namespace pie_core;
+
+namespace {
+
+    std::unique_ptr<sequence::Sequence> make_sequence(uint64_t id, std::vector<uint32_t> pages) {
+        auto sequence = std::make_unique<sequence::Sequence>(
+            id, sequence::SequenceStatus::DECODING, 0,
+            sequence::Prompt(std::vector<int32_t>(8, 1)),
+            sequence::SamplingParams{}, sequence::LogitsParams{}, sequence::StopCriteria{}, sequence::IPCHandles{});
+        for (const uint32_t page : pages) {
+            sequence->append_page(page);
+        }
+        return sequence;
+    }
+
+} // namespace
+
+TEST(PersistentBlockTableTest, SyncAppendsAndClearEmpties) {
+    engine::PersistentBlockTable table(2);
+    const uint32_t row = 1;
+
+    std::vector<uint32_t> pages{7, 3};
+    table.sync_row(row, pages);
+    pages.push_back(9);
+    table.sync_row(row, pages);
+    EXPECT_EQ(table.row_length(row), 3u);
+    EXPECT_EQ(table.page_at(row, 0), 7);
+    EXPECT_EQ(table.page_at(row, 2), 9);
+    EXPECT_EQ(table.page_at(row, 3), -1);
+
+    table.clear_row(row);
+    EXPECT_EQ(table.row_length(row), 0u);
+    EXPECT_EQ(table.page_at(row, 0), -1);
+}
+
+TEST(PersistentBlockTableTest, GrowsKeepingRows) {
+    engine::PersistentBlockTable table(2);
+    const uint32_t first = 0;
+    const uint32_t second = 1;
+    table.sync_row(first, std::vector<uint32_t>{5});
+
+    std::vector<uint32_t> long_pages(engine::PersistentBlockTable::INITIAL_ROW_CAPACITY + 1);
+    for (size_t i = 0; i < long_pages.size(); ++i) {
+        long_pages[i] = static_cast<uint32_t>(100 + i);
+    }
+    table.sync_row(second, long_pages);
+
+    EXPECT_EQ(table.row_capacity(), 2 * engine::PersistentBlockTable::INITIAL_ROW_CAPACITY);
+    EXPECT_EQ(table.page_at(first, 0), 5);
+    EXPECT_EQ(table.page_at(first, 1), -1);
+    EXPECT_EQ(table.page_at(second, long_pages.size() - 1), static_cast<int32_t>(long_pages.back()));
+    EXPECT_EQ(table.array().shape(1), static_cast<int32_t>(table.row_capacity()));
+}
+
+TEST(BlockTableLayoutTest, CsrHasOffsetsAndNoPadding) {
+    const auto a = make_sequence(1, {4, 5, 6});
+    const auto b = make_sequence(2, {8});
+    const std::vector<engine::TokenChunk> chunks{{a.get(), 7, 1}, {b.get(), 7, 1}};
+
+    engine::BatchDetailsBuilder builder(2, 16);
+    const engine::BatchDetails& details = builder.build(chunks, {.layout = engine::BlockTableLayout::CSR});
+    ASSERT_TRUE(details.block_table_index.has_value());
+    const mx::array& offsets = *details.block_table_index;
+    ASSERT_EQ(offsets.size(), 3u);
+    EXPECT_EQ(offsets.data<int32_t>()[1], 3);
+    EXPECT_EQ(offsets.data<int32_t>()[2], 4);
+    ASSERT_EQ(details.consolidated_block_table.size(), 4u);
+    EXPECT_EQ(details.consolidated_block_table.data<int32_t>()[3], 8);
+}
+
+TEST(BlockTableLayoutTest, PersistentListsRows) {
+    const auto a = make_sequence(1, {4, 5});
+    engine::PersistentBlockTable table(4);
+    const uint32_t row = 1;
+    table.sync_row(row, a->page_table);
+
+    const std::vector<engine::TokenChunk> chunks{{a.get(), 7, 1}};
+    const std::vector<uint32_t> rows{row};
+    engine::BatchDetails details = engine::build_batch_details(
+        chunks, engine::gather_token_ids(chunks),
+        {.layout = engine::BlockTableLayout::PERSISTENT, .table = &table, .rows = rows});
+    ASSERT_TRUE(details.block_table_index.has_value());
+    EXPECT_EQ(details.block_table_index->data<int32_t>()[0], static_cast<int32_t>(row));
+    EXPECT_EQ(details.consolidated_block_table.shape(0), 4);
+
+    EXPECT_THROW(
+        engine::build_batch_details(chunks, engine::gather_token_ids(chunks),
+                                    {.layout = engine::BlockTableLayout::PERSISTENT}),
+        std::invalid_argument);
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "engine/budget_controller.hpp"
+#include <algorithm>
+
+using namespace pie_core;
+
+namespace {
+
+    // Step time of a model with 2 ms fixed cost and 10 us per token.
+    double step_us(size_t tokens) {
+        return 2000.0 + 10.0 * static_cast<double>(tokens);
+    }
+
+} // namespace
+
+TEST(BudgetControllerTest, DisabledKeepsTheMaximum) {
+    engine::BudgetController controller(4096);
+    for (int i = 0; i < 32; ++i) {
+        controller.observe(step_us(4096), 4096, true);
+    }
+    EXPECT_EQ(controller.token_budget(), 4096u);
+}
+
+TEST(BudgetControllerTest, ConvergesOnTheTargetStepTime) {
+    engine::BudgetController controller(4096);
+    controller.set_target(std::chrono::microseconds(20000)); // 1800 tokens fit
+
+    // Saturated: every step fills its budget.
+    for (int i = 0; i < 200; ++i) {
+        const size_t tokens = controller.token_budget();
+        controller.observe(step_us(tokens), tokens, true);
+    }
+    EXPECT_NEAR(static_cast<double>(controller.token_budget()), 1800.0, 90.0);
+
+    // The model gets twice as fast per token: the budget grows back.
+    for (int i = 0; i < 200; ++i) {
+        const size_t tokens = controller.token_budget();
+        controller.observe(2000.0 + 5.0 * static_cast<double>(tokens), tokens, true);
+    }
+    EXPECT_NEAR(static_cast<double>(controller.token_budget()), 3600.0, 180.0);
+}
+
+TEST(BudgetControllerTest, GrowsOnlyWhenTheBudgetBinds) {
+    engine::BudgetController controller(4096);
+    controller.set_target(std::chrono::microseconds(5000)); // 300 tokens fit
+    for (int i = 0; i < 100; ++i) {
+        const size_t tokens = controller.token_budget();
+        controller.observe(step_us(tokens), tokens, true);
+    }
+    const size_t budget = controller.token_budget();
+    EXPECT_LT(budget, 400u);
+
+    // A handful of decodes run far under target, but that says nothing about
+    // larger batches: the budget stays put.
+    for (int i = 0; i < 100; ++i) {
+        controller.observe(step_us(8), 8, true);
+    }
+    EXPECT_EQ(controller.token_budget(), budget);
+
+    // Prefill-only steps are ignored.
+    for (int i = 0; i < 100; ++i) {
+        controller.observe(step_us(4096), 4096, false);
+    }
+    EXPECT_EQ(controller.token_budget(), budget);
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include "ipc/bulk_arena.hpp"
+#include <vector>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <cstring>
+
+using namespace pie_core;
+
+// -----------------------------------------------------------------------------
+// Test fixture: a heap-backed stand-in for the bulk shared-memory segment
+// -----------------------------------------------------------------------------
+class BulkArenaTest : public ::testing::Test {
+public:
+    // Room for exactly 16 blocks of 64 bytes.
+    static constexpr size_t SMALL_SEGMENT = sizeof(ipc::BulkArenaControl) + 16 * ipc::BulkArena::BLOCK_ALIGNMENT;
+    static constexpr size_t LARGE_SEGMENT = sizeof(ipc::BulkArenaControl) + (1 << 20);
+
+protected:
+    struct alignas(64) CacheLine { std::byte bytes[64]; };
+    std::vector<CacheLine> storage_;
+
+    ipc::BulkArena make_arena(size_t segment_size) {
+        storage_.assign(segment_size / sizeof(CacheLine), CacheLine{});
+        ipc::BulkArena arena(storage_.data(), segment_size);
+        arena.initialize();
+        return arena;
+    }
+
+    // The payload area directly behind a block's header.
+    std::byte* payload(uint64_t offset) {
+        return reinterpret_cast<std::byte*>(storage_.data()) + offset + sizeof(ipc::BulkBlockHeader);
+    }
+};
+
+// --------------------------------------------------------------------------
+// Construction
+// --------------------------------------------------------------------------
+TEST_F(BulkArenaTest, RejectsTinySegment) {
+    std::byte buffer[sizeof(ipc::BulkArenaControl)];
+    EXPECT_THROW(ipc::BulkArena(buffer, sizeof(buffer)), std::invalid_argument);
+}
+
+// --------------------------------------------------------------------------
+// Single-threaded behaviour
+// --------------------------------------------------------------------------
+TEST_F(BulkArenaTest, AllocatesAlignedBlocksInOrder) {
+    auto arena = make_arena(SMALL_SEGMENT);
+    const auto a = arena.allocate(10);
+    const auto b = arena.allocate(100);
+    ASSERT_TRUE(a && b);
+    EXPECT_EQ(*a % ipc::BulkArena::BLOCK_ALIGNMENT, 0u);
+    EXPECT_EQ(*b - *a, ipc::BulkArena::BLOCK_ALIGNMENT);
+
+    auto* header = arena.block_at(*b);
+    EXPECT_EQ(header->state.load(), ipc::BulkBlockState::IN_USE);
+    EXPECT_EQ(header->size.load(), 2 * ipc::BulkArena::BLOCK_ALIGNMENT);
+    EXPECT_EQ(arena.used_bytes(), 3 * ipc::BulkArena::BLOCK_ALIGNMENT);
+}
+
+TEST_F(BulkArenaTest, OversizedRequestFails) {
+    auto arena = make_arena(SMALL_SEGMENT);
+    EXPECT_FALSE(arena.allocate(arena.capacity()));
+    EXPECT_EQ(arena.used_bytes(), 0u);
+}
+
+TEST_F(BulkArenaTest, FullArenaRecoversAfterRelease) {
+    auto arena = make_arena(SMALL_SEGMENT);
+    std::vector<uint64_t> blocks;
+    while (auto offset = arena.allocate(1)) blocks.push_back(*offset);
+    ASSERT_EQ(blocks.size(), 16u);
+
+    ipc::BulkArena::release(*arena.block_at(blocks[0]));
+    // allocate() reclaims on its own when full.
+    EXPECT_TRUE(arena.allocate(1));
+    EXPECT_FALSE(arena.allocate(1));
+}
+
+TEST_F(BulkArenaTest, OutOfOrderReleaseWaitsForOldestBlock) {
+    auto arena = make_arena(SMALL_SEGMENT);
+    const auto a = arena.allocate(1);
+    const auto b = arena.allocate(1);
+    const auto c = arena.allocate(1);
+    ASSERT_TRUE(a && b && c);
+
+    ipc::BulkArena::release(*arena.block_at(*b));
+    ipc::BulkArena::release(*arena.block_at(*c));
+    EXPECT_EQ(arena.reclaim(), 0u); // `a` still pins the tail
+
+    ipc::BulkArena::release(*arena.block_at(*a));
+    EXPECT_EQ(arena.reclaim(), 3 * ipc::BulkArena::BLOCK_ALIGNMENT);
+    EXPECT_EQ(arena.used_bytes(), 0u);
+}
+
+TEST_F(BulkArenaTest, WrapInsertsPaddingAndKeepsBlocksContiguous) {
+    auto arena = make_arena(SMALL_SEGMENT);
+    const size_t block = ipc::BulkArena::BLOCK_ALIGNMENT;
+    // Fill 12 of 16 slots, free them, then ask for 6 slots: only 4 fit before
+    // the end, so the block must start back at the beginning.
+    std::vector<uint64_t> blocks;
+    for (int i = 0; i < 12; ++i) blocks.push_back(*arena.allocate(1));
+    for (auto offset : blocks) ipc::BulkArena::release(*arena.block_at(offset));
+
+    const auto wrapped = arena.allocate(6 * block - sizeof(ipc::BulkBlockHeader));
+    ASSERT_TRUE(wrapped);
+    EXPECT_EQ(*wrapped, sizeof(ipc::BulkArenaControl));
+    EXPECT_EQ(arena.used_bytes(), 4 * block + 6 * block);
+
+    std::memset(payload(*wrapped), 0xAB, 6 * block - sizeof(ipc::BulkBlockHeader));
+    ipc::BulkArena::release(*arena.block_at(*wrapped));
+    arena.reclaim();
+    EXPECT_EQ(arena.used_bytes(), 0u);
+}
+
+TEST_F(BulkArenaTest, ReusesSpaceAcrossManyLaps) {
+    auto arena = make_arena(SMALL_SEGMENT);
+    std::deque<uint64_t> live;
+    for (int i = 0; i < 1000; ++i) {
+        const auto offset = arena.allocate((i % 3) * 50);
+        ASSERT_TRUE(offset) << "iteration " << i;
+        live.push_back(*offset);
+        if (live.size() > 3) {
+            ipc::BulkArena::release(*arena.block_at(live.front()));
+            live.pop_front();
+        }
+    }
+}
+
+// --------------------------------------------------------------------------
+// Concurrency
+// --------------------------------------------------------------------------
+TEST_F(BulkArenaTest, ConcurrentProducersNeverOverlap) {
+    const size_t num_producers = std::max(2u, std::thread::hardware_concurrency() - 1);
+    constexpr int blocks_per_producer = 5000;
+
+    auto arena = make_arena(LARGE_SEGMENT);
+    std::atomic<bool> start{false};
+    std::atomic<bool> corrupted{false};
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&, p] {
+            while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (int i = 0; i < blocks_per_producer; ++i) {
+                const size_t bytes = 16 + (i * 37) % 4000;
+                std::optional<uint64_t> offset;
+                while (!(offset = arena.allocate(bytes))) std::this_thread::yield();
+                // Stamp the payload, then verify nobody else wrote into it.
+                std::byte* data = payload(*offset);
+                std::memset(data, static_cast<int>(p + 1), bytes);
+                for (size_t b = 0; b < bytes; ++b) {
+                    if (data[b] != static_cast<std::byte>(p + 1)) corrupted.store(true);
+                }
+                ipc::BulkArena::release(*arena.block_at(*offset));
+            }
+        });
+    }
+    start.store(true, std::memory_order_release);
+    for (auto& t : producers) t.join();
+
+    EXPECT_FALSE(corrupted.load());
+    arena.reclaim();
+    EXPECT_EQ(arena.used_bytes(), 0u);
+}
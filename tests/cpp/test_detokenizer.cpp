@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "server/detokenizer.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace pie_core;
+
+namespace {
+
+    std::string write_tokenizer(const std::string& name, const std::string& contents) {
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+        std::ofstream(path) << contents;
+        return path.string();
+    }
+
+} // namespace
+
+TEST(DetokenizerTest, ByteLevelPieces) {
+    // "Ġ" is a space, and "Ã" + "©" are the two bytes of "é".
+    const std::string path = write_tokenizer("pie_test_byte_level.json", R"({
+        "model": {"vocab": {"Hello": 0, "Ġworld": 1, "Ã": 2, "©": 3}},
+        "decoder": {"type": "ByteLevel"},
+        "added_tokens": [{"id": 4, "content": "<|eot|>", "special": true}]
+    })");
+    const server::Detokenizer detokenizer(path);
+    std::remove(path.c_str());
+
+    EXPECT_EQ(detokenizer.vocab_size(), 5u);
+    EXPECT_EQ(detokenizer.token_bytes(1), " world");
+    EXPECT_EQ(detokenizer.token_bytes(4), "");
+    EXPECT_EQ(detokenizer.token_bytes(99), "");
+
+    server::StreamDecoder decoder(detokenizer);
+    std::string out;
+    decoder.append(0, out);
+    decoder.append(1, out);
+    EXPECT_EQ(out, "Hello world");
+    // Half a character is held back until it completes.
+    decoder.append(2, out);
+    EXPECT_EQ(out, "Hello world");
+    decoder.append(3, out);
+    EXPECT_EQ(out, "Hello world\xC3\xA9");
+}
+
+TEST(DetokenizerTest, SentencePiecePieces) {
+    const std::string path = write_tokenizer("pie_test_sentencepiece.json", R"({
+        "model": {"vocab": {"▁Hi": 0, "<0x0A>": 1, "<0xC3>": 2}},
+        "decoder": {"type": "Sequence", "decoders": [{"type": "Replace"}]}
+    })");
+    const server::Detokenizer detokenizer(path);
+    std::remove(path.c_str());
+
+    server::StreamDecoder decoder(detokenizer);
+    std::string out;
+    decoder.append(0, out);
+    decoder.append(1, out);
+    EXPECT_EQ(out, " Hi\n");
+    // A dangling lead byte at the end of the stream becomes U+FFFD.
+    decoder.append(2, out);
+    EXPECT_EQ(out, " Hi\n");
+    decoder.finish(out);
+    EXPECT_EQ(out, " Hi\n\xEF\xBF\xBD");
+}
+
+TEST(DetokenizerTest, MissingFileThrows) {
+    EXPECT_THROW(server::Detokenizer("/nonexistent/tokenizer.json"), std::runtime_error);
+}
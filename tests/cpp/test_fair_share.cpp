@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "engine/fair_share.hpp"
+#include <stdexcept>
+
+using namespace pie_core;
+
+namespace {
+
+    constexpr uint64_t SECOND_NS = 1'000'000'000;
+
+} // namespace
+
+TEST(FairShareTest, VirtualTimeAdvancesByTokensOverWeight) {
+    engine::FairShare fair_share;
+    fair_share.set_policy(1, {.weight = 2.0});
+    fair_share.add_work(1);
+    fair_share.add_work(2);
+
+    fair_share.charge(1, 100);
+    fair_share.charge(2, 100);
+
+    // The heavier tenant can process twice the tokens for the same virtual time.
+    EXPECT_DOUBLE_EQ(fair_share.virtual_time(1), 50.0);
+    EXPECT_DOUBLE_EQ(fair_share.virtual_time(2), 100.0);
+    EXPECT_DOUBLE_EQ(fair_share.weight(2), 1.0);
+}
+
+TEST(FairShareTest, IdleTenantDoesNotBankCredit) {
+    engine::FairShare fair_share;
+    fair_share.add_work(1);
+    fair_share.charge(1, 500);
+
+    // Tenant 2 was idle all along: it starts level with tenant 1, not at zero.
+    fair_share.add_work(2);
+    EXPECT_DOUBLE_EQ(fair_share.virtual_time(2), 500.0);
+
+    // An idle tenant without a policy is forgotten.
+    fair_share.remove_work(2);
+    EXPECT_EQ(fair_share.num_tenants(), 1u);
+    fair_share.set_policy(3, {.weight = 4.0});
+    fair_share.add_work(3);
+    fair_share.remove_work(3);
+    EXPECT_EQ(fair_share.num_tenants(), 2u);
+}
+
+TEST(FairShareTest, TokenBucketLimitsAndRefills) {
+    engine::FairShare fair_share;
+    fair_share.set_policy(7, {.weight = 1.0, .tokens_per_second = 100.0, .burst_tokens = 0.0});
+    fair_share.refill(SECOND_NS);
+    EXPECT_FALSE(fair_share.rate_limited(7));
+
+    // A full bucket holds one second's worth; overdrawing it puts the tenant in debt.
+    fair_share.charge(7, 150);
+    EXPECT_TRUE(fair_share.rate_limited(7));
+
+    fair_share.refill(SECOND_NS + SECOND_NS / 4); // +25 tokens, still -25
+    EXPECT_TRUE(fair_share.rate_limited(7));
+    fair_share.refill(SECOND_NS * 2); // +75 more, back to 50
+    EXPECT_FALSE(fair_share.rate_limited(7));
+
+    // Unlimited tenants are never limited.
+    fair_share.charge(8, 1'000'000);
+    EXPECT_FALSE(fair_share.rate_limited(8));
+}
+
+TEST(FairShareTest, NextRefillIsWhenAWaitingTenantRecovers) {
+    engine::FairShare fair_share;
+    fair_share.set_policy(7, {.weight = 1.0, .tokens_per_second = 100.0, .burst_tokens = 0.0});
+    fair_share.refill(SECOND_NS);
+    EXPECT_EQ(fair_share.next_refill_ns(), UINT64_MAX);
+
+    fair_share.charge(7, 150); // 50 in debt: back in half a second
+    EXPECT_EQ(fair_share.next_refill_ns(), UINT64_MAX); // Nothing queued for it
+
+    fair_share.add_work(7);
+    const uint64_t refill_at = fair_share.next_refill_ns();
+    EXPECT_GT(refill_at, SECOND_NS + SECOND_NS / 2);
+    EXPECT_LT(refill_at, SECOND_NS + SECOND_NS / 2 + 1'000);
+    fair_share.refill(refill_at);
+    EXPECT_FALSE(fair_share.rate_limited(7));
+}
+
+TEST(FairShareTest, RejectsInvalidPolicies) {
+    engine::FairShare fair_share;
+    EXPECT_THROW(fair_share.set_policy(1, {.weight = 0.0}), std::invalid_argument);
+    EXPECT_THROW(fair_share.set_policy(1, {.weight = 1.0, .tokens_per_second = -1.0}), std::invalid_argument);
+    EXPECT_THROW(fair_share.set_policy(1, {.weight = 1.0, .tokens_per_second = 0.0, .burst_tokens = -1.0}),
+                 std::invalid_argument);
+    EXPECT_EQ(fair_share.num_tenants(), 0u);
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include "api/generation.hpp"
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+using namespace pie_core;
+
+namespace {
+
+    // Generation only keeps the engine's address, for cancelling; nothing here
+    // cancels, so these tests need no model.
+    alignas(api::Engine) std::byte engine_storage[sizeof(api::Engine)];
+
+    api::Engine& unused_engine() {
+        return *reinterpret_cast<api::Engine*>(engine_storage);
+    }
+
+    std::optional<api::Generation> make_generation(const std::shared_ptr<engine::TokenStream>& stream) {
+        return api::Generation(unused_engine(), stream);
+    }
+
+} // namespace
+
+TEST(GenerationTest, TokensOutliveTheGeneration) {
+    const auto stream = std::make_shared<engine::TokenStream>(7);
+    stream->push({.token_id = 3, .finish_reason = api::FinishReason::NONE});
+    stream->push({.token_id = 4, .finish_reason = api::FinishReason::LENGTH});
+
+    // The temporary Generation is gone before the generator first resumes.
+    api::Generator<api::StreamToken> tokens = make_generation(stream)->tokens();
+    EXPECT_EQ(stream.use_count(), 2); // This test's and the generator's
+
+    std::vector<int32_t> token_ids;
+    for (const api::StreamToken& token : tokens) {
+        token_ids.push_back(token.token_id);
+    }
+    EXPECT_EQ(token_ids, (std::vector<int32_t>{3, 4}));
+}
+
+TEST(GenerationTest, CollectStopsAtTheFinishReason) {
+    const auto stream = std::make_shared<engine::TokenStream>(8);
+    stream->push({.token_id = 5, .finish_reason = api::FinishReason::NONE});
+    stream->push({.token_id = -1, .finish_reason = api::FinishReason::CANCELLED});
+
+    const auto [token_ids, finish_reason] = make_generation(stream)->collect();
+    EXPECT_EQ(token_ids, (std::vector<int32_t>{5}));
+    EXPECT_EQ(finish_reason, api::FinishReason::CANCELLED);
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include "api/generator.hpp"
+#include <stdexcept>
+#include <vector>
+
+using namespace pie_core;
+
+namespace {
+
+    api::Generator<int> count_to(int n, int& destroyed) {
+        struct Guard {
+            int& destroyed;
+            ~Guard() { ++destroyed; }
+        } guard{destroyed};
+        for (int i = 0; i < n; ++i) {
+            co_yield i;
+        }
+    }
+
+    api::Generator<int> throws_after_one() {
+        co_yield 1;
+        throw std::runtime_error("boom");
+    }
+
+} // namespace
+
+TEST(GeneratorTest, YieldsLazilyInOrder) {
+    int destroyed = 0;
+    api::Generator<int> generator = count_to(3, destroyed);
+    std::vector<int> values;
+    for (const int value : generator) {
+        values.push_back(value);
+    }
+    EXPECT_EQ(values, (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(destroyed, 1);
+}
+
+TEST(GeneratorTest, AbandoningEarlyUnwindsTheBody) {
+    int destroyed = 0;
+    {
+        api::Generator<int> generator = count_to(100, destroyed);
+        auto it = generator.begin();
+        EXPECT_EQ(*it, 0);
+        ++it;
+        EXPECT_EQ(*it, 1);
+        EXPECT_EQ(destroyed, 0);
+    }
+    EXPECT_EQ(destroyed, 1);
+}
+
+TEST(GeneratorTest, RethrowsFromIncrement) {
+    api::Generator<int> generator = throws_after_one();
+    auto it = generator.begin();
+    EXPECT_EQ(*it, 1);
+    EXPECT_THROW(++it, std::runtime_error);
+    EXPECT_TRUE(it == std::default_sentinel);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "server/generation_request.hpp"
+#include "server/http_request.hpp"
+#include <string>
+#include <vector>
+
+using namespace pie_core;
+
+TEST(HttpRequestTest, ParsesRequestWithBody) {
+    const std::string raw =
+        "POST /v1/completions HTTP/1.1\r\nHost: x\r\nContent-Length: 4\r\n\r\n{\"a\"}extra";
+    const server::ParseResult result = server::parse_http_request(raw, 1024);
+    ASSERT_EQ(result.status, server::ParseStatus::COMPLETE);
+    EXPECT_EQ(result.request.method, "POST");
+    EXPECT_EQ(result.request.target, "/v1/completions");
+    EXPECT_EQ(result.request.body, "{\"a\"");
+    EXPECT_TRUE(result.request.keep_alive);
+    // Pipelined bytes after the body are left for the next request.
+    EXPECT_EQ(raw.substr(result.consumed), "}extra");
+}
+
+TEST(HttpRequestTest, IncompleteUntilBodyArrives) {
+    EXPECT_EQ(server::parse_http_request("GET /health HTTP/1.1\r\nHost:", 1024).status,
+              server::ParseStatus::INCOMPLETE);
+    EXPECT_EQ(server::parse_http_request("POST / HTTP/1.1\r\nContent-Length: 10\r\n\r\nabc", 1024).status,
+              server::ParseStatus::INCOMPLETE);
+}
+
+TEST(HttpRequestTest, ConnectionHeaderControlsKeepAlive) {
+    const auto close = server::parse_http_request("GET / HTTP/1.1\r\nConnection: close\r\n\r\n", 1024);
+    ASSERT_EQ(close.status, server::ParseStatus::COMPLETE);
+    EXPECT_FALSE(close.request.keep_alive);
+
+    const auto http10 = server::parse_http_request("GET / HTTP/1.0\r\n\r\n", 1024);
+    ASSERT_EQ(http10.status, server::ParseStatus::COMPLETE);
+    EXPECT_FALSE(http10.request.keep_alive);
+}
+
+TEST(HttpRequestTest, RejectsUnsupportedRequests) {
+    const auto chunked = server::parse_http_request(
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", 1024);
+    EXPECT_EQ(chunked.status, server::ParseStatus::ERROR);
+    EXPECT_EQ(chunked.error_status, 411);
+
+    const auto too_large = server::parse_http_request("POST / HTTP/1.1\r\nContent-Length: 2048\r\n\r\n", 1024);
+    EXPECT_EQ(too_large.status, server::ParseStatus::ERROR);
+    EXPECT_EQ(too_large.error_status, 413);
+
+    const auto malformed = server::parse_http_request("garbage\r\n\r\n", 1024);
+    EXPECT_EQ(malformed.status, server::ParseStatus::ERROR);
+    EXPECT_EQ(malformed.error_status, 400);
+}
+
+TEST(GenerationRequestTest, DecodesFields) {
+    const std::vector<int32_t> eos{2};
+    const server::DecodeResult result = server::decode_generation_request(
+        R"({"prompt":[[5,6,7]],"temperature":0.5,"max_tokens":16,"priority":"batch","stream":true,"logit_bias":{"9":-1.5}})",
+        false, eos);
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.request.prompt, (std::vector<int32_t>{5, 6, 7}));
+    EXPECT_FLOAT_EQ(result.request.payload.sampling_params.temperature, 0.5f);
+    EXPECT_EQ(result.request.payload.max_generated_tokens, 16);
+    EXPECT_EQ(result.request.payload.scheduling_params.priority, sequence::Priority::BATCH);
+    EXPECT_TRUE(result.request.stream);
+    ASSERT_EQ(result.request.logit_bias.size(), 1u);
+    EXPECT_EQ(result.request.logit_bias[0].token_id, 9);
+    EXPECT_EQ(result.request.stop_token_ids, eos);
+}
+
+TEST(GenerationRequestTest, RefusesWrongTypedFields) {
+    const std::vector<int32_t> eos{2};
+    const char* bodies[] = {
+        R"({"prompt":[1],"temperature":"hot"})",
+        R"({"prompt":[1],"top_p":[0.5]})",
+        R"({"prompt":[1],"max_tokens":"many"})",
+        R"({"prompt":[1],"max_tokens":1.5})",
+        R"({"prompt":[1],"max_tokens":1e12})",
+        R"({"prompt":[1],"max_tokens":99999999999})",
+        R"({"prompt":[1],"max_tokens":0})",
+        R"({"prompt":[1],"priority":3})",
+        R"({"prompt":[1],"stream":"yes"})",
+        R"({"prompt":[1],"ttft_deadline_ms":-1})",
+        R"({"prompt":[1],"tenant_id":{}})",
+        R"({"prompt":[1],"ignore_eos":1})",
+        R"({"prompt":[1],"logit_bias":[1,2]})",
+        R"({"prompt":[1],"logit_bias":{"9":"up"}})",
+        R"({"prompt":[1],"stop_token_ids":"x"})",
+        R"({"prompt":[4294967296]})",
+        R"({"prompt":"text"})",
+        R"([1,2])",
+        "not json",
+    };
+    for (const char* body : bodies) {
+        server::DecodeResult result;
+        ASSERT_NO_THROW(result = server::decode_generation_request(body, false, eos)) << body;
+        EXPECT_FALSE(result.ok) << body;
+        EXPECT_FALSE(result.error.empty()) << body;
+    }
+}
+
+TEST(GenerationRequestTest, RefusesTextInputByName) {
+    const std::vector<int32_t> eos{2};
+    for (const char* body : {R"({"prompt":"Hello"})", R"({"prompt":["Hello"]})"}) {
+        const auto result = server::decode_generation_request(body, false, eos);
+        EXPECT_FALSE(result.ok) << body;
+        EXPECT_NE(result.error.find("does not tokenize"), std::string::npos) << result.error;
+    }
+    const auto chat = server::decode_generation_request(
+        R"({"messages":[{"role":"user","content":"Hi"}]})", true, eos);
+    EXPECT_FALSE(chat.ok);
+    EXPECT_NE(chat.error.find("`messages`"), std::string::npos) << chat.error;
+}
+
+TEST(GenerationRequestTest, ChatNeedsTokenIdsAndIgnoreEosDropsThem) {
+    const std::vector<int32_t> eos{2};
+    EXPECT_FALSE(server::decode_generation_request(R"({"messages":[]})", true, eos).ok);
+    const auto result = server::decode_generation_request(
+        R"({"prompt_token_ids":[1,2],"ignore_eos":true,"stop_token_ids":[7]})", true, eos);
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(result.request.stop_token_ids, (std::vector<int32_t>{7}));
+}
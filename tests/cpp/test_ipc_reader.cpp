@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "ipc/ipc_reader.hpp"
+#include "ipc/request_writer.hpp"
+#include "sequence/sequence.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace pie_core;
+
+// -----------------------------------------------------------------------------
+// Test fixture: an IPCReader on a private request segment, run on its own thread
+// -----------------------------------------------------------------------------
+class IPCReaderTest : public ::testing::Test {
+protected:
+    const std::string shm_name_ = "/pie_test_requests_" + std::to_string(getpid());
+    ipc::IPCReader::SequenceQueueType queue_{256};
+    ipc::IPCReader reader_{queue_, shm_name_};
+    std::thread reader_thread_;
+
+    void start() {
+        reader_thread_ = std::thread([this] { reader_.run(); });
+    }
+
+    void TearDown() override {
+        reader_.stop();
+        if (reader_thread_.joinable()) {
+            reader_thread_.join();
+        }
+    }
+
+    // Waits for `count` sequences from the reader.
+    std::vector<std::unique_ptr<sequence::Sequence>> receive(size_t count) {
+        std::vector<std::unique_ptr<sequence::Sequence>> sequences;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (sequences.size() < count && std::chrono::steady_clock::now() < deadline) {
+            queue_.wait_for_data(std::chrono::milliseconds(10));
+            queue_.pop_batch(std::back_inserter(sequences));
+        }
+        return sequences;
+    }
+
+    static ipc::RequestPayload payload(uint64_t request_id) {
+        ipc::RequestPayload payload;
+        payload.request_id = request_id;
+        payload.ipc_handles.response_channel_id = request_id;
+        return payload;
+    }
+};
+
+TEST_F(IPCReaderTest, HandsOverRequestsWithTheirPrompts) {
+    start();
+    ipc::RequestWriter writer(shm_name_);
+    const std::vector<int32_t> prompt{5, 6, 7};
+    const std::vector<int32_t> stop{2};
+    ASSERT_EQ(writer.submit(payload(1), prompt, {}, stop), ipc::SubmitStatus::ACCEPTED);
+
+    auto sequences = receive(1);
+    ASSERT_EQ(sequences.size(), 1u);
+    const sequence::Sequence& sequence = *sequences[0];
+    EXPECT_EQ(sequence.sequence_id, 1u);
+    EXPECT_EQ(sequence.status, sequence::SequenceStatus::WAITING);
+    EXPECT_EQ(sequence.prompt_len, 3u);
+    EXPECT_EQ(sequence.token_at(2), 7);
+    EXPECT_EQ(sequence.stop_criteria.stop_token_ids, stop);
+}
+
+TEST_F(IPCReaderTest, MalformedRequestIsHandedOverFailed) {
+    start();
+    ipc::RequestWriter writer(shm_name_);
+    ASSERT_EQ(writer.submit(payload(2), {}), ipc::SubmitStatus::ACCEPTED); // Empty prompt
+
+    const auto sequences = receive(1);
+    ASSERT_EQ(sequences.size(), 1u);
+    EXPECT_EQ(sequences[0]->sequence_id, 2u);
+    EXPECT_EQ(sequences[0]->status, sequence::SequenceStatus::ERROR);
+    EXPECT_EQ(sequences[0]->ipc_handles.response_channel_id, 2u); // So its client can be answered
+}
+
+TEST_F(IPCReaderTest, BusyShardDoesNotStarveTheOthers) {
+    ipc::RequestWriter busy(shm_name_, ipc::BULK_DATA_SHM_NAME, 0);
+    ipc::RequestWriter quiet(shm_name_, ipc::BULK_DATA_SHM_NAME, 1);
+    const std::vector<int32_t> prompt{1};
+    constexpr size_t per_pass = ipc::IPCReader::MAX_REQUESTS_PER_SHARD;
+    constexpr uint64_t quiet_id = 1000;
+
+    // A backlog of several passes on one shard, then one request on another.
+    const size_t backlog = 3 * per_pass;
+    for (uint64_t id = 1; id <= backlog; ++id) {
+        ASSERT_EQ(busy.submit(payload(id), prompt), ipc::SubmitStatus::ACCEPTED);
+    }
+    ASSERT_EQ(quiet.submit(payload(quiet_id), prompt), ipc::SubmitStatus::ACCEPTED);
+    start();
+
+    const auto sequences = receive(backlog + 1);
+    ASSERT_EQ(sequences.size(), backlog + 1);
+    const auto quiet_it = std::ranges::find_if(sequences, [](const auto& sequence) {
+        return sequence->sequence_id == quiet_id;
+    });
+    ASSERT_NE(quiet_it, sequences.end());
+    EXPECT_LE(static_cast<size_t>(quiet_it - sequences.begin()), per_pass); // Within the first pass
+
+    // Each shard's requests still arrive in the order they were published.
+    uint64_t last_busy_id = 0;
+    for (const auto& sequence : sequences) {
+        if (sequence->sequence_id != quiet_id) {
+            EXPECT_EQ(sequence->sequence_id, last_busy_id + 1);
+            last_busy_id = sequence->sequence_id;
+        }
+    }
+}
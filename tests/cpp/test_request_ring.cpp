@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include "ipc/request_ring.hpp"
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+using namespace pie_core;
+
+// -----------------------------------------------------------------------------
+// Test fixture: a heap-backed stand-in for the shared-memory segment
+// -----------------------------------------------------------------------------
+class RequestRingTest : public ::testing::Test {
+public:
+    struct Control {
+        alignas(64) std::atomic<uint64_t> producer_idx{0};
+        alignas(64) std::atomic<uint64_t> consumer_idx{0};
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence{0};
+        uint64_t producer{0};
+        uint64_t value{0};
+    };
+
+    using Ring = ipc::RequestRing<Slot, Control>;
+
+    static constexpr size_t SMALL_CAPACITY = 8;
+    static constexpr size_t LARGE_CAPACITY = 1024;
+
+protected:
+    Control control_;
+    std::unique_ptr<Slot[]> slots_;
+
+    Ring make_ring(size_t capacity) {
+        slots_ = std::make_unique<Slot[]>(capacity);
+        Ring ring(&control_, slots_.get(), capacity);
+        ring.initialize();
+        return ring;
+    }
+};
+
+namespace {
+
+bool push(RequestRingTest::Ring& ring, uint64_t value, uint64_t producer = 0) {
+    uint64_t pos = 0;
+    auto* slot = ring.try_claim(pos);
+    if (slot == nullptr) return false;
+    slot->producer = producer;
+    slot->value = value;
+    ring.publish(pos);
+    return true;
+}
+
+std::vector<uint64_t> drain(RequestRingTest::Ring& ring) {
+    std::vector<uint64_t> values;
+    uint64_t first = 0;
+    size_t count = 0;
+    while ((count = ring.try_claim_range(first, ring.capacity())) > 0) {
+        for (uint64_t pos = first; pos < first + count; ++pos) {
+            values.push_back(ring.at(pos).value);
+            ring.release(pos);
+        }
+    }
+    return values;
+}
+
+} // namespace
+
+// --------------------------------------------------------------------------
+// Construction
+// --------------------------------------------------------------------------
+TEST_F(RequestRingTest, RejectsNonPowerOfTwoCapacity) {
+    Slot slots[6];
+    EXPECT_THROW(Ring(&control_, slots, 6), std::invalid_argument);
+    EXPECT_THROW(Ring(&control_, slots, 0), std::invalid_argument);
+}
+
+// --------------------------------------------------------------------------
+// Single-threaded behaviour
+// --------------------------------------------------------------------------
+TEST_F(RequestRingTest, EmptyRingClaimsNothing) {
+    auto ring = make_ring(SMALL_CAPACITY);
+    uint64_t first = 0;
+    EXPECT_EQ(ring.try_claim_range(first, SMALL_CAPACITY), 0u);
+    EXPECT_EQ(ring.size_approx(), 0u);
+}
+
+TEST_F(RequestRingTest, FifoOrder) {
+    auto ring = make_ring(SMALL_CAPACITY);
+    for (uint64_t i = 0; i < 5; ++i) ASSERT_TRUE(push(ring, i));
+    EXPECT_EQ(ring.size_approx(), 5u);
+    EXPECT_EQ(drain(ring), (std::vector<uint64_t>{0, 1, 2, 3, 4}));
+    EXPECT_EQ(ring.size_approx(), 0u);
+}
+
+TEST_F(RequestRingTest, FullRingRejectsUntilReleased) {
+    auto ring = make_ring(SMALL_CAPACITY);
+    for (uint64_t i = 0; i < SMALL_CAPACITY; ++i) ASSERT_TRUE(push(ring, i));
+    EXPECT_FALSE(push(ring, 99));
+
+    uint64_t first = 0;
+    ASSERT_EQ(ring.try_claim_range(first, 1), 1u);
+    // Claimed but not yet released: still full.
+    EXPECT_FALSE(push(ring, 99));
+    ring.release(first);
+    EXPECT_TRUE(push(ring, 99));
+}
+
+TEST_F(RequestRingTest, ClaimRangeStopsAtUnpublishedSlot) {
+    auto ring = make_ring(SMALL_CAPACITY);
+    ASSERT_TRUE(push(ring, 0));
+    uint64_t held = 0;
+    ASSERT_NE(ring.try_claim(held), nullptr); // claimed, never published
+    ASSERT_TRUE(push(ring, 2));
+
+    uint64_t first = 0;
+    EXPECT_EQ(ring.try_claim_range(first, SMALL_CAPACITY), 1u);
+    EXPECT_EQ(first, 0u);
+    ring.release(first);
+    EXPECT_EQ(ring.try_claim_range(first, SMALL_CAPACITY), 0u);
+
+    ring.at(held).value = 1;
+    ring.publish(held);
+    EXPECT_EQ(drain(ring), (std::vector<uint64_t>{1, 2}));
+}
+
+TEST_F(RequestRingTest, WrapsAroundManyLaps) {
+    auto ring = make_ring(SMALL_CAPACITY);
+    uint64_t next = 0;
+    for (int lap = 0; lap < 20; ++lap) {
+        for (size_t i = 0; i < SMALL_CAPACITY - 1; ++i) ASSERT_TRUE(push(ring, next + i));
+        const auto values = drain(ring);
+        ASSERT_EQ(values.size(), SMALL_CAPACITY - 1);
+        for (size_t i = 0; i < values.size(); ++i) EXPECT_EQ(values[i], next + i);
+        next += SMALL_CAPACITY - 1;
+    }
+}
+
+// --------------------------------------------------------------------------
+// Concurrency
+// --------------------------------------------------------------------------
+TEST_F(RequestRingTest, ConcurrentProducersPreservePerProducerOrder) {
+    const size_t num_producers = std::max(2u, std::thread::hardware_concurrency() - 1);
+    constexpr uint64_t items_per_producer = 20000;
+
+    auto ring = make_ring(LARGE_CAPACITY);
+    std::atomic<bool> start{false};
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&, p] {
+            while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (uint64_t i = 0; i < items_per_producer; ++i) {
+                while (!push(ring, i, p)) std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<uint64_t> next_expected(num_producers, 0);
+    size_t received = 0;
+    const size_t total = num_producers * items_per_producer;
+    start.store(true, std::memory_order_release);
+    while (received < total) {
+        uint64_t first = 0;
+        const size_t count = ring.try_claim_range(first, LARGE_CAPACITY);
+        for (uint64_t pos = first; pos < first + count; ++pos) {
+            const auto& slot = ring.at(pos);
+            ASSERT_EQ(slot.value, next_expected[slot.producer]++) << "producer " << slot.producer;
+            ring.release(pos);
+        }
+        received += count;
+    }
+    for (auto& t : producers) t.join();
+
+    for (auto n : next_expected) EXPECT_EQ(n, items_per_producer);
+    EXPECT_EQ(ring.size_approx(), 0u);
+}
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include "ipc/response_writer.hpp"
+#include "ipc/response_reader.hpp"
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <unistd.h>
+
+using namespace pie_core;
+
+// -----------------------------------------------------------------------------
+// Test fixture: an engine-side writer and a client-side reader on a private segment
+// -----------------------------------------------------------------------------
+class ResponseChannelTest : public ::testing::Test {
+protected:
+    const std::string shm_name_ = "/pie_test_responses_" + std::to_string(getpid());
+    ipc::ResponseWriter writer_{shm_name_};
+    ipc::ResponseReader reader_{shm_name_};
+
+    std::vector<ipc::ResponseEntry> read_all(uint64_t channel_id) {
+        std::vector<ipc::ResponseEntry> entries(ipc::RESPONSE_CHANNEL_CAPACITY);
+        entries.resize(reader_.read(channel_id, entries.data(), entries.size()));
+        return entries;
+    }
+};
+
+// --------------------------------------------------------------------------
+// Channel ownership
+// --------------------------------------------------------------------------
+TEST_F(ResponseChannelTest, ClaimsDistinctChannelsUntilExhausted) {
+    std::vector<bool> seen(ipc::RESPONSE_NUM_CHANNELS, false);
+    for (size_t i = 0; i < ipc::RESPONSE_NUM_CHANNELS; ++i) {
+        const auto channel = reader_.claim_channel();
+        ASSERT_TRUE(channel);
+        EXPECT_FALSE(seen[*channel]);
+        seen[*channel] = true;
+    }
+    EXPECT_FALSE(reader_.claim_channel());
+    reader_.release_channel(7);
+    EXPECT_EQ(reader_.claim_channel(), 7u);
+}
+
+TEST_F(ResponseChannelTest, CancelWordReachesTheEngineAndClearsOnClaim) {
+    const uint64_t channel = *reader_.claim_channel();
+    const std::atomic<uint32_t>* word = writer_.cancel_word(channel);
+    ASSERT_NE(word, nullptr);
+    EXPECT_EQ(word->load(), 0u);
+
+    reader_.cancel(channel);
+    EXPECT_NE(word->load(), 0u);
+
+    // The next owner of the channel starts uncancelled.
+    reader_.release_channel(channel);
+    for (size_t i = 0; i < ipc::RESPONSE_NUM_CHANNELS; ++i) {
+        if (reader_.claim_channel() == channel) {
+            break;
+        }
+    }
+    EXPECT_EQ(word->load(), 0u);
+    EXPECT_EQ(writer_.cancel_word(ipc::RESPONSE_NUM_CHANNELS), nullptr);
+}
+
+// --------------------------------------------------------------------------
+// Streaming
+// --------------------------------------------------------------------------
+TEST_F(ResponseChannelTest, DeliversTokensInOrder) {
+    const uint64_t channel = *reader_.claim_channel();
+    writer_.emit(channel, 11, -0.5f, "Hello");
+    writer_.emit(channel, 12, std::nullopt, " world", ipc::FinishReason::STOP);
+    writer_.flush();
+
+    const auto entries = read_all(channel);
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].token_id, 11);
+    EXPECT_TRUE(entries[0].flags & ipc::RESPONSE_HAS_LOGPROB);
+    EXPECT_FLOAT_EQ(entries[0].logprob, -0.5f);
+    EXPECT_EQ(std::string(entries[0].text, entries[0].text_len), "Hello");
+    EXPECT_EQ(entries[0].finish_reason, ipc::FinishReason::NONE);
+    EXPECT_FALSE(entries[1].flags & ipc::RESPONSE_HAS_LOGPROB);
+    EXPECT_EQ(entries[1].finish_reason, ipc::FinishReason::STOP);
+}
+
+TEST_F(ResponseChannelTest, LongTextSpansContinuationEntries) {
+    const uint64_t channel = *reader_.claim_channel();
+    const std::string text(ipc::RESPONSE_TEXT_CAPACITY * 2 + 5, 'x');
+    writer_.emit(channel, 42, std::nullopt, text);
+
+    const auto entries = read_all(channel);
+    ASSERT_EQ(entries.size(), 3u);
+    std::string joined;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        joined.append(entries[i].text, entries[i].text_len);
+        EXPECT_EQ(static_cast<bool>(entries[i].flags & ipc::RESPONSE_TEXT_CONTINUES), i + 1 < entries.size());
+    }
+    EXPECT_EQ(joined, text);
+    EXPECT_EQ(entries.back().token_id, 42);
+    EXPECT_EQ(entries.front().token_id, -1);
+}
+
+TEST_F(ResponseChannelTest, SlowClientIsBackloggedNotDropped) {
+    const uint64_t channel = *reader_.claim_channel();
+    const int total = static_cast<int>(ipc::RESPONSE_CHANNEL_CAPACITY) + 10;
+    for (int i = 0; i < total; ++i) writer_.emit(channel, i, std::nullopt, {});
+    writer_.flush();
+    EXPECT_EQ(writer_.backlog_size(), 10u);
+
+    std::vector<int32_t> tokens;
+    for (const auto& entry : read_all(channel)) tokens.push_back(entry.token_id);
+    // Anything emitted now must queue behind the backlog.
+    writer_.emit(channel, total, std::nullopt, {});
+    writer_.flush();
+    EXPECT_EQ(writer_.backlog_size(), 0u);
+    for (const auto& entry : read_all(channel)) tokens.push_back(entry.token_id);
+
+    ASSERT_EQ(tokens.size(), static_cast<size_t>(total + 1));
+    for (int i = 0; i <= total; ++i) EXPECT_EQ(tokens[i], i);
+}
+
+TEST_F(ResponseChannelTest, ClientThatStopsReadingIsCutOff) {
+    const uint64_t channel = *reader_.claim_channel();
+    const int total = static_cast<int>(ipc::RESPONSE_CHANNEL_CAPACITY + ipc::ResponseWriter::MAX_BACKLOG_ENTRIES) + 1;
+    for (int i = 0; i < total; ++i) writer_.emit(channel, i, std::nullopt, {});
+    EXPECT_NE(writer_.cancel_word(channel)->load(), 0u);
+    EXPECT_EQ(writer_.backlog_size(), 1u);
+
+    // Output after the cut is dropped up to the request's own end.
+    writer_.emit(channel, total, std::nullopt, {});
+    writer_.finish(channel, ipc::FinishReason::CANCELLED);
+    writer_.flush();
+    std::vector<ipc::ResponseEntry> entries = read_all(channel);
+    writer_.flush();
+    const std::vector<ipc::ResponseEntry> rest = read_all(channel);
+    entries.insert(entries.end(), rest.begin(), rest.end());
+    ASSERT_EQ(entries.size(), ipc::RESPONSE_CHANNEL_CAPACITY + 1);
+    EXPECT_EQ(entries[ipc::RESPONSE_CHANNEL_CAPACITY - 1].token_id, static_cast<int32_t>(ipc::RESPONSE_CHANNEL_CAPACITY) - 1);
+    EXPECT_EQ(entries.back().finish_reason, ipc::FinishReason::ERROR);
+    EXPECT_EQ(writer_.backlog_size(), 0u);
+
+    // The channel's next request streams normally.
+    writer_.emit(channel, 7, std::nullopt, {});
+    writer_.flush();
+    ASSERT_EQ(read_all(channel).size(), 1u);
+}
+
+TEST_F(ResponseChannelTest, ReleasedChannelsBacklogIsDropped) {
+    const uint64_t channel = *reader_.claim_channel();
+    const int total = static_cast<int>(ipc::RESPONSE_CHANNEL_CAPACITY) + 10;
+    for (int i = 0; i < total; ++i) writer_.emit(channel, i, std::nullopt, {});
+    EXPECT_EQ(writer_.backlog_size(), 10u);
+
+    reader_.release_channel(channel);
+    writer_.flush();
+    EXPECT_EQ(writer_.backlog_size(), 0u);
+    writer_.emit(channel, total, std::nullopt, {}, ipc::FinishReason::CANCELLED);
+    EXPECT_EQ(writer_.backlog_size(), 0u);
+}
+
+TEST_F(ResponseChannelTest, OneWakeupPerFlush) {
+    const uint64_t a = *reader_.claim_channel();
+    const uint64_t b = *reader_.claim_channel();
+    const uint32_t before = reader_.snapshot();
+    writer_.emit(a, 1, std::nullopt, {});
+    writer_.emit(b, 2, std::nullopt, {});
+    EXPECT_EQ(reader_.snapshot(), before); // visible, but nobody woken yet
+    writer_.flush();
+    EXPECT_EQ(reader_.snapshot(), before + 1);
+    writer_.flush(); // nothing new: no wakeup
+    EXPECT_EQ(reader_.snapshot(), before + 1);
+}
+
+TEST_F(ResponseChannelTest, WaitingReaderIsWokenByFlush) {
+    const uint64_t channel = *reader_.claim_channel();
+    std::atomic<bool> woke{false};
+    const uint32_t observed = reader_.snapshot();
+    std::thread client([&] {
+        woke.store(reader_.wait(observed, std::chrono::seconds(5)));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writer_.emit(channel, 5, std::nullopt, {}, ipc::FinishReason::LENGTH);
+    writer_.flush();
+    client.join();
+    EXPECT_TRUE(woke.load());
+    EXPECT_EQ(read_all(channel).size(), 1u);
+}
@@ -0,0 +1,302 @@
+#include <gtest/gtest.h>
+#include "engine/scheduler.hpp"
+#include "engine/page_allocator.hpp"
+#include "engine/token_sink.hpp"
+#include "ipc/ipc_request.hpp"
+#include "models/imodel.hpp"
+#include "sequence/sequence.hpp"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using namespace pie_core;
+
+namespace {
+
+    constexpr int32_t NUM_KV_HEADS = 1;
+    constexpr int32_t HEAD_DIM = 16;
+    constexpr int32_t VOCAB_SIZE = 8;
+    constexpr int32_t NEXT_TOKEN = 3; // What the stub model always predicts
+
+    // Predicts NEXT_TOKEN for every position, and counts its forward passes.
+    // A delay gives steps a duration deadlines can be measured against.
+    class StubModel final : public models::IModel {
+    public:
+        StubModel(size_t& num_forwards, std::chrono::milliseconds delay)
+            : num_forwards_(num_forwards), delay_(delay) {}
+
+        mx::array forward(const engine::BatchDetails& batch_details) const override {
+            ++num_forwards_;
+            if (delay_.count() > 0) {
+                std::this_thread::sleep_for(delay_);
+            }
+            std::vector<float> row(VOCAB_SIZE, 0.0f);
+            row[NEXT_TOKEN] = 10.0f;
+            return mx::broadcast_to(
+                mx::array(row.data(), {1, VOCAB_SIZE}),
+                {static_cast<int32_t>(batch_details.total_tokens_in_step), VOCAB_SIZE});
+        }
+
+        std::vector<mx::array*> get_parameters() override { return {}; }
+        void load_weights(const std::unordered_map<std::string, mx::array>&) override {}
+        int get_num_kv_heads() const noexcept override { return NUM_KV_HEADS; }
+        int get_head_dim() const noexcept override { return HEAD_DIM; }
+        int get_num_layers() const noexcept override { return 1; }
+        size_t get_vocab_size() const noexcept override { return VOCAB_SIZE; }
+
+    private:
+        size_t& num_forwards_;
+        std::chrono::milliseconds delay_;
+    };
+
+    // Records every stream's tokens and finish reason; clients cancel
+    // through per-sequence cancel words, as they do over shared memory.
+    class RecordingSink final : public engine::ITokenSink {
+    public:
+        void emit(const sequence::Sequence& sequence, int32_t token_id, std::optional<float>,
+                  ipc::FinishReason finish_reason) override {
+            tokens[sequence.sequence_id].push_back(token_id);
+            if (finish_reason != ipc::FinishReason::NONE) {
+                finish(sequence, finish_reason);
+            }
+        }
+        void finish(const sequence::Sequence& sequence, ipc::FinishReason finish_reason) override {
+            finished[sequence.sequence_id] = finish_reason;
+            finish_order.push_back(sequence.sequence_id);
+        }
+        void flush() override { ++num_flushes; }
+
+        [[nodiscard]] const std::atomic<uint32_t>* cancel_word(const sequence::Sequence& sequence) const override {
+            const auto it = cancel_words_.find(sequence.sequence_id);
+            return it != cancel_words_.end() ? it->second.get() : nullptr;
+        }
+        void watch(uint64_t sequence_id) {
+            cancel_words_.emplace(sequence_id, std::make_unique<std::atomic<uint32_t>>(0));
+        }
+        void cancel(uint64_t sequence_id) { cancel_words_.at(sequence_id)->store(1); }
+
+        std::map<uint64_t, std::vector<int32_t>> tokens;
+        std::map<uint64_t, ipc::FinishReason> finished;
+        std::vector<uint64_t> finish_order;
+        size_t num_flushes = 0;
+
+    private:
+        std::map<uint64_t, std::unique_ptr<std::atomic<uint32_t>>> cancel_words_;
+    };
+
+    uint64_t now_ns() {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// Test fixture: a scheduler over a small KV pool, driven by the stub model
+// -----------------------------------------------------------------------------
+class SchedulerTest : public ::testing::Test {
+protected:
+    static constexpr size_t NUM_PAGES = 64;
+
+    engine::PageAllocator allocator_{NUM_PAGES, NUM_KV_HEADS, HEAD_DIM};
+    engine::Scheduler::SequenceQueue incoming_{64};
+    RecordingSink sink_;
+    size_t num_forwards_ = 0;
+    std::chrono::milliseconds model_delay_{0};
+
+    std::unique_ptr<engine::Scheduler> make_scheduler(size_t max_num_seqs = 8, size_t max_tokens_in_batch = 256) {
+        return std::make_unique<engine::Scheduler>(
+            allocator_, std::make_unique<StubModel>(num_forwards_, model_delay_), incoming_, &sink_,
+            max_num_seqs, max_tokens_in_batch);
+    }
+
+    // Greedy, so every generated token is NEXT_TOKEN.
+    void submit(uint64_t id, size_t prompt_len, int max_generated_tokens,
+                const sequence::SchedulingParams& scheduling = {}, uint64_t arrival_ns = now_ns()) {
+        sequence::SamplingParams sampling;
+        sampling.temperature = 0.0f;
+        sequence::StopCriteria stop;
+        stop.max_generated_tokens = max_generated_tokens;
+        sink_.watch(id);
+        ASSERT_TRUE(incoming_.try_push(std::make_unique<sequence::Sequence>(
+            id, sequence::SequenceStatus::WAITING, arrival_ns,
+            sequence::Prompt(std::vector<int32_t>(prompt_len, 1)),
+            sampling, sequence::LogitsParams{}, stop, sequence::IPCHandles{}, scheduling)));
+    }
+
+    // Steps until nothing is left to do, at most `max_steps` times.
+    void run(engine::Scheduler& scheduler, size_t max_steps = 256) {
+        for (size_t i = 0; i < max_steps && (scheduler.num_waiting() > 0 || scheduler.num_running() > 0); ++i) {
+            scheduler.step();
+        }
+    }
+
+    // Steps until `done` holds, at most `max_steps` times.
+    template <typename Done>
+    bool step_until(engine::Scheduler& scheduler, Done done, size_t max_steps = 256) {
+        for (size_t i = 0; i < max_steps && !done(); ++i) {
+            scheduler.step();
+        }
+        return done();
+    }
+
+    static sequence::SchedulingParams with_priority(sequence::Priority priority, uint32_t ttft_deadline_ms = 0) {
+        return {.priority = priority, .ttft_deadline_ms = ttft_deadline_ms};
+    }
+};
+
+TEST_F(SchedulerTest, GeneratesUntilMaxTokens) {
+    auto scheduler = make_scheduler();
+    submit(1, 10, 4);
+    run(*scheduler);
+
+    EXPECT_EQ(sink_.tokens[1], std::vector<int32_t>(4, NEXT_TOKEN));
+    EXPECT_EQ(sink_.finished.at(1), ipc::FinishReason::LENGTH);
+    EXPECT_EQ(allocator_.get_num_free_pages(), NUM_PAGES);
+}
+
+TEST_F(SchedulerTest, CancelledSequenceBehindAFullBatchIsAnsweredRightAway) {
+    auto scheduler = make_scheduler(/*max_num_seqs=*/1);
+    submit(1, 4, 64);
+    scheduler->step(); // 1 takes the only slot
+    ASSERT_EQ(scheduler->num_running(), 1u);
+
+    // 2 is stuck at the head of the queue behind the full batch; 3 queues behind it.
+    submit(2, 4, 64);
+    submit(3, 4, 64);
+    sink_.cancel(3);
+    scheduler->step();
+
+    ASSERT_TRUE(sink_.finished.contains(3));
+    EXPECT_EQ(sink_.finished.at(3), ipc::FinishReason::CANCELLED);
+    EXPECT_FALSE(sink_.tokens.contains(3));
+    EXPECT_FALSE(sink_.finished.contains(2));
+    EXPECT_EQ(scheduler->num_waiting(), 1u);
+}
+
+TEST_F(SchedulerTest, ServesPriorityClassesInOrder) {
+    auto scheduler = make_scheduler(/*max_num_seqs=*/1);
+    submit(1, 4, 1, with_priority(sequence::Priority::BATCH));
+    submit(2, 4, 1, with_priority(sequence::Priority::STANDARD));
+    submit(3, 4, 1, with_priority(sequence::Priority::INTERACTIVE));
+    run(*scheduler);
+
+    EXPECT_EQ(sink_.finish_order, (std::vector<uint64_t>{3, 2, 1}));
+}
+
+TEST_F(SchedulerTest, ShedsWhatCanNoLongerMakeItsDeadline) {
+    auto scheduler = make_scheduler();
+    submit(1, 4, 2);
+    run(*scheduler); // Gives the scheduler a step time to estimate with
+
+    // Its first token was due long ago; the one without a deadline still runs.
+    const uint64_t long_ago = now_ns() - 1'000'000'000;
+    submit(2, 4, 4, with_priority(sequence::Priority::STANDARD, 1), long_ago);
+    submit(3, 4, 2);
+    run(*scheduler);
+
+    EXPECT_EQ(sink_.finished.at(2), ipc::FinishReason::DEADLINE);
+    EXPECT_FALSE(sink_.tokens.contains(2));
+    EXPECT_EQ(sink_.finished.at(3), ipc::FinishReason::LENGTH);
+}
+
+TEST_F(SchedulerTest, AtRiskSequencePreemptsABatchPrefill) {
+    // Steps of ~10 ms: a 30 ms deadline is at risk (under four steps of
+    // slack) but can still be met.
+    model_delay_ = std::chrono::milliseconds(10);
+    auto scheduler = make_scheduler(/*max_num_seqs=*/1, /*max_tokens_in_batch=*/16);
+    submit(1, 128, 2, with_priority(sequence::Priority::BATCH));
+    scheduler->step();
+    scheduler->step(); // A step finished: the step time is known
+    ASSERT_EQ(scheduler->num_running(), 1u);
+
+    // With one slot, 2 can only start if 1 gives its slot up mid-prompt.
+    submit(2, 4, 2, with_priority(sequence::Priority::INTERACTIVE, 30));
+    ASSERT_TRUE(step_until(*scheduler, [&] { return sink_.tokens.contains(2); }, 6));
+    EXPECT_FALSE(sink_.finished.contains(1));
+    EXPECT_EQ(scheduler->num_waiting(), 1u);
+    run(*scheduler);
+
+    // The batch prefill gave up its slot and was recomputed afterwards.
+    EXPECT_EQ(sink_.finish_order, (std::vector<uint64_t>{2, 1}));
+    EXPECT_EQ(sink_.finished.at(2), ipc::FinishReason::LENGTH);
+    EXPECT_EQ(sink_.tokens[1], std::vector<int32_t>(2, NEXT_TOKEN));
+    EXPECT_EQ(allocator_.get_num_free_pages(), NUM_PAGES);
+}
+
+TEST_F(SchedulerTest, CollectsEachStepWhileTheNextRuns) {
+    auto scheduler = make_scheduler();
+    submit(1, 4, 3);
+
+    // Every step launches the next forward pass before the tokens of the
+    // last one come back, so output trails launches by one step.
+    for (size_t step = 1; step <= 3; ++step) {
+        EXPECT_TRUE(scheduler->step());
+        EXPECT_EQ(num_forwards_, step);
+        EXPECT_EQ(sink_.tokens[1].size(), step - 1);
+    }
+    EXPECT_TRUE(scheduler->step()); // Collects the last token, launches nothing
+    EXPECT_EQ(num_forwards_, 3u);
+    EXPECT_EQ(sink_.tokens[1], std::vector<int32_t>(3, NEXT_TOKEN));
+    EXPECT_EQ(sink_.finished.at(1), ipc::FinishReason::LENGTH);
+    EXPECT_EQ(sink_.num_flushes, 4u);
+    EXPECT_FALSE(scheduler->step());
+}
+
+TEST_F(SchedulerTest, DecodesSeveralStepsPerLaunch) {
+    auto scheduler = make_scheduler();
+    scheduler->set_decode_steps(4);
+    submit(1, 4, 9);
+
+    scheduler->step(); // Prefill
+    scheduler->step(); // First token back; launches a four-step run
+    EXPECT_EQ(num_forwards_, 5u);
+    EXPECT_EQ(sink_.tokens[1].size(), 1u);
+    scheduler->step(); // The run's tokens arrive together; the last run launches
+    EXPECT_EQ(num_forwards_, 9u);
+    EXPECT_EQ(sink_.tokens[1].size(), 5u);
+    run(*scheduler);
+
+    EXPECT_EQ(sink_.tokens[1], std::vector<int32_t>(9, NEXT_TOKEN));
+    EXPECT_EQ(sink_.finished.at(1), ipc::FinishReason::LENGTH);
+    EXPECT_EQ(num_forwards_, 9u);
+    EXPECT_EQ(allocator_.get_num_free_pages(), NUM_PAGES);
+}
+
+TEST_F(SchedulerTest, RejectsUntilThePoolRecovers) {
+    ipc::EngineLoad load;
+    auto scheduler = make_scheduler();
+    scheduler->publish_load_to(&load);
+    const auto free_pages = [&] { return allocator_.get_num_free_pages(); };
+
+    // Between them, 1 and 2 fill all but one page of the pool.
+    const size_t page = engine::TOKEN_CAPACITY_PER_PAGE;
+    submit(1, 60 * page, 60); // 61 pages
+    submit(2, page, 60);      // 2 pages
+    ASSERT_TRUE(step_until(*scheduler, [&] { return free_pages() == 1; }));
+    EXPECT_EQ(load.admission.load(), ipc::AdmissionState::ACCEPTING); // Nothing queued yet
+
+    submit(3, 10 * page, 60); // Can't be admitted
+    scheduler->step();
+    EXPECT_EQ(load.admission.load(), ipc::AdmissionState::REJECTING);
+    EXPECT_GE(load.retry_after_ms.load(), 100u);
+    EXPECT_EQ(load.waiting_sequences.load(), 1u);
+    EXPECT_EQ(load.free_kv_pages.load(), 1u);
+
+    // Past the rejection threshold, but short of the one for accepting again.
+    EXPECT_TRUE(scheduler->cancel(2));
+    ASSERT_TRUE(step_until(*scheduler, [&] { return free_pages() == 3; }));
+    scheduler->step();
+    EXPECT_EQ(load.admission.load(), ipc::AdmissionState::REJECTING);
+
+    EXPECT_TRUE(scheduler->cancel(1));
+    ASSERT_TRUE(step_until(*scheduler, [&] { return scheduler->num_waiting() == 0; }));
+    scheduler->step();
+    EXPECT_EQ(load.admission.load(), ipc::AdmissionState::ACCEPTING);
+    EXPECT_EQ(load.retry_after_ms.load(), 0u);
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "sequence/sequence.hpp"
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace pie_core;
+
+namespace {
+
+    // A sequence borrowing `tokens` as its prompt, the way IPCReader hands
+    // prompts over; `released` is set when the prompt lets go of them.
+    std::unique_ptr<sequence::Sequence> borrowing_sequence(const std::vector<int32_t>& tokens, bool& released) {
+        return std::make_unique<sequence::Sequence>(
+            1, sequence::SequenceStatus::PREFILLING, 0,
+            sequence::Prompt(tokens, [&released] { released = true; }),
+            sequence::SamplingParams{}, sequence::LogitsParams{}, sequence::StopCriteria{}, sequence::IPCHandles{});
+    }
+
+} // namespace
+
+TEST(SequenceTest, ReadsPromptThenGeneratedTokens) {
+    bool released = false;
+    const std::vector<int32_t> prompt{10, 11, 12, 13};
+    const auto sequence = borrowing_sequence(prompt, released);
+    sequence->append_token(20);
+
+    std::vector<int32_t> out(3);
+    sequence->copy_tokens(2, 3, out.data());
+    EXPECT_EQ(out, (std::vector<int32_t>{12, 13, 20}));
+    EXPECT_EQ(sequence->token_at(0), 10);
+    EXPECT_EQ(sequence->last_token(), 20);
+    EXPECT_THROW((void)sequence->token_at(5), std::out_of_range);
+    EXPECT_THROW(sequence->copy_tokens(4, 2, out.data()), std::out_of_range);
+}
+
+TEST(SequenceTest, ReleasedPrefixIsNotReadable) {
+    bool released = false;
+    const std::vector<int32_t> prompt{10, 11, 12, 13};
+    const auto sequence = borrowing_sequence(prompt, released);
+    sequence->append_token(20);
+
+    sequence->release_prompt(2);
+    EXPECT_TRUE(released);
+    EXPECT_EQ(sequence->released_prompt_prefix(), 2u);
+    EXPECT_EQ(sequence->prompt_len, 4u);
+
+    // The kept tail and everything generated still read the same.
+    std::vector<int32_t> out(3);
+    sequence->copy_tokens(2, 3, out.data());
+    EXPECT_EQ(out, (std::vector<int32_t>{12, 13, 20}));
+    EXPECT_EQ(sequence->token_at(2), 12);
+    EXPECT_EQ(sequence->last_token(), 20);
+
+    EXPECT_THROW((void)sequence->token_at(1), std::out_of_range);
+    EXPECT_THROW(sequence->copy_tokens(0, 3, out.data()), std::out_of_range);
+    EXPECT_THROW(sequence->copy_tokens(1, 1, out.data()), std::out_of_range);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "engine/slot_table.hpp"
+#include <atomic>
+#include <cstdint>
+
+using namespace pie_core;
+
+TEST(SlotTableTest, HandsOutEverySlotOnce) {
+    engine::SlotTable slots(2);
+    EXPECT_EQ(slots.acquire().value(), 0u);
+    EXPECT_EQ(slots.acquire().value(), 1u);
+    EXPECT_FALSE(slots.acquire().has_value());
+
+    slots.release(0);
+    EXPECT_EQ(slots.state(0), engine::SlotState::FREE);
+    EXPECT_EQ(slots.acquire().value(), 0u);
+}
+
+TEST(SlotTableTest, TracksASequenceThroughItsLife) {
+    engine::SlotTable slots(4);
+    const uint32_t slot = slots.acquire().value();
+    slots.load(slot, sequence::Priority::STANDARD, 10, 7, 2);
+    EXPECT_EQ(slots.state(slot), engine::SlotState::PREFILLING);
+    EXPECT_EQ(slots.last_token(slot), 7);
+
+    slots.add_computed(slot, 10);
+    slots.set_num_pages(slot, 1);
+    slots.append_token(slot, 42, false);
+    EXPECT_EQ(slots.state(slot), engine::SlotState::DECODING);
+    EXPECT_EQ(slots.logical_len(slot), 11u);
+    EXPECT_EQ(slots.last_token(slot), 42);
+    EXPECT_EQ(slots.remaining(slot), 1u);
+    EXPECT_EQ(slots.num_pages(slot), 1u);
+
+    // The generation budget runs out.
+    slots.append_token(slot, 43, false);
+    EXPECT_EQ(slots.state(slot), engine::SlotState::STOPPED);
+    EXPECT_EQ(slots.remaining(slot), 0u);
+}
+
+TEST(SlotTableTest, StopTokenStops) {
+    engine::SlotTable slots(1);
+    const uint32_t slot = slots.acquire().value();
+    slots.load(slot, sequence::Priority::STANDARD, 4, 1, 100);
+    slots.append_token(slot, 2, true);
+    EXPECT_EQ(slots.state(slot), engine::SlotState::STOPPED);
+}
+
+TEST(SlotTableTest, PassesCoverOnlyMatchingSlots) {
+    engine::SlotTable slots(4);
+    const uint32_t interactive = slots.acquire().value();
+    const uint32_t batch = slots.acquire().value();
+    const uint32_t decoding = slots.acquire().value();
+    slots.load(interactive, sequence::Priority::INTERACTIVE, 100, 1, 8);
+    slots.load(batch, sequence::Priority::BATCH, 300, 1, 8);
+    slots.load(decoding, sequence::Priority::STANDARD, 50, 1, 5);
+    slots.add_computed(interactive, 40);
+    slots.add_computed(decoding, 50);
+    slots.append_token(decoding, 9, false);
+
+    EXPECT_EQ(slots.count(engine::SlotState::PREFILLING), 2u);
+    EXPECT_EQ(slots.count(engine::SlotState::DECODING), 1u);
+    const auto pending = slots.pending_prefill_tokens();
+    EXPECT_EQ(pending[static_cast<size_t>(sequence::Priority::INTERACTIVE)], 60u);
+    EXPECT_EQ(pending[static_cast<size_t>(sequence::Priority::STANDARD)], 0u);
+    EXPECT_EQ(pending[static_cast<size_t>(sequence::Priority::BATCH)], 300u);
+    EXPECT_EQ(slots.min_remaining(), 4u);
+
+    slots.release(decoding);
+    EXPECT_EQ(slots.min_remaining(), SIZE_MAX);
+}
+
+TEST(SlotTableTest, PollPicksUpCancelWords) {
+    engine::SlotTable slots(3);
+    std::atomic<uint32_t> word{0};
+    const uint32_t watched = slots.acquire().value();
+    const uint32_t unwatched = slots.acquire().value();
+    slots.load(watched, sequence::Priority::STANDARD, 4, 1, 8, &word);
+    slots.load(unwatched, sequence::Priority::STANDARD, 4, 1, 8);
+
+    EXPECT_EQ(slots.poll_cancellations(), 0u);
+    word.store(1);
+    EXPECT_EQ(slots.poll_cancellations(), 1u);
+    EXPECT_EQ(slots.poll_cancellations(), 0u); // Only counted once
+    EXPECT_TRUE(slots.cancelled(watched));
+    EXPECT_FALSE(slots.cancelled(unwatched));
+
+    slots.cancel(unwatched);
+    EXPECT_TRUE(slots.cancelled(unwatched));
+
+    // A reloaded slot starts uncancelled.
+    slots.release(watched);
+    slots.load(slots.acquire().value(), sequence::Priority::STANDARD, 4, 1, 8);
+    EXPECT_FALSE(slots.cancelled(watched));
+}
+
+TEST(SlotTableTest, OutstandingPagesCountWhatIsNotHeldYet) {
+    engine::SlotTable slots(3);
+    const uint32_t prefilling = slots.acquire().value();
+    const uint32_t stopped = slots.acquire().value();
+    slots.load(prefilling, sequence::Priority::STANDARD, 4, 1, 8);
+    slots.load(stopped, sequence::Priority::STANDARD, 4, 1, 1);
+    slots.set_charged_pages(prefilling, 10);
+    slots.set_num_pages(prefilling, 3);
+    slots.set_charged_pages(stopped, 10);
+    slots.append_token(stopped, 5, false); // Out of budget: stopped, charges nothing more
+
+    EXPECT_EQ(slots.outstanding_pages(), 7u);
+
+    slots.set_num_pages(prefilling, 12); // Past its charge
+    EXPECT_EQ(slots.outstanding_pages(), 0u);
+}
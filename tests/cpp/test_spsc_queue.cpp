@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "ipc/spsc_queue.hpp"
+#include <vector>
+#include <thread>
+#include <memory>
+#include <iterator>
+#include <chrono>
+#include <atomic>
+
+using namespace pie_core;
+
+// --------------------------------------------------------------------------
+// Single-threaded behaviour
+// --------------------------------------------------------------------------
+TEST(SPSCQueueTest, CapacityRoundsUpToPowerOfTwo) {
+    ipc::SPSCQueue<int> queue(100);
+    EXPECT_EQ(queue.capacity(), 128u);
+}
+
+TEST(SPSCQueueTest, PushPopFifoWithMoveOnlyItems) {
+    ipc::SPSCQueue<std::unique_ptr<int>> queue(4);
+    for (int i = 0; i < 4; ++i) ASSERT_TRUE(queue.try_push(std::make_unique<int>(i)));
+
+    auto rejected = std::make_unique<int>(99);
+    EXPECT_FALSE(queue.try_push(std::move(rejected)));
+    ASSERT_NE(rejected, nullptr); // Not consumed on failure
+
+    for (int i = 0; i < 4; ++i) {
+        auto item = queue.try_pop();
+        ASSERT_TRUE(item);
+        EXPECT_EQ(**item, i);
+    }
+    EXPECT_FALSE(queue.try_pop());
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SPSCQueueTest, BatchPushStopsWhenFull) {
+    ipc::SPSCQueue<int> queue(8);
+    std::vector<int> items{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    EXPECT_EQ(queue.push_batch(items.data(), items.size()), 8u);
+    EXPECT_EQ(queue.size_approx(), 8u);
+
+    std::vector<int> out;
+    EXPECT_EQ(queue.pop_batch(std::back_inserter(out), 3), 3u);
+    EXPECT_EQ(queue.push_batch(items.data() + 8, 2), 2u);
+    EXPECT_EQ(queue.pop_batch(std::back_inserter(out)), 7u);
+    EXPECT_EQ(out, items);
+}
+
+TEST(SPSCQueueTest, WaitForDataTimesOutWhenEmpty) {
+    ipc::SPSCQueue<int> queue(8);
+    EXPECT_FALSE(queue.wait_for_data(std::chrono::milliseconds(5)));
+    ASSERT_TRUE(queue.try_push(1));
+    EXPECT_TRUE(queue.wait_for_data(std::chrono::milliseconds(5)));
+}
+
+TEST(SPSCQueueTest, WaitForSpaceTimesOutWhenFull) {
+    ipc::SPSCQueue<int> queue(2);
+    EXPECT_TRUE(queue.wait_for_space(std::chrono::milliseconds(5)));
+    ASSERT_TRUE(queue.try_push(1));
+    ASSERT_TRUE(queue.try_push(2));
+    EXPECT_TRUE(queue.full());
+    EXPECT_FALSE(queue.wait_for_space(std::chrono::milliseconds(5)));
+}
+
+// --------------------------------------------------------------------------
+// Concurrency
+// --------------------------------------------------------------------------
+TEST(SPSCQueueTest, PopWakesAProducerWaitingForSpace) {
+    ipc::SPSCQueue<int> queue(2);
+    ASSERT_TRUE(queue.try_push(1));
+    ASSERT_TRUE(queue.try_push(2));
+
+    std::atomic<bool> woke{false};
+    std::thread producer([&] {
+        woke.store(queue.wait_for_space(std::chrono::seconds(5)));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::vector<int> popped;
+    queue.pop_batch(std::back_inserter(popped), 1);
+    producer.join();
+    EXPECT_TRUE(woke.load());
+    EXPECT_TRUE(queue.try_push(3));
+}
+
+TEST(SPSCQueueTest, ProducerConsumerPreservesOrder) {
+    constexpr int num_items = 200000;
+    ipc::SPSCQueue<int> queue(64);
+
+    std::thread producer([&] {
+        int batch[16];
+        for (int next = 0; next < num_items;) {
+            const int count = std::min(16, num_items - next);
+            for (int i = 0; i < count; ++i) batch[i] = next + i;
+            int pushed = 0;
+            while (pushed < count) {
+                pushed += static_cast<int>(queue.push_batch(batch + pushed, count - pushed));
+            }
+            next += count;
+        }
+    });
+
+    std::vector<int> received;
+    received.reserve(num_items);
+    while (received.size() < num_items) {
+        if (queue.pop_batch(std::back_inserter(received)) == 0) {
+            queue.wait_for_data(std::chrono::milliseconds(10));
+        }
+    }
+    producer.join();
+
+    for (int i = 0; i < num_items; ++i) ASSERT_EQ(received[i], i);
+}
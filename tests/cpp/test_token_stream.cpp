@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "engine/token_stream.hpp"
+#include <vector>
+#include <thread>
+#include <chrono>
+
+using namespace pie_core;
+
+TEST(TokenStreamTest, ReadDrainsInOrder) {
+    engine::TokenStream stream(7);
+    EXPECT_EQ(stream.request_id(), 7u);
+    ASSERT_TRUE(stream.push({.token_id = 1, .finish_reason = ipc::FinishReason::NONE}));
+    ASSERT_TRUE(stream.push({.token_id = 2, .finish_reason = ipc::FinishReason::NONE}));
+
+    std::vector<engine::StreamToken> tokens;
+    EXPECT_EQ(stream.read(tokens), 2u);
+    ASSERT_EQ(tokens.size(), 2u);
+    EXPECT_EQ(tokens[0].token_id, 1);
+    EXPECT_EQ(tokens[1].token_id, 2);
+    EXPECT_EQ(stream.read(tokens), 0u);
+    EXPECT_FALSE(stream.closed());
+}
+
+TEST(TokenStreamTest, FinishReasonClosesStream) {
+    engine::TokenStream stream(1);
+    ASSERT_TRUE(stream.push({.token_id = 5, .finish_reason = ipc::FinishReason::LENGTH}));
+    EXPECT_TRUE(stream.closed());
+    EXPECT_FALSE(stream.push({.token_id = 6, .finish_reason = ipc::FinishReason::NONE}));
+    EXPECT_FALSE(stream.push({.token_id = -1, .finish_reason = ipc::FinishReason::CANCELLED}));
+
+    std::vector<engine::StreamToken> tokens;
+    ASSERT_EQ(stream.read(tokens), 1u);
+    EXPECT_EQ(tokens[0].finish_reason, ipc::FinishReason::LENGTH);
+    // Still closed (and waitable) after the final entry was read.
+    EXPECT_TRUE(stream.wait(std::chrono::microseconds(0)));
+}
+
+TEST(TokenStreamTest, WaitTimesOutWhenEmpty) {
+    engine::TokenStream stream(1);
+    EXPECT_FALSE(stream.wait(std::chrono::milliseconds(1)));
+}
+
+TEST(TokenStreamTest, WaitWakesOnPushFromAnotherThread) {
+    engine::TokenStream stream(1);
+    std::thread producer([&stream] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        stream.push({.token_id = 42, .finish_reason = ipc::FinishReason::STOP});
+    });
+    EXPECT_TRUE(stream.wait(std::chrono::seconds(5)));
+    producer.join();
+
+    std::vector<engine::StreamToken> tokens;
+    ASSERT_EQ(stream.read(tokens), 1u);
+    EXPECT_EQ(tokens[0].token_id, 42);
+}
+
+TEST(TokenStreamTest, CallbackReceivesTokensUnbuffered) {
+    std::vector<engine::StreamToken> received;
+    engine::TokenStream stream(3, [&received](const engine::StreamToken& token) { received.push_back(token); });
+    ASSERT_TRUE(stream.push({.token_id = 4, .finish_reason = ipc::FinishReason::NONE}));
+    ASSERT_TRUE(stream.push({.token_id = 5, .finish_reason = ipc::FinishReason::STOP}));
+    EXPECT_FALSE(stream.push({.token_id = 6, .finish_reason = ipc::FinishReason::NONE}));
+
+    ASSERT_EQ(received.size(), 2u);
+    EXPECT_EQ(received[1].finish_reason, ipc::FinishReason::STOP);
+    std::vector<engine::StreamToken> tokens;
+    EXPECT_EQ(stream.read(tokens), 0u);
+    EXPECT_TRUE(stream.closed());
+}
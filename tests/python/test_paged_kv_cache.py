@@ -0,0 +1,104 @@
+"""
+Tests for PagedKVCache: in-place page writes, trimming, forking and release.
+"""
+
+import mlx.core as mx
+import pytest
+
+from proxy_inference_engine import pie_core
+from proxy_inference_engine.cache import PagedKVCache
+
+NUM_PAGES = 8
+NUM_HEADS = 2
+HEAD_DIM = 4
+PAGE = pie_core.TOKEN_CAPACITY_PER_PAGE
+
+
+@pytest.fixture
+def allocator():
+    return pie_core.PageAllocator(NUM_PAGES, NUM_HEADS, HEAD_DIM, cache_dtype=mx.float32)
+
+
+def tokens(start: int, count: int) -> mx.array:
+    """[1, heads, count, head_dim] whose entries tell their token position."""
+    positions = mx.arange(start, start + count, dtype=mx.float32)
+    return mx.broadcast_to(positions[None, None, :, None], (1, NUM_HEADS, count, HEAD_DIM))
+
+
+def test_update_and_fetch_across_a_page_boundary(allocator):
+    cache = PagedKVCache(allocator)
+    first = PAGE - 1
+    keys, values = cache.update_and_fetch(tokens(0, first), -tokens(0, first))
+    assert keys.shape == (1, NUM_HEADS, first, HEAD_DIM)
+
+    # Two single-token steps: one fills the first page, the next opens a second.
+    for position in (first, first + 1):
+        keys, values = cache.update_and_fetch(tokens(position, 1), -tokens(position, 1))
+
+    assert cache.offset == PAGE + 1
+    assert len(cache.page_table) == 2
+    assert mx.array_equal(keys, tokens(0, PAGE + 1))
+    assert mx.array_equal(values, -tokens(0, PAGE + 1))
+
+    # The pages themselves hold the tokens, written in place.
+    second = allocator.get_page(cache.page_table[1])
+    assert second.num_tokens == 1
+    assert mx.array_equal(second.key_cache[0], tokens(PAGE, 1)[0, :, 0])
+    assert allocator.get_page(cache.page_table[0]).num_tokens == PAGE
+
+
+def test_trim_returns_emptied_pages(allocator):
+    cache = PagedKVCache(allocator)
+    cache.update_and_fetch(tokens(0, PAGE + 3), tokens(0, PAGE + 3))
+    assert allocator.num_free_pages == NUM_PAGES - 2
+
+    assert cache.trim(4) == 4
+    assert cache.offset == PAGE - 1
+    assert allocator.num_free_pages == NUM_PAGES - 1
+
+    # Writing after a trim overwrites the dropped tokens.
+    keys, _ = cache.update_and_fetch(tokens(100, 1), tokens(100, 1))
+    assert mx.array_equal(keys[..., -1:, :], tokens(100, 1))
+    assert mx.array_equal(cache.state[0][..., : PAGE - 1, :], tokens(0, PAGE - 1))
+
+
+def test_fork_copies_a_shared_page_before_writing(allocator):
+    cache = PagedKVCache(allocator)
+    cache.update_and_fetch(tokens(0, 3), tokens(0, 3))
+    shared_id = cache.page_table[0]
+
+    fork = cache.fork()
+    assert fork.page_table == [shared_id]
+    assert allocator.get_page(shared_id).ref_count == 2
+
+    keys, _ = fork.update_and_fetch(tokens(50, 1), tokens(50, 1))
+    assert fork.page_table[0] != shared_id
+    assert allocator.get_page(shared_id).ref_count == 1
+    assert mx.array_equal(keys[..., :3, :], tokens(0, 3))
+    assert mx.array_equal(keys[..., 3:, :], tokens(50, 1))
+
+    # The original still reads its own tokens, from both its view and its page.
+    keys, _ = cache.update_and_fetch(tokens(3, 1), tokens(3, 1))
+    assert mx.array_equal(keys, tokens(0, 4))
+    assert mx.array_equal(allocator.get_page(shared_id).key_cache[:4], tokens(0, 4)[0].transpose(1, 0, 2))
+
+
+def test_release_returns_every_page(allocator):
+    cache = PagedKVCache(allocator)
+    cache.update_and_fetch(tokens(0, 2 * PAGE), tokens(0, 2 * PAGE))
+    fork = cache.fork()
+
+    cache.release()
+    assert cache.state == (None, None)
+    assert allocator.num_free_pages == NUM_PAGES - 2  # Still held by the fork
+
+    fork.release()
+    assert allocator.num_free_pages == NUM_PAGES
+
+
+def test_write_rejects_a_foreign_layout(allocator):
+    page = allocator.get_page(allocator.allocate_page())
+    with pytest.raises(ValueError):
+        page.write(0, mx.zeros((1, NUM_HEADS, HEAD_DIM + 1)), mx.zeros((1, NUM_HEADS, HEAD_DIM + 1)))
+    with pytest.raises(IndexError):
+        page.write(PAGE, mx.zeros((1, NUM_HEADS, HEAD_DIM)), mx.zeros((1, NUM_HEADS, HEAD_DIM)))